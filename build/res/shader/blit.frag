@@ -0,0 +1,11 @@
+#version 460 core
+
+layout(location = 0) in vec2 TexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+layout(binding = 0) uniform sampler2D image;
+
+void main(){
+    outColor = texture(image, TexCoord);
+}
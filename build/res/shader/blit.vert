@@ -0,0 +1,10 @@
+#version 460 core
+
+layout(location = 0) out vec2 TexCoord;
+
+// Fullscreen triangle from gl_VertexID, no vertex buffer
+void main(){
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = vec2(position.x, 1.0 - position.y);      // Image rows are top first
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -1,2 +1,2 @@
-glslc vertex.vert -o ve.spv
-glslc fragment.frag -o fa.spv
\ No newline at end of file
+glslc --target-env=opengl vertex.vert -o ve.spv
+glslc --target-env=opengl fragment.frag -o fa.spv
\ No newline at end of file
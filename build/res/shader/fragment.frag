@@ -1,9 +1,85 @@
 #version 460 core
 
+layout(location = 0) in vec3 ViewPosition;
+layout(location = 1) in vec4 VertexColor;
+layout(location = 2) in vec2 VertexTexCoord;
+layout(location = 3) flat in float VertexLightLevel;
+layout(location = 4) flat in float VertexTextureSlot;
+
 layout(location = 0) out vec4 outColor;
 
-uniform vec4 myColor;
+layout(location = 3) uniform vec4 myColor;
+
+// R8UI palette indices one size per array, PLAYPAL 256 x 1, COLORMAP 256 x 34
+layout(binding = 1) uniform usampler2DArray indexTexture;
+layout(binding = 2) uniform sampler2D paletteTexture;
+layout(binding = 3) uniform usampler2D colorMapTexture;
+
+// TextureAtlas SlotLayers, 4 slots per uvec4 for std140, animations only rewrite this
+layout(std140, binding = 0) uniform TextureRemap{
+    uvec4 SlotLayers[1024];
+};
+
+// Variants are picked by glSpecializeShader, GLSL source path get them as defines
+#ifdef GL_SPIRV
+layout(constant_id = 0) const int LightingModel = 0;
+layout(constant_id = 1) const bool EnableFog = false;
+layout(constant_id = 2) const bool DebugColor = false;
+layout(constant_id = 3) const bool PaletteLookup = false;
+#else
+#ifndef LIGHTING_MODEL
+#define LIGHTING_MODEL 0
+#define ENABLE_FOG 0
+#define DEBUG_COLOR 0
+#define PALETTE_LOOKUP 0
+#endif
+const int LightingModel = LIGHTING_MODEL;
+const bool EnableFog = ENABLE_FOG != 0;
+const bool DebugColor = DEBUG_COLOR != 0;
+const bool PaletteLookup = PALETTE_LOOKUP != 0;
+#endif
+
+const vec4 FogColor = vec4(0.2, 0.2, 0.2, 1.0);     // Same as clear color
+const float MapScale = 100.0;                       // MapScaleFactor, light tables work in map units
+
+// Same as getColorMapLevel in Palette.hpp
+int getColorMapLevel(float lightLevel, float distance){
+    int light = clamp(int(lightLevel) >> 4, 0, 15);
+    int startMap = (15 - light) * 4;
+    int scale = distance > 0.0 ? min(int(2560.0 / distance), 47) : 47;
+    return clamp(startMap - scale / 2, 0, 31);
+}
 
 void main(){
-    outColor = myColor;
+    vec4 color = myColor * VertexColor;
+    float distance = length(ViewPosition);
+
+    // COLORMAP already darken with distance, it replace the light diminishing
+    if(PaletteLookup){
+        // Integer textures can not filter, pick the mip from the texel footprint like GL nearest would
+        vec2 footprint = max(abs(dFdx(VertexTexCoord)), abs(dFdy(VertexTexCoord)));
+        int level = clamp(int(floor(log2(max(max(footprint.x, footprint.y), 1.0)))), 0, textureQueryLevels(indexTexture) - 1);
+        // Wrap at level 0 then scale, wrapping at the level size break when the base is not a power of two
+        ivec2 wrapped = ivec2(mod(floor(VertexTexCoord), vec2(textureSize(indexTexture, 0).xy)));
+        ivec2 texel = min(wrapped >> level, textureSize(indexTexture, level).xy - 1);
+        // Slots past the remap array read slot 0, getWallTexture already keep them out
+        int slot = int(VertexTextureSlot);
+        slot = slot < SlotLayers.length() * 4 ? slot : 0;
+        uint index = texelFetch(indexTexture, ivec3(texel, int(SlotLayers[slot >> 2][slot & 3])), level).r;
+        uint shaded = texelFetch(colorMapTexture, ivec2(index, getColorMapLevel(VertexLightLevel, distance * MapScale)), 0).r;
+        color = myColor * texelFetch(paletteTexture, ivec2(shaded, 0), 0);
+    }
+    else if(LightingModel == 1){
+        color.rgb *= clamp(1.0 - distance / 40.0, 0.25, 1.0);
+    }
+
+    if(EnableFog){
+        color = mix(color, FogColor, clamp(distance / 60.0, 0.0, 1.0));
+    }
+
+    if(DebugColor){
+        color = vec4(fract(ViewPosition * 0.5), 1.0);
+    }
+
+    outColor = color;
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 460 core
+
+layout(location = 0) in vec3 ViewPosition;
+layout(location = 1) in vec2 AtlasTexCoord;
+layout(location = 2) flat in float SpriteLightLevel;
+
+layout(location = 0) out vec4 outColor;
+
+// Same units as fragment.frag, the atlas get its own
+layout(binding = 2) uniform sampler2D paletteTexture;
+layout(binding = 3) uniform usampler2D colorMapTexture;
+layout(binding = 4) uniform usampler2D spriteAtlas;
+
+const float MapScale = 100.0;
+
+// Same as getColorMapLevel in Palette.hpp
+int getColorMapLevel(float lightLevel, float distance){
+    int light = clamp(int(lightLevel) >> 4, 0, 15);
+    int startMap = (15 - light) * 4;
+    int scale = distance > 0.0 ? min(int(2560.0 / distance), 47) : 47;
+    return clamp(startMap - scale / 2, 0, 31);
+}
+
+void main(){
+    // Red is the palette index, green is zero in the holes between posts
+    uvec2 texel = texelFetch(spriteAtlas, ivec2(AtlasTexCoord), 0).rg;
+    if(texel.g == 0u){
+        discard;
+    }
+
+    uint shaded = texelFetch(colorMapTexture, ivec2(texel.r, getColorMapLevel(SpriteLightLevel, length(ViewPosition) * MapScale)), 0).r;
+    outColor = texelFetch(paletteTexture, ivec2(shaded, 0), 0);
+}
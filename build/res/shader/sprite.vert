@@ -0,0 +1,59 @@
+#version 460 core
+
+layout(location = 0) in vec3 InstancePosition;
+layout(location = 1) in float InstanceAngle;
+layout(location = 2) in uint InstanceFrame;
+layout(location = 3) in float InstanceLightLevel;
+
+layout(location = 1) uniform mat4 viewMatrix;
+layout(location = 2) uniform mat4 projectionMatrix;
+layout(location = 4) uniform vec3 eyePosition;
+
+struct SpriteImage{
+    ivec4 Rect;         // Atlas x y, width height
+    ivec2 Offset;       // Left, top like the patch header
+    ivec2 Padding;
+};
+
+layout(std430, binding = 0) readonly buffer SpriteImages{
+    SpriteImage images[];
+};
+
+// 8 rotations per frame, image in the low half, mirrored flag at bit 16
+layout(std430, binding = 1) readonly buffer SpriteFrames{
+    uint frames[];
+};
+
+layout(location = 0) out vec3 ViewPosition;
+layout(location = 1) out vec2 AtlasTexCoord;
+layout(location = 2) flat out float SpriteLightLevel;
+
+const float PI = 3.14159265;
+const float MapScale = 100.0;       // MapScaleFactor, offsets are in map units
+
+void main(){
+    // Same rotation as vanilla R_ProjectSprite, rotation 0 when the thing face the viewer
+    vec2 toEye = eyePosition.xz - InstancePosition.xz;
+    float angle = mod(atan(toEye.y, toEye.x) - InstanceAngle + PI / 8.0, 2.0 * PI);
+    int rotation = min(int(angle / (PI / 4.0)), 7);
+
+    uint entry = frames[InstanceFrame * 8 + rotation];
+    SpriteImage image = images[entry & 0xFFFFu];
+    bool isFlipped = (entry >> 16) != 0u;
+
+    // Strip 0 1 2 3 is top left, top right, bottom left, bottom right
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    // Camera right flattened, sprites never tilt with the pitch
+    vec3 right = normalize(vec3(viewMatrix[0][0], 0.0, viewMatrix[2][0]));
+    float x = corner.x * float(image.Rect.z) - float(image.Offset.x);
+    float y = float(image.Offset.y) - corner.y * float(image.Rect.w);
+    vec3 position = InstancePosition + (right * x + vec3(0.0, y, 0.0)) / MapScale;
+
+    AtlasTexCoord = vec2(image.Rect.xy) + vec2(isFlipped ? 1.0 - corner.x : corner.x, corner.y) * vec2(image.Rect.zw);
+    SpriteLightLevel = InstanceLightLevel;
+
+    vec4 viewPosition = viewMatrix * vec4(position, 1.0);
+    ViewPosition = viewPosition.xyz;
+    gl_Position = projectionMatrix * viewPosition;
+}
@@ -1,12 +1,27 @@
 #version 460 core
 
 layout(location = 0) in vec3 Position;
+layout(location = 1) in vec4 Color;
+layout(location = 2) in vec2 TexCoord;
+layout(location = 3) in float LightLevel;
+layout(location = 4) in float TextureSlot;
 
-uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+layout(location = 0) uniform mat4 modelMatrix;
+layout(location = 1) uniform mat4 viewMatrix;
+layout(location = 2) uniform mat4 projectionMatrix;
+
+layout(location = 0) out vec3 ViewPosition;
+layout(location = 1) out vec4 VertexColor;
+layout(location = 2) out vec2 VertexTexCoord;
+layout(location = 3) flat out float VertexLightLevel;
+layout(location = 4) flat out float VertexTextureSlot;
 
 void main(){
-    mat4 mvpMatrix = projectionMatrix * viewMatrix * modelMatrix;
-    gl_Position = mvpMatrix * vec4(Position, 1.0);
+    vec4 viewPosition = viewMatrix * modelMatrix * vec4(Position, 1.0);
+    ViewPosition = viewPosition.xyz;
+    VertexColor = Color;
+    VertexTexCoord = TexCoord;
+    VertexLightLevel = LightLevel;
+    VertexTextureSlot = TextureSlot;
+    gl_Position = projectionMatrix * viewPosition;
 }
\ No newline at end of file
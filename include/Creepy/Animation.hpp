@@ -0,0 +1,48 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <unordered_set>
+#include "Name8.hpp"
+
+struct WAD;
+struct TextureCache;
+struct TextureDefinition;
+
+constexpr int AnimationTics{8};         // Vanilla speed of every built in animation
+
+// ANIMATED entry, frames are every texture from First to Last in WAD order
+struct AnimationDefinition{
+    Name8 Last, First;
+    bool IsFlat{};
+    int Tics{AnimationTics};
+};
+
+// SWITCHES entry, Off is the texture the map name and On the one shown after use
+struct SwitchDefinition{
+    Name8 Off, On;
+    int Episode{};          // 1 shareware, 2 registered, 3 commercial
+};
+
+struct TextureAnimation{
+    std::vector<Name8> Frames;
+    bool IsFlat{};
+    int Tics{AnimationTics};
+};
+
+// Wall and flat animations of the WAD, the renderers never rebind or rewrite vertices for them
+// Each frame a cache index -> shown cache index table is made, GL and software path indirect through it
+struct TextureAnimations{
+    std::vector<TextureAnimation> Animations;
+    std::vector<SwitchDefinition> Switches;
+
+    // ANIMATED and SWITCHES when the WAD has them, else the vanilla tables
+    // definitions give the wall order, flats follow the directory
+    static TextureAnimations load(const WAD& wadFile, std::span<const TextureDefinition> definitions);
+
+    // Every frame of an animation the level show one of, and both sides of its switches
+    void addFrames(std::unordered_set<Name8>& wallNames, std::unordered_set<Name8>& flatNames) const;
+
+    // Identity for still textures, resized to the cache
+    void getFrames(const TextureCache& textureCache, uint32_t tic, std::vector<int>& wallFrames, std::vector<int>& flatFrames) const;
+};
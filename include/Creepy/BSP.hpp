@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Map.hpp"
+#include "GLMap.hpp"
+
+struct BSP{
+    static bool isPointOnBackSide(const GLNode& node, glm::vec2 point);
+    static uint16_t findSubSector(const GLMap& glMap, glm::vec2 point);
+    // Sector of the subsector holding point, taken from its first segment on a LineDef
+    static uint16_t findSector(const Map& map, const GLMap& glMap, glm::vec2 point);
+    static glm::vec2 getSegmentVertex(const Map& map, const GLMap& glMap, uint16_t vertexIndex);
+
+    // Visit subsectors front to back from viewPoint
+    // checkBox(const BoundingBox&, uint32_t boxIndex) -> false skip the child, boxIndex is node * 2 + side
+    // visitSubSector(uint16_t) -> false stop the walk
+    template <typename CheckBox, typename VisitSubSector>
+    static void traverse(const GLMap& glMap, glm::vec2 viewPoint, CheckBox&& checkBox, VisitSubSector&& visitSubSector);
+};
+
+template <typename CheckBox, typename VisitSubSector>
+void BSP::traverse(const GLMap& glMap, glm::vec2 viewPoint, CheckBox&& checkBox, VisitSubSector&& visitSubSector) {
+    if(glMap.nodes.empty()){
+        if(!glMap.subSectors.empty()){
+            visitSubSector(uint16_t{0});
+        }
+        return;
+    }
+
+    // Grow with the tree depth instead of dropping subtrees, capacity is kept per thread
+    thread_local std::vector<uint16_t> stack;
+    stack.clear();
+    stack.push_back(static_cast<uint16_t>(glMap.nodes.size() - 1));    // Root is last node
+
+    while(!stack.empty()){
+        const uint16_t child = stack.back();
+        stack.pop_back();
+
+        if(child & SubSectorFlag){
+            if(!visitSubSector(static_cast<uint16_t>(child & ~SubSectorFlag))){
+                return;
+            }
+            continue;
+        }
+
+        const auto& node = glMap.nodes[child];
+        const int frontSide = isPointOnBackSide(node, viewPoint) ? 1 : 0;
+        const int backSide = frontSide ^ 1;
+
+        // Stack is LIFO, push far side first
+        if(checkBox(node.boxes[backSide], child * 2u + static_cast<uint32_t>(backSide))){
+            stack.push_back(node.children[backSide]);
+        }
+
+        if(checkBox(node.boxes[frontSide], child * 2u + static_cast<uint32_t>(frontSide))){
+            stack.push_back(node.children[frontSide]);
+        }
+    }
+}
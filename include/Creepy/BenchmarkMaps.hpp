@@ -0,0 +1,14 @@
+#pragma once
+
+#include <utility>
+#include "Map.hpp"
+#include "GLMap.hpp"
+
+constexpr int MaxGridSize{120};     // Biggest grid the 16 bit segment indices hold
+
+// Synthetic levels for the software renderer benchmarks, no WAD needed
+struct BenchmarkMaps{
+    // gridSize x gridSize square sectors, each with its own light and a few units of floor and ceiling step
+    // Low steps keep the far sectors in view, from one edge a frame open thousands of visplanes
+    static std::pair<Map, GLMap> makeSectorGrid(int gridSize);
+};
@@ -9,4 +9,6 @@ struct Camera{
     glm::vec3 Forward, Right, Up;
 
     static void UpdateDirection(Camera& camera);
+    // Position and angles blended between two tics, directions made for the result
+    static Camera Interpolate(const Camera& previous, const Camera& current, float alpha);
 };
\ No newline at end of file
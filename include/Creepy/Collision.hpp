@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Map.hpp"
+
+// Player size of vanilla, map units
+constexpr float PlayerRadius{16.0f};
+constexpr float PlayerHeight{56.0f};
+constexpr float MaxStepHeight{24.0f};
+constexpr float ViewHeight{41.0f};
+
+struct Collision{
+    // Grid like a node builder make, for maps without a usable BLOCKMAP
+    static BlockMap buildBlockMap(const Map& map);
+
+    // Move a player circle standing at feetHeight, lines it can not cross take the part of move into them
+    // Only the cells around each step are searched, cost do not grow with the map
+    static glm::vec2 slideMove(const Map& map, glm::vec2 position, float feetHeight, glm::vec2 move);
+
+    static bool isBlocking(const Map& map, const LineDef& line, float feetHeight);
+
+    // visitLine(uint16_t) for every line of the cells overlapping min..max, a line in two cells come twice
+    template <typename VisitLine>
+    static void forEachLine(const BlockMap& blockMap, glm::vec2 min, glm::vec2 max, VisitLine&& visitLine);
+};
+
+template <typename VisitLine>
+void Collision::forEachLine(const BlockMap& blockMap, glm::vec2 min, glm::vec2 max, VisitLine&& visitLine) {
+    const glm::vec2 origin{blockMap.origin};
+    const int firstColumn = std::max(static_cast<int>(glm::floor((min.x - origin.x) / BlockSize)), 0);
+    const int lastColumn = std::min(static_cast<int>(glm::floor((max.x - origin.x) / BlockSize)), blockMap.columns - 1);
+    const int firstRow = std::max(static_cast<int>(glm::floor((min.y - origin.y) / BlockSize)), 0);
+    const int lastRow = std::min(static_cast<int>(glm::floor((max.y - origin.y) / BlockSize)), blockMap.rows - 1);
+
+    for(int row{firstRow}; row <= lastRow; ++row){
+        for(int column{firstColumn}; column <= lastColumn; ++column){
+            const size_t cell = static_cast<size_t>(row) * static_cast<size_t>(blockMap.columns) + static_cast<size_t>(column);
+            for(uint32_t i{blockMap.offsets[cell]}; i < blockMap.offsets[cell + 1]; ++i){
+                visitLine(blockMap.lines[i]);
+            }
+        }
+    }
+}
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cstdint>
 #include <string_view>
+#include "Visibility.hpp"
+
+constexpr uint32_t TicsPerSecond{35};       // Simulation rate of vanilla, animations count these too
 
 struct Engine{
 
     static void Init(const struct WAD& wadFile, std::string_view mapName);
-    static void Update(float deltaTime);
-    static void Render();
+    // One fixed tic, the main loop run as many as real time owe
+    static void Update();
+    // interpolation 0 draw the last tic, toward 1 the way to the next one
+    static void Render(float interpolation);
+    static void Shutdown();
+    static const VisibilityStats& GetVisibilityStats();
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Boxes split per component so 4 or 8 boxes load in one register
+struct BoundsSoA{
+    std::vector<float> MinX, MinY, MinZ;
+    std::vector<float> MaxX, MaxY, MaxZ;
+
+    void clear();
+    void reserve(size_t count);
+    void push(glm::vec3 min, glm::vec3 max);
+    size_t size() const;
+};
+
+struct Frustum{
+    std::array<glm::vec4, 6> Planes;    // xyz: Normal point inside, w: Distance
+
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+    bool isBoxVisible(glm::vec3 min, glm::vec3 max) const;
+
+    // Append index of every visible box, use widest SIMD the CPU support
+    uint32_t cullBoxes(const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices) const;
+    uint32_t cullBoxesScalar(const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices) const;
+
+    static const char* getCullKernelName();
+
+    // Time SIMD kernel against scalar reference on random boxes and check they agree
+    static void benchmarkCulling(uint32_t numBoxes, uint32_t numIterations);
+};
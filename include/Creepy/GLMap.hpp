@@ -3,6 +3,10 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+constexpr uint16_t GLVertexFlag{0x8000};        // Segment vertex index into GLMap vertices
+constexpr uint16_t SubSectorFlag{0x8000};       // Node child is a subsector
+constexpr uint16_t NoLineDef{0xFFFF};           // Mini segment along subsector edge
+
 struct GLSubSector{
     uint16_t numSegments;
     uint16_t firstSegment;
@@ -13,10 +17,21 @@ struct GLSegment{
     uint16_t lineDef{}, side{};
 };
 
+struct BoundingBox{
+    glm::vec2 min, max;
+};
+
+struct GLNode{
+    glm::vec2 partition, direction;
+    BoundingBox boxes[2];       // Right (front), left (back)
+    uint16_t children[2];
+};
+
 struct GLMap
 {
     std::vector<glm::vec2> vertices;
     std::vector<GLSegment> segments;
     std::vector<GLSubSector> subSectors;
+    std::vector<GLNode> nodes;
     glm::vec2 min, max;
 };
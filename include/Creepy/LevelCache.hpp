@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include "PVS.hpp"
+#include "Name8.hpp"
+
+struct WAD;
+struct Palette;
+struct TextureCache;
+
+// Mip chain of a wall texture, the hash of its base texels tell if the composed texture changed
+struct CachedMips{
+    Name8 Name;
+    uint64_t TexelHash{};
+    std::vector<uint8_t> Mips;
+};
+
+// Load time data derived from the map lumps, kept on disk so the next start skip the work
+struct LevelCache{
+    uint64_t Key{};
+    PVS SectorVisibility;
+    std::vector<CachedMips> TextureMips;    // Only filled between disk and the TextureCache, moved out on load
+
+    static void setCacheDirectory(const std::filesystem::path& directory);
+    static uint64_t makeKey(const WAD& wadFile, std::string_view mapName);
+
+    // Load from disk if key match, else compute and store
+    // Level textures of textureCache get their Mips from disk, missing ones are generated with palette
+    static LevelCache loadOrBuild(const WAD& wadFile, std::string_view mapName, const Map& map, TextureCache& textureCache, const Palette& palette);
+
+    static std::optional<LevelCache> load(const std::filesystem::path& filePath, uint64_t key);
+    static void store(const std::filesystem::path& filePath, const LevelCache& levelCache);
+};
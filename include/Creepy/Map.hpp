@@ -2,14 +2,33 @@
 
 #include <vector>
 #include <glm/glm.hpp>
+#include "Name8.hpp"
+
+constexpr float MapScaleFactor{100.0f};     // Map units per world unit
 
 enum class LineDefFormat : uint16_t{
     PLAYER = 0x0001,
     MONSTER = 0x0002,
     TWO_SIDE = 0x0004,
+    UPPER_UNPEGGED = 0x0008,
+    LOWER_UNPEGGED = 0x0010,
     SECRET = 0x0020
 };
 
+enum class ThingFlag : uint16_t{
+    EASY = 0x0001,
+    MEDIUM = 0x0002,
+    HARD = 0x0004,
+    AMBUSH = 0x0008,
+    MULTIPLAYER = 0x0010
+};
+
+struct Thing{
+    int16_t x{}, y{};
+    uint16_t angle{};       // Degrees, 0 is east
+    uint16_t type{}, flags{};
+};
+
 struct LineDef{
     uint16_t startIndex{}, endIndex{};
     uint16_t flags{};
@@ -17,18 +36,34 @@ struct LineDef{
 };
 
 struct SideDef{
+    int16_t xOffset{}, yOffset{};
+    Name8 upperTexture, lowerTexture, middleTexture;     // "-" for none
     uint16_t sectorIndex{};
 };
 
 struct Sector{
     int16_t floor{}, ceiling{};
     int16_t lightLevel{};
+    Name8 floorTexture, ceilingTexture;
+};
+
+constexpr int BlockSize{128};       // Map units per BLOCKMAP cell
+
+// LineDefs touching each cell of a grid over the map, read from BLOCKMAP or built by Collision
+// Cell (x, y) own lines[offsets[y * columns + x] .. offsets[y * columns + x + 1])
+struct BlockMap{
+    glm::ivec2 origin{};
+    int columns{}, rows{};
+    std::vector<uint32_t> offsets;
+    std::vector<uint16_t> lines;
 };
 
 struct Map{
     std::vector<glm::vec2> vertices;
     glm::vec2 min, max;
+    std::vector<Thing> things;
     std::vector<LineDef> lineDefs;
     std::vector<SideDef> sideDefs;
     std::vector<Sector> sectors;
+    BlockMap blockMap;
 };
\ No newline at end of file
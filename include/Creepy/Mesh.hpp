@@ -6,6 +6,14 @@
 
 struct Vertex{
     glm::vec3 Position;
+    glm::vec4 Color{1.0f};
+    glm::vec2 TexCoord{};           // In texels, wrap in the shader
+    float LightLevel{255.0f};       // Sector light, pick the COLORMAP row
+    float TextureSlot{};            // TextureAtlas slot, the shader look up its layer
+};
+
+struct MeshRange{
+    uint32_t FirstIndex{}, NumIndices{};
 };
 
 struct Mesh{
@@ -13,4 +21,4 @@ struct Mesh{
     uint32_t NumIndices{};
 
     static Mesh createMesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices);
-};
\ No newline at end of file
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Palette.hpp"
+
+struct TextureCache;
+
+constexpr int PaletteGridBits{5};                                   // Per channel, 32 x 32 x 32 sRGB cells
+constexpr int PaletteGridSize{1 << PaletteGridBits};
+constexpr int LinearSteps{4096};
+
+// Mips of palette indices, averaging the indices themselves mix unrelated colors so 2 x 2 boxes
+// are averaged in linear RGB and mapped back to the nearest PLAYPAL entry through a 3D table
+struct MipChain{
+    std::array<glm::vec4, 256> LinearColors;
+    std::array<uint8_t, LinearSteps> LinearToCell;                  // Quantized linear channel -> sRGB cell
+    std::vector<uint8_t> NearestIndex;                              // Red, green, blue cell -> palette index
+
+    static MipChain build(const Palette& palette);
+
+    // Level 0 included, every level is half the last one and at least 1 like GL
+    static int getLevelCount(int width, int height);
+    // Texels of levels 1 and down back to back
+    static size_t getChainSize(int width, int height);
+
+    // Rows of width texels, column major textures pass their height as width, a box does not care
+    void generate(std::span<const uint8_t> texels, int width, int height, std::span<uint8_t> mips) const;
+
+    // Current level wall textures still without Mips, spread over numThreads, 0 use every hardware thread
+    void generateMissing(TextureCache& textureCache, int numThreads = 0) const;
+};
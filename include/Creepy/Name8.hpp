@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <functional>
+
+// Lump, texture and flat names are at most 8 chars, packed upper case into one integer
+// First char in the high byte so integer order is also name order
+struct Name8{
+    uint64_t Value{};
+
+    constexpr Name8() = default;
+
+    constexpr Name8(std::string_view name) {
+        for(size_t i{}; i < 8 && i < name.size() && name[i] != '\0'; ++i){
+            const char c = (name[i] >= 'a' && name[i] <= 'z') ? static_cast<char>(name[i] - 'a' + 'A') : name[i];
+            Value |= static_cast<uint64_t>(static_cast<uint8_t>(c)) << (56 - i * 8);
+        }
+    }
+
+    // Literals and raw 8 byte directory names, stop at the first null either way
+    template <size_t N>
+    constexpr Name8(const char (&name)[N]) : Name8{std::string_view{name, N}} {}
+
+    constexpr char at(size_t index) const {
+        return index < 8 ? static_cast<char>((Value >> (56 - index * 8)) & 0xFF) : '\0';
+    }
+
+    constexpr size_t size() const {
+        size_t length{};
+        while(length < 8 && at(length) != '\0'){
+            ++length;
+        }
+        return length;
+    }
+
+    constexpr bool isEmpty() const {
+        return Value == 0;
+    }
+
+    // First length chars, "TROOA1" -> "TROO"
+    constexpr Name8 prefix(size_t length) const {
+        return length >= 8 ? *this : Name8{Value & ~(~uint64_t{} >> (length * 8))};
+    }
+
+    std::string toString() const {
+        std::string name(size(), '\0');
+        for(size_t i{}; i < name.size(); ++i){
+            name[i] = at(i);
+        }
+        return name;
+    }
+
+    constexpr bool operator==(const Name8&) const = default;
+    constexpr auto operator<=>(const Name8&) const = default;
+
+private:
+    constexpr explicit Name8(uint64_t value) : Value{value} {}
+};
+
+template <>
+struct std::hash<Name8>{
+    size_t operator()(const Name8& name) const noexcept {
+        // Murmur3 finalizer, packed names share most of their high bits
+        uint64_t value = name.Value;
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return static_cast<size_t>(value);
+    }
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Map.hpp"
+#include "Frustum.hpp"
+
+struct OcclusionStats{
+    uint32_t Occluders{}, OccluderTriangles{};
+    uint32_t TestedBoxes{}, RejectedBoxes{};
+    float RasterMicroseconds{}, WaitMicroseconds{};
+};
+
+// Software hierarchical Z, the biggest solid walls are rasterized on a worker thread
+// into a low resolution depth buffer while the main thread walk the BSP
+struct OcclusionCulling{
+    static void init(const Map& map);
+    static void shutdown();
+
+    // View projection from map units, y up
+    static void beginFrame(const glm::mat4& viewProjection, glm::vec3 viewPosition);
+    static void endFrame();
+
+    // Append the indices whose box is not hidden behind the occluders
+    static void filterVisible(const BoundsSoA& bounds, std::span<const uint32_t> indices, std::vector<uint32_t>& visibleIndices);
+
+    static const OcclusionStats& getStats();
+};
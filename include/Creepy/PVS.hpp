@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include "Map.hpp"
+
+// Sector to sector potentially visible set, each row is a zero run length compressed bit set
+struct PVS{
+    uint32_t NumSectors{};
+    std::vector<uint32_t> RowOffsets;
+    std::vector<uint8_t> Data;
+
+    static PVS compute(const Map& map);
+
+    // bits is resized to hold one bit per sector
+    void decompressRow(uint32_t sector, std::vector<uint8_t>& bits) const;
+    bool isEmpty() const;
+};
+
+inline bool isSectorVisible(const std::vector<uint8_t>& bits, uint32_t sector){
+    return (bits[sector >> 3] >> (sector & 7)) & 1;
+}
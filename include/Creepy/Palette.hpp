@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+constexpr int NumLightLevels{32};
+constexpr int NumColorMaps{34};     // 32 light levels, invulnerability, all black
+
+// PLAYPAL first palette, the other 13 are damage and pickup tints
+struct Palette{
+    std::array<glm::u8vec3, 256> Colors;
+
+    static Palette makeFallback();
+};
+
+// COLORMAP, index by light level then palette index
+struct ColorMap{
+    std::array<std::array<uint8_t, 256>, NumColorMaps> Maps;
+
+    static ColorMap makeFallback();
+};
+
+// Vanilla light tables, 0 is full bright and 31 darkest
+inline int getColorMapLevel(int16_t lightLevel, float distance, int lightOffset = 0){
+    const int light = std::clamp((lightLevel >> 4) + lightOffset, 0, 15);
+    const int startMap = (15 - light) * 4;
+    const int scale = distance > 0.0f ? std::min(static_cast<int>(2560.0f / distance), 47) : 47;
+    return std::clamp(startMap - scale / 2, 0, NumLightLevels - 1);
+}
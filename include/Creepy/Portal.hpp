@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include "Map.hpp"
+
+// Two-sided LineDef between two different sectors
+struct Portal{
+    glm::vec2 start, end;       // Front sector on the right, back sector on the left
+    uint16_t sectors[2];        // Front, back
+};
+
+struct PortalSegment{
+    glm::vec2 start, end;
+};
+
+// Portal seen from one sector
+struct PortalLink{
+    uint32_t portal;
+    uint16_t nextSector;
+    bool isReversed;
+};
+
+struct PortalGraph{
+    std::vector<Portal> portals;
+    std::vector<uint32_t> lineDefs;                 // LineDef of each portal
+    std::vector<std::vector<PortalLink>> links;     // Per sector
+
+    static PortalGraph build(const Map& map);
+
+    // Oriented so the next sector lies on the left
+    PortalSegment getSegment(const PortalLink& link) const;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Map.hpp"
+
+struct PortalCulling{
+    static void init(const Map& map);
+
+    // Walk sectors from viewSector through open portals, narrowing the view cone at each one
+    // tanHalfAngle <= 0 mean the horizontal view is unbounded, pvsRow skip sectors the PVS already reject
+    // Return number of portals crossed
+    static uint32_t update(glm::vec2 viewPoint, glm::vec2 forward, float tanHalfAngle, uint16_t viewSector, const std::vector<uint8_t>* pvsRow);
+
+    // One bit per sector, same layout as PVS rows
+    static const std::vector<uint8_t>& getVisibleSectors();
+    static uint32_t getNumVisibleSectors();
+};
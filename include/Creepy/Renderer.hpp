@@ -1,6 +1,8 @@
 #pragma once
 
+#include <span>
 #include <glm/glm.hpp>
+#include "ShaderPermutations.hpp"
 
 struct Renderer{
     static void initRenderer(int width, int height);
@@ -8,9 +10,25 @@ struct Renderer{
     static void clearRenderer();
     static void setViewMatrix(const glm::mat4& viewMatrix);
     static void setProjectionMatrix(const glm::mat4& projectionMatrix);
+    static void setShaderFeatures(ShaderFeature features);
     static glm::ivec2 getSize();
+
+    // PLAYPAL and COLORMAP as lookup textures for the PALETTE feature, the indexed array go on unit 1
+    static void setPalette(const struct Palette& palette, const struct ColorMap& colorMap);
+    static void bindTexture(const struct TextureArray& textureArray);
+    // TextureAtlas SlotLayers, one small upload whatever number of walls animate
+    static void setTextureRemap(std::span<const uint32_t> slotLayers);
     static void drawPoint(glm::vec2 point, float size, const glm::vec4& color);
     static void drawLine(glm::vec2 point0, glm::vec2 point1, float lineWidth, const glm::vec4& color);
     static void drawQuad(glm::vec2 center, glm::vec2 size, float angle, const glm::vec4& color);
     static void drawMesh(const struct Mesh& mesh, const glm::mat4& transform, const glm::vec4& color);
+    static void drawMeshRanges(const struct Mesh& mesh, std::span<const struct MeshRange> ranges, const glm::mat4& transform, const glm::vec4& color);
+
+    // Sprite atlas, rotation table and every instance of the level, uploaded once
+    static void setSprites(const struct SpriteSet& sprites, std::span<const struct SpriteInstance> instances);
+    // Ranges of the uploaded instances in one indirect draw, billboards face the camera and stay upright
+    static void drawSprites(std::span<const struct SpriteRange> ranges);
+
+    // Stretch a CPU image over the whole window, rows are top first
+    static void blitImage(std::span<const uint8_t> rgba, int width, int height);
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+struct ClipRange{
+    int first{}, last{};    // Inclusive screen columns
+};
+
+// Sorted, merged list of fully occluded screen column ranges (Doom solidsegs)
+struct ScreenClipper{
+    std::vector<ClipRange> Ranges;
+    int Width{};
+
+    void reset(int width);
+    bool isOccluded(int first, int last) const;
+    void addOccluder(int first, int last);
+    bool isFull() const;
+
+    // visit(first, last) for each sub range not yet occluded
+    template <typename Visit>
+    void forEachVisibleRange(int first, int last, Visit&& visit) const;
+};
+
+template <typename Visit>
+void ScreenClipper::forEachVisibleRange(int first, int last, Visit&& visit) const {
+    first = std::max(first, 0);
+    last = std::min(last, Width - 1);
+
+    for(const auto& range : Ranges){
+        if(first > last){
+            return;
+        }
+
+        if(range.last < first){
+            continue;
+        }
+
+        if(range.first > last){
+            break;
+        }
+
+        if(range.first > first){
+            visit(first, range.first - 1);
+        }
+
+        first = range.last + 1;
+    }
+
+    if(first <= last){
+        visit(first, last);
+    }
+}
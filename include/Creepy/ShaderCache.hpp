@@ -0,0 +1,18 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <glad/glad.h>
+
+struct ShaderSource{
+    GLenum Type;
+    std::string Source;
+};
+
+struct ShaderCache{
+    static void setCacheDirectory(const std::filesystem::path& directory);
+
+    // Load program binary from disk if driver accept it, else compile from source and store the binary
+    static GLuint loadProgram(std::span<const ShaderSource> sources);
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <glad/glad.h>
+
+struct GLFWwindow;
+
+enum class ShaderFeature : uint32_t{
+    NONE = 0,
+    LIGHT_DIMINISHING = 1 << 0,
+    FOG = 1 << 1,
+    DEBUG_COLOR = 1 << 2,
+    PALETTE = 1 << 3        // Texture is palette indices, shaded through COLORMAP
+};
+
+constexpr ShaderFeature operator|(ShaderFeature left, ShaderFeature right){
+    return static_cast<ShaderFeature>(static_cast<uint32_t>(left) | static_cast<uint32_t>(right));
+}
+
+constexpr bool hasFeature(ShaderFeature features, ShaderFeature feature){
+    return (static_cast<uint32_t>(features) & static_cast<uint32_t>(feature)) != 0;
+}
+
+// layout(location) of vertex.vert and fragment.frag, SPIR-V may strip the names so these are the truth
+// Reflection only check them
+constexpr GLint ModelMatrixLocation{0};
+constexpr GLint ViewMatrixLocation{1};
+constexpr GLint ProjectionMatrixLocation{2};
+constexpr GLint ColorLocation{3};
+
+struct ShaderProgram{
+    GLuint Program{};
+    ShaderFeature Features{};
+    std::unordered_map<std::string, GLint> Uniforms;        // Name -> Location, empty for unnamed SPIR-V
+    std::unordered_map<std::string, GLint> UniformBlocks;   // Name -> Binding
+
+    GLint getUniform(const std::string& name) const;
+};
+
+struct ShaderPermutations{
+    // Compile generic variant and start worker on a context shared with mainWindow
+    static void init(GLFWwindow* mainWindow);
+    static void shutdown();
+
+    // Queue variant for background compile, no-op if already ready or queued
+    static void request(ShaderFeature features);
+
+    // Return requested variant if ready, else the generic one and queue the variant
+    static const ShaderProgram& getProgram(ShaderFeature features);
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Palette.hpp"
+
+// Sources are read 4 bytes at a time by gathers, keep 3 bytes of padding after texels
+constexpr int KernelSourcePadding{3};
+
+// COLORMAP rows back to back with the padding after the last one, ColorMap itself has none
+struct KernelColorMap{
+    std::vector<uint8_t> Colors;
+
+    static KernelColorMap make(const ColorMap& colorMap);
+    const uint8_t* getRow(int level) const;
+};
+
+// Vertical run of one wall column, pixel i sample v = VStart + Step * i
+struct ColumnJob{
+    uint8_t* Destination{};
+    int Pitch{};
+    int Count{};
+    const uint8_t* Source{};        // Texture column
+    int SourceMask{};               // Column height - 1, power of two
+    float VStart{}, Step{};
+    const uint8_t* ColorMap{};
+};
+
+// Horizontal run of a 64 x 64 flat, pixel x sample RowCenter + Step * x
+struct SpanJob{
+    uint8_t* Destination{};
+    int FirstX{}, Count{};
+    const uint8_t* Source{};        // Flat, row major
+    glm::vec2 RowCenter{}, Step{};
+    const uint8_t* ColorMap{};
+};
+
+struct SoftwareKernels{
+    // Self test and time the SIMD kernels once, scalar until then
+    static void init();
+
+    static void drawColumn(const ColumnJob& job);
+    static void drawSpan(const SpanJob& job);
+
+    // Reference kernels, every SIMD kernel must match them pixel for pixel
+    static void drawColumnScalar(const ColumnJob& job);
+    static void drawSpanScalar(const SpanJob& job);
+
+    static const char* getKernelName();
+};
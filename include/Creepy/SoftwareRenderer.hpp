@@ -0,0 +1,48 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include "Map.hpp"
+#include "GLMap.hpp"
+#include "Palette.hpp"
+#include "TextureCache.hpp"
+
+struct SoftwareFrame{
+    int Width{}, Height{};
+    std::vector<uint8_t> Pixels;    // Palette index, row major from the top
+
+    void toRGBA(const Palette& palette, std::vector<uint8_t>& rgba) const;
+    bool writePPM(const std::filesystem::path& filePath, const Palette& palette) const;
+};
+
+struct SoftwareStats{
+    uint32_t Segments{}, Columns{}, Spans{};
+    uint32_t VisPlanes{};
+    uint32_t Strips{}, Threads{};
+    float Milliseconds{};
+};
+
+// Vanilla style renderer: front to back BSP walk, wall columns clipped per column,
+// floors and ceilings gathered in visplanes then drawn as horizontal spans
+// Screen is cut in vertical strips, each walk the BSP with its own clip arrays and visplanes
+struct SoftwareRenderer{
+    // numThreads 0 use every hardware thread, call again to resize or change threads
+    // Walls use placeholder bricks when textureCache is empty
+    static void init(const Map& map, const GLMap& glMap, const Palette& palette, const ColorMap& colorMap, const TextureCache& textureCache, int width, int height, int numThreads = 0);
+    static void shutdown();
+
+    // Position in map units, y up, pitch is done by shearing like Heretic
+    static void render(glm::vec3 position, glm::vec3 forward);
+
+    // Cache index -> shown cache index from TextureAnimations::getFrames, SideDefs and Sectors read through it
+    static void setAnimationFrames(std::span<const int> wallFrames, std::span<const int> flatFrames);
+
+    static const SoftwareFrame& getFrame();
+    static const Palette& getPalette();
+    static const SoftwareStats& getStats();
+
+    // Average and worst frame time over resolutions and thread counts from spread out view points
+    static void benchmarkScaling(const Map& map, const GLMap& glMap, const Palette& palette, const ColorMap& colorMap, const TextureCache& textureCache, int numFrames);
+};
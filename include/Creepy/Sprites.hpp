@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include "Name8.hpp"
+
+struct WAD;
+struct Map;
+struct GLMap;
+
+constexpr int NumRotations{8};
+constexpr int SpriteAtlasWidth{2048};
+constexpr uint16_t NoSpriteImage{0xFFFF};
+
+// Sprite lump placed in the atlas, offsets are from the patch header like vanilla
+struct SpriteImage{
+    Name8 Name;
+    int Width{}, Height{};
+    int LeftOffset{}, TopOffset{};
+    glm::ivec2 AtlasPosition{};
+};
+
+// One animation frame seen from 8 sides, rotation 0 lumps fill them all
+// The second name of a lump like TROOA2A8 is the same image mirrored
+struct SpriteFrame{
+    std::array<uint16_t, NumRotations> Images;
+    uint8_t FlipMask{};             // Bit per rotation
+};
+
+// Frames of one sprite name are contiguous, A first
+struct SpriteDefinition{
+    int FirstFrame{}, NumFrames{};
+};
+
+// Per instance data of the billboard draw, laid out like the instance buffer
+struct SpriteInstance{
+    glm::vec3 Position;             // World units, bottom middle of the sprite
+    float Angle{};                  // Radians, rotation 0 face this way
+    uint32_t Frame{};               // SpriteSet Frames index
+    float LightLevel{255.0f};
+};
+
+// Contiguous instances of the buffer setSprites uploaded
+struct SpriteRange{
+    uint32_t FirstInstance{}, NumInstances{};
+
+    bool operator==(const SpriteRange&) const = default;
+};
+
+// Every sprite of the WAD decoded once, rotations resolved to a table the shader read directly
+struct SpriteSet{
+    std::vector<SpriteImage> Images;
+    std::vector<SpriteFrame> Frames;
+    std::unordered_map<Name8, SpriteDefinition> Definitions;           // "TROO" -> frames
+    std::vector<glm::u8vec2> AtlasTexels;                               // Palette index, 255 where opaque
+    glm::ivec2 AtlasSize{};
+
+    // Lumps between S_START and S_END, PWADs add SS_START and SS_END
+    static SpriteSet load(const WAD& wadFile);
+
+    // -1 when the sprite or frame is missing
+    int findFrame(Name8 sprite, char frame) const;
+
+    // Things of single player on ultra violence, unknown types are skipped
+    std::vector<SpriteInstance> placeThings(const Map& map, const GLMap& glMap) const;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+struct TextureCache;
+
+// Palette indices in one byte per texel, the PALETTE shader feature shade them through COLORMAP
+// Every layer has the same size so the shader wrap with textureSize
+struct TextureArray{
+    GLuint Id{};
+    int Width{}, Height{}, Layers{}, Levels{1};
+    std::vector<uint8_t> Texels;        // Copy of what GL hold for the tile rasterizer, level after level, layers inside
+
+    static TextureArray createIndexed(int width, int height, int layers, int levels = 1);
+
+    // Row major, indices of the level size, each level half the last and at least 1
+    void uploadLayer(int layer, std::span<const uint8_t> indices, int level = 0);
+    // Empty past the last layer or level
+    std::span<const uint8_t> getLayer(int layer, int level = 0) const;
+};
+
+constexpr size_t MaxTextureSlots{4096};     // uvec4 packed in the 16 KiB every GL give a uniform block
+constexpr size_t DefaultAtlasBudget{64u << 20};     // Bytes of VRAM the level textures may take, mips included
+
+// Level textures grouped by exact size, a size class is one array and one draw
+// Vertices carry a slot not a layer, the shader read the layer from SlotLayers so animations only upload that
+struct TextureAtlas{
+    std::vector<TextureArray> Arrays;
+    std::vector<glm::ivec2> Locations;      // TextureCache index -> array, layer, -1 when not in the level
+    std::vector<int> Slots;                 // TextureCache index -> slot, -1 when not in the level
+    std::vector<uint32_t> SlotLayers;       // Slot -> layer shown, slot 0 is layer 0 of the placeholder
+
+    // Size classes over budgetBytes go without mips, if still over their textures stay out and use the placeholder
+    static TextureAtlas build(const TextureCache& textureCache, size_t budgetBytes = DefaultAtlasBudget);
+
+    // Delete the GL arrays, call before building the next level
+    void release();
+
+    // wallFrames from TextureAnimations::getFrames, true when a slot changed
+    // A frame in another size class can not be reached from the bound array and is skipped
+    bool animate(std::span<const int> wallFrames);
+};
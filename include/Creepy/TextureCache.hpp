@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "Name8.hpp"
+#include "Animation.hpp"
+
+struct WAD;
+struct Map;
+
+constexpr size_t DefaultTextureBudget{32u << 20};  // Bytes of texels kept between levels
+constexpr int FlatSize{64};
+
+// TEXTURE1 / TEXTURE2 entry, patches are drawn in order over each other
+struct PatchPlacement{
+    int16_t OriginX{}, OriginY{};
+    uint16_t Patch{};       // Index into PNAMES
+};
+
+struct TextureDefinition{
+    Name8 Name;
+    int Width{}, Height{};
+    std::vector<PatchPlacement> Patches;
+};
+
+// Palette indices, walls are column major like patches so a wall column is contiguous, flats stay row major
+struct CompositeTexture{
+    Name8 Name;
+    int Width{}, Height{};
+    std::vector<uint8_t> Texels;
+    std::vector<uint8_t> Mips;          // Levels 1 and down back to back, same major order, see MipChain
+    uint32_t LastUsedLevel{};
+};
+
+struct ResidencyStats{
+    uint32_t Composed{}, Reused{}, Evicted{};
+    size_t LevelBytes{}, ResidentBytes{};
+    float Milliseconds{};
+};
+
+// Wall textures and flats of the loaded levels, the GL and software paths both read from here
+// loadLevel bring in what the level name and evict the least recently used ones over the budget
+struct TextureCache{
+    std::vector<CompositeTexture> Textures;
+    std::vector<CompositeTexture> Flats;
+    std::unordered_map<Name8, int> Indices;         // Name -> Textures index
+    std::unordered_map<Name8, int> FlatIndices;     // Name -> Flats index
+    size_t BudgetBytes{DefaultTextureBudget};
+    uint32_t Level{};                                   // Bumped by loadLevel, LastUsedLevel compare to it
+    ResidencyStats Stats;
+    TextureAnimations Animations;                       // Of the WAD given to loadLevel
+
+    // New cache holding what map use, numThreads 0 use every hardware thread
+    static TextureCache build(const WAD& wadFile, const Map& map, int numThreads = 0);
+    static TextureCache buildAll(const WAD& wadFile, int numThreads = 0);
+
+    // Indices change after eviction, consumers rebuild their copies per level
+    void loadLevel(const WAD& wadFile, const Map& map, int numThreads = 0);
+
+    // -1 for "-" and unknown names
+    int find(Name8 name) const;
+    int findFlat(Name8 name) const;
+    bool isInLevel(const CompositeTexture& texture) const;
+
+    // Every TEXTURE1 / TEXTURE2 entry over thread counts
+    static void benchmark(const WAD& wadFile, int numRuns);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.hpp"
+#include "ShaderPermutations.hpp"
+
+struct RasterStats{
+    uint32_t Triangles{}, ClippedTriangles{}, BinnedTriangles{};
+    uint32_t Sprites{};
+    uint32_t Tiles{}, Threads{};
+    float BinMilliseconds{}, RasterMilliseconds{};
+};
+
+// CPU stand in for the GL path, same vertex data, matrices and shading as the world and sprite shaders
+// Texture state mirror Renderer, bound arrays and the sprite set are read at endFrame so they must outlive it
+// Triangles are binned into 64 x 64 tiles at draw, tiles rasterize in parallel at endFrame
+struct TileRasterizer{
+    // numThreads 0 use every hardware thread, call again to resize
+    static void init(int width, int height, int numThreads = 0);
+    static void shutdown();
+
+    static void setViewMatrix(const glm::mat4& viewMatrix);
+    static void setProjectionMatrix(const glm::mat4& projectionMatrix);
+    static void setShaderFeatures(ShaderFeature features);
+
+    // Copies of PLAYPAL, COLORMAP and SlotLayers, the PALETTE feature shade through them
+    static void setPalette(const struct Palette& palette, const struct ColorMap& colorMap);
+    static void setTextureRemap(std::span<const uint32_t> slotLayers);
+    // Index array of the next draws like unit 1, its CPU texels are sampled
+    static void bindTexture(const struct TextureArray& textureArray);
+    // Atlas is read from sprites, instances are copied
+    static void setSprites(const struct SpriteSet& sprites, std::span<const struct SpriteInstance> instances);
+
+    static void beginFrame(const glm::vec4& clearColor);
+    static void drawMeshRanges(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::span<const MeshRange> ranges, const glm::mat4& transform, const glm::vec4& color);
+    // Billboards built like sprite.vert, atlas holes are discarded before the depth write
+    static void drawSprites(std::span<const struct SpriteRange> ranges);
+    static void endFrame();
+
+    // RGBA8, rows are top first like Renderer::blitImage want
+    static std::span<const uint8_t> getColorBuffer();
+    static glm::ivec2 getSize();
+    static const RasterStats& getStats();
+};
@@ -3,11 +3,20 @@
 #include <filesystem>
 #include <string_view>
 #include <span>
+#include <vector>
 #include <glad/glad.h>
 
 
 std::string readShaderFile(const std::filesystem::path& filePath);
 
+std::vector<std::byte> readBinaryFile(const std::filesystem::path& filePath);
+
 GLuint compileShader(GLenum type, std::string_view src);
 
-GLuint linkProgram(std::span<const GLuint> shaders);
\ No newline at end of file
+GLuint loadSpirvShader(GLenum type, std::span<const std::byte> binary, 
+    std::span<const GLuint> constantIndices, std::span<const GLuint> constantValues);
+
+GLuint linkProgram(std::span<const GLuint> shaders, bool retrievableBinary = false);
+
+// FNV-1a, chain calls by passing the previous hash as seed
+uint64_t hashBytes(std::span<const std::byte> data, uint64_t seed = 0xcbf29ce484222325ull);
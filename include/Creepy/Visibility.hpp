@@ -0,0 +1,44 @@
+#pragma once
+
+#include <span>
+#include <glm/glm.hpp>
+#include "Map.hpp"
+#include "GLMap.hpp"
+#include "PVS.hpp"
+#include "Frustum.hpp"
+
+struct ViewState{
+    glm::vec3 Position;         // Map units, y up
+    glm::vec3 Forward;
+    glm::mat4 Projection;
+    glm::mat4 ViewProjection;   // From map units
+    int ScreenWidth{};
+};
+
+struct VisibilityStats{
+    uint32_t VisitedNodes{}, CulledNodes{}, OccludedNodes{};
+    uint32_t VisibleSubSectors{}, CulledSubSectors{}, OccludedSubSectors{};
+    uint32_t OccludedSegments{};
+    uint32_t PVSRejectedSubSectors{};
+    uint32_t PortalCrossings{}, PortalVisibleSectors{}, PortalRejectedSubSectors{};
+    float PortalMicroseconds{};
+    int32_t ViewSector{-1};     // -1 when view is outside the map, PVS and portals unused
+    bool CacheHit{};
+    uint32_t CacheAge{};
+    uint64_t CacheHits{}, CacheQueries{};
+    float UpdateMicroseconds{}, FullMicroseconds{}, SavedMicroseconds{};
+    uint32_t VisibleLineDefs{}, TotalLineDefs{};
+    bool ScreenCovered{};
+};
+
+struct Visibility{
+    static void init(const Map& map, const GLMap& glMap, const PVS* pvs = nullptr);
+    static void update(const ViewState& view);
+
+    // Front to back order
+    static std::span<const uint32_t> getVisibleLineDefs();
+    // Wider than the real frustum, only refreshed by a full walk
+    static std::span<const uint16_t> getVisibleSubSectors();
+    static const BoundsSoA& getLineDefBounds();     // Map units, y up
+    static const VisibilityStats& getStats();
+};
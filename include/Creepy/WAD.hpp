@@ -3,12 +3,16 @@
 #include <optional>
 #include <filesystem>
 #include <vector>
+#include "Name8.hpp"
 #include "Map.hpp"
 #include "GLMap.hpp"
+#include "Palette.hpp"
+#include "TextureCache.hpp"
+#include "Animation.hpp"
 
 struct Lump{
     uint32_t size;
-    char name[9];
+    Name8 name;
     std::vector<std::byte> data;
 };
 
@@ -18,9 +22,15 @@ struct WAD{
     std::vector<Lump> lumps;
 
     static std::optional<WAD> loadFromFile(const std::filesystem::path& filePath);
-    static int findLump(std::string_view lumpName, const WAD& wadFile);
+    static int findLump(Name8 lumpName, const WAD& wadFile);
     static std::optional<Map> readMap(std::string_view mapName, const WAD& wadFile);
     static std::optional<GLMap> readGLMap(std::string_view glMapName, const WAD& wadFile);
-    
+    static std::optional<Palette> readPalette(const WAD& wadFile);
+    static std::optional<ColorMap> readColorMap(const WAD& wadFile);
+    static std::optional<std::vector<Name8>> readPatchNames(const WAD& wadFile);
+    static std::optional<std::vector<TextureDefinition>> readTextureDefinitions(const WAD& wadFile);
+    static std::optional<std::vector<AnimationDefinition>> readAnimations(const WAD& wadFile);
+    static std::optional<std::vector<SwitchDefinition>> readSwitches(const WAD& wadFile);
+
 };
 
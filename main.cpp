@@ -1,13 +1,67 @@
 #include <print>
 #include <utility>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <string_view>
+#include <charconv>
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 #include <Creepy/Renderer.hpp>
+#include <Creepy/ShaderPermutations.hpp>
 #include <Creepy/WAD.hpp>
 #include <Creepy/Engine.hpp>
 #include <Creepy/Input.hpp>
+#include <Creepy/Frustum.hpp>
+#include <Creepy/SoftwareRenderer.hpp>
+#include <Creepy/BSP.hpp>
+#include <Creepy/BenchmarkMaps.hpp>
+
+static int renderHeadless(const char* outputPath);
+static int benchmarkSoftware();
+static int benchmarkVisPlanes(int gridSize);
+static int benchmarkTextures();
+static int benchmarkResidency(size_t budgetBytes);
+
+int main(int argc, char** argv){
+    for(int i{1}; i < argc; ++i){
+        if(std::string_view{argv[i]} == "--bench-cull"){
+            Frustum::benchmarkCulling(100000, 100);
+            return 0;
+        }
+
+        if(std::string_view{argv[i]} == "--bench-software"){
+            return benchmarkSoftware();
+        }
+
+        if(std::string_view{argv[i]} == "--bench-visplanes"){
+            int gridSize{MaxGridSize};
+            if(i + 1 < argc){
+                const std::string_view argument{argv[i + 1]};
+                std::from_chars(argument.data(), argument.data() + argument.size(), gridSize);
+            }
+            return benchmarkVisPlanes(std::clamp(gridSize, 1, MaxGridSize));
+        }
+
+        if(std::string_view{argv[i]} == "--bench-textures"){
+            return benchmarkTextures();
+        }
+
+        if(std::string_view{argv[i]} == "--bench-residency"){
+            // Budget in MiB, the default when missing or not a number
+            size_t budgetMegabytes{DefaultTextureBudget >> 20};
+            if(i + 1 < argc){
+                const std::string_view argument{argv[i + 1]};
+                std::from_chars(argument.data(), argument.data() + argument.size(), budgetMegabytes);
+            }
+            return benchmarkResidency(budgetMegabytes << 20);
+        }
+
+        if(std::string_view{argv[i]} == "--headless"){
+            return renderHeadless(i + 1 < argc ? argv[i + 1] : "./headless.ppm");
+        }
+    }
 
-int main(){
     int width{600}, height{600};
     if(glfwInit() != GLFW_TRUE){
         std::println("Failed Init");
@@ -27,9 +81,9 @@ int main(){
         std::println("Failed Init Glad");
     }
 
-    Renderer::initRenderer(width, height);
+    ShaderPermutations::init(window);
 
-    float lastTime{0.0f};
+    Renderer::initRenderer(width, height);
 
     auto wadFile = WAD::loadFromFile("./res/levels/doom1.wad");
 
@@ -37,22 +91,154 @@ int main(){
 
     Input::Init(window);
 
+    // Fixed 35 Hz tics whatever the refresh rate, frames in between draw a blend of the last two
+    // A long stall drop the time past MaxFrameSeconds instead of running all of it at once
+    constexpr double TicSeconds{1.0 / TicsPerSecond};
+    constexpr double MaxFrameSeconds{0.25};
+    double lastTime{glfwGetTime()};
+    double accumulator{};
+
     while(!glfwWindowShouldClose(window)){
-        float nowTime = glfwGetTime();
-        float deltaTime = nowTime - lastTime;
+        const double nowTime = glfwGetTime();
+        accumulator += std::min(nowTime - lastTime, MaxFrameSeconds);
         lastTime = nowTime;
 
         glfwPollEvents();
 
-        Engine::Update(deltaTime);
+        while(accumulator >= TicSeconds){
+            Engine::Update();
+            accumulator -= TicSeconds;
+        }
 
         Renderer::clearRenderer();
         
-        Engine::Render();
+        Engine::Render(static_cast<float>(accumulator / TicSeconds));
 
         glfwSwapBuffers(window);
     }
 
+    Engine::Shutdown();
+    ShaderPermutations::shutdown();
+
     glfwDestroyWindow(window);
     glfwTerminate();
-}
\ No newline at end of file
+}
+
+// Software frame without window or GL context, for machines without a GPU
+int renderHeadless(const char* outputPath) {
+    auto wadFile = WAD::loadFromFile("./res/levels/doom1.wad");
+    if(!wadFile){
+        return 1;
+    }
+
+    auto map = WAD::readMap("E1M1", wadFile.value());
+    auto glMap = WAD::readGLMap("GL_E1M1", wadFile.value());
+    if(!map || !glMap || glMap->subSectors.empty()){
+        std::println("Failed Load Map: E1M1");
+        return 1;
+    }
+
+    const Palette palette = WAD::readPalette(wadFile.value()).value_or(Palette::makeFallback());
+    const ColorMap colorMap = WAD::readColorMap(wadFile.value()).value_or(ColorMap::makeFallback());
+    const TextureCache textureCache = TextureCache::build(wadFile.value(), map.value());
+    SoftwareRenderer::init(map.value(), glMap.value(), palette, colorMap, textureCache, 320, 200);
+
+    // Stand at the middle of the first subsector, eye 41 units over its floor like the player
+    auto&& subSector = glMap->subSectors.front();
+    glm::vec2 center{};
+    int16_t floorHeight{};
+    for(uint16_t i{}; i < subSector.numSegments; ++i){
+        auto&& segment = glMap->segments.at(subSector.firstSegment + i);
+        center += BSP::getSegmentVertex(map.value(), glMap.value(), segment.startVertex);
+
+        if(segment.lineDef != NoLineDef){
+            auto&& line = map->lineDefs.at(segment.lineDef);
+            floorHeight = map->sectors.at(map->sideDefs.at(segment.side == 0 ? line.frontSideDef : line.backSideDef).sectorIndex).floor;
+        }
+    }
+    center /= static_cast<float>(std::max<uint16_t>(subSector.numSegments, 1));
+
+    SoftwareRenderer::render(glm::vec3{center.x, floorHeight + 41.0f, center.y}, glm::vec3{0.0f, 0.0f, 1.0f});
+
+    const auto& stats = SoftwareRenderer::getStats();
+    std::println("Segments: {} Columns: {} Spans: {} VisPlanes: {} | {:.2f} ms", 
+        stats.Segments, stats.Columns, stats.Spans, stats.VisPlanes, stats.Milliseconds);
+
+    return SoftwareRenderer::getFrame().writePPM(outputPath, palette) ? 0 : 1;
+}
+
+int benchmarkSoftware() {
+    auto wadFile = WAD::loadFromFile("./res/levels/doom1.wad");
+    if(!wadFile){
+        return 1;
+    }
+
+    auto map = WAD::readMap("E1M1", wadFile.value());
+    auto glMap = WAD::readGLMap("GL_E1M1", wadFile.value());
+    if(!map || !glMap){
+        std::println("Failed Load Map: E1M1");
+        return 1;
+    }
+
+    const Palette palette = WAD::readPalette(wadFile.value()).value_or(Palette::makeFallback());
+    const ColorMap colorMap = WAD::readColorMap(wadFile.value()).value_or(ColorMap::makeFallback());
+    const TextureCache textureCache = TextureCache::build(wadFile.value(), map.value());
+    SoftwareRenderer::benchmarkScaling(map.value(), glMap.value(), palette, colorMap, textureCache, 64);
+    return 0;
+}
+
+// No WAD needed, placeholder textures give every sector its own flats
+int benchmarkVisPlanes(int gridSize) {
+    const auto [map, glMap] = BenchmarkMaps::makeSectorGrid(gridSize);
+    std::println("Sector Grid: {}x{} Sectors: {} LineDefs: {} SubSectors: {}", gridSize, gridSize, map.sectors.size(), map.lineDefs.size(), glMap.subSectors.size());
+
+    SoftwareRenderer::benchmarkScaling(map, glMap, Palette::makeFallback(), ColorMap::makeFallback(), TextureCache{}, 64);
+    return 0;
+}
+
+int benchmarkTextures() {
+    auto wadFile = WAD::loadFromFile("./res/levels/doom1.wad");
+    if(!wadFile){
+        return 1;
+    }
+
+    TextureCache::benchmark(wadFile.value(), 10);
+    return 0;
+}
+
+// Every map of the WAD in order twice, the second pass show what the budget kept
+int benchmarkResidency(size_t budgetBytes) {
+    auto wadFile = WAD::loadFromFile("./res/levels/doom1.wad");
+    if(!wadFile){
+        return 1;
+    }
+
+    std::vector<std::string> mapNames;
+    for(int episode{1}; episode <= 4; ++episode){
+        for(int mission{1}; mission <= 9; ++mission){
+            mapNames.push_back(std::format("E{}M{}", episode, mission));
+        }
+    }
+    for(int mission{1}; mission <= 32; ++mission){
+        mapNames.push_back(std::format("MAP{:02}", mission));
+    }
+
+    std::vector<std::pair<std::string, Map>> maps;
+    for(auto&& mapName : mapNames){
+        if(auto map = WAD::readMap(mapName, wadFile.value())){
+            maps.emplace_back(mapName, std::move(map.value()));
+        }
+    }
+
+    TextureCache textureCache{};
+    textureCache.BudgetBytes = budgetBytes;
+
+    for(int pass{}; pass < 2; ++pass){
+        for(auto&& [mapName, map] : maps){
+            std::println("{}:", mapName);
+            textureCache.loadLevel(wadFile.value(), map);
+        }
+    }
+
+    return 0;
+}
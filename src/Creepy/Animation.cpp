@@ -0,0 +1,149 @@
+#include <print>
+#include <algorithm>
+#include <Creepy/Animation.hpp>
+#include <Creepy/TextureCache.hpp>
+#include <Creepy/WAD.hpp>
+
+// animdefs and alphSwitchList of vanilla, used when the WAD has no ANIMATED or SWITCHES
+constexpr AnimationDefinition VanillaAnimations[]{
+    {"NUKAGE3", "NUKAGE1", true}, {"FWATER4", "FWATER1", true}, {"SWATER4", "SWATER1", true},
+    {"LAVA4", "LAVA1", true}, {"BLOOD3", "BLOOD1", true}, {"RROCK08", "RROCK05", true},
+    {"SLIME04", "SLIME01", true}, {"SLIME08", "SLIME05", true}, {"SLIME12", "SLIME09", true},
+
+    {"BLODGR4", "BLODGR1", false}, {"SLADRIP3", "SLADRIP1", false}, {"BLODRIP4", "BLODRIP1", false},
+    {"FIREWALL", "FIREWALA", false}, {"GSTFONT3", "GSTFONT1", false}, {"FIRELAVA", "FIRELAV3", false},
+    {"FIREMAG3", "FIREMAG1", false}, {"FIREBLU2", "FIREBLU1", false}, {"ROCKRED3", "ROCKRED1", false},
+    {"BFALL4", "BFALL1", false}, {"SFALL4", "SFALL1", false}, {"WFALL4", "WFALL1", false},
+    {"DBRAIN4", "DBRAIN1", false}
+};
+
+constexpr SwitchDefinition VanillaSwitches[]{
+    {"SW1BRCOM", "SW2BRCOM", 1}, {"SW1BRN1", "SW2BRN1", 1}, {"SW1BRN2", "SW2BRN2", 1}, {"SW1BRNGN", "SW2BRNGN", 1},
+    {"SW1BROWN", "SW2BROWN", 1}, {"SW1COMM", "SW2COMM", 1}, {"SW1COMP", "SW2COMP", 1}, {"SW1DIRT", "SW2DIRT", 1},
+    {"SW1EXIT", "SW2EXIT", 1}, {"SW1GRAY", "SW2GRAY", 1}, {"SW1GRAY1", "SW2GRAY1", 1}, {"SW1METAL", "SW2METAL", 1},
+    {"SW1PIPE", "SW2PIPE", 1}, {"SW1SLAD", "SW2SLAD", 1}, {"SW1STARG", "SW2STARG", 1}, {"SW1STON1", "SW2STON1", 1},
+    {"SW1STON2", "SW2STON2", 1}, {"SW1STONE", "SW2STONE", 1}, {"SW1STRTN", "SW2STRTN", 1},
+
+    {"SW1BLUE", "SW2BLUE", 2}, {"SW1CMT", "SW2CMT", 2}, {"SW1COOL", "SW2COOL", 2}, {"SW1GSTON", "SW2GSTON", 2},
+    {"SW1HOT", "SW2HOT", 2}, {"SW1LION", "SW2LION", 2}, {"SW1SATYR", "SW2SATYR", 2}, {"SW1SKIN", "SW2SKIN", 2},
+    {"SW1VINE", "SW2VINE", 2}, {"SW1WOOD", "SW2WOOD", 2},
+
+    {"SW1PANEL", "SW2PANEL", 3}, {"SW1ROCK", "SW2ROCK", 3}, {"SW1MET2", "SW2MET2", 3}, {"SW1WDMET", "SW2WDMET", 3},
+    {"SW1BRIK", "SW2BRIK", 3}, {"SW1MOD1", "SW2MOD1", 3}, {"SW1ZIM", "SW2ZIM", 3}, {"SW1STON6", "SW2STON6", 3},
+    {"SW1TEK", "SW2TEK", 3}, {"SW1MARB", "SW2MARB", 3}, {"SW1SKULL", "SW2SKULL", 3}
+};
+
+static std::vector<Name8> findFlatNames(const WAD& wadFile);
+static void appendFrames(TextureAnimations& animations, const AnimationDefinition& definition, std::span<const Name8> names);
+
+TextureAnimations TextureAnimations::load(const WAD& wadFile, std::span<const TextureDefinition> definitions) {
+    TextureAnimations animations{};
+
+    // First definition of a name win like the cache, frames are the ones between in this order
+    std::vector<Name8> wallNames;
+    std::unordered_set<Name8> seen;
+    for(auto&& definition : definitions){
+        if(seen.insert(definition.Name).second){
+            wallNames.push_back(definition.Name);
+        }
+    }
+
+    const std::vector<Name8> flatNames = findFlatNames(wadFile);
+
+    const auto animationLump = WAD::readAnimations(wadFile);
+    const std::span<const AnimationDefinition> animationDefinitions = animationLump ? std::span<const AnimationDefinition>{animationLump.value()} : std::span<const AnimationDefinition>{VanillaAnimations};
+    for(auto&& definition : animationDefinitions){
+        appendFrames(animations, definition, definition.IsFlat ? flatNames : wallNames);
+    }
+
+    const auto switchLump = WAD::readSwitches(wadFile);
+    const std::span<const SwitchDefinition> switches = switchLump ? std::span<const SwitchDefinition>{switchLump.value()} : std::span<const SwitchDefinition>{VanillaSwitches};
+    animations.Switches.assign(switches.begin(), switches.end());
+
+    return animations;
+}
+
+void TextureAnimations::addFrames(std::unordered_set<Name8>& wallNames, std::unordered_set<Name8>& flatNames) const {
+    for(auto&& animation : Animations){
+        auto& names = animation.IsFlat ? flatNames : wallNames;
+        if(std::ranges::any_of(animation.Frames, [&names](Name8 frame){ return names.contains(frame); })){
+            names.insert(animation.Frames.begin(), animation.Frames.end());
+        }
+    }
+
+    for(auto&& switchDefinition : Switches){
+        if(wallNames.contains(switchDefinition.Off) || wallNames.contains(switchDefinition.On)){
+            wallNames.insert(switchDefinition.Off);
+            wallNames.insert(switchDefinition.On);
+        }
+    }
+}
+
+void TextureAnimations::getFrames(const TextureCache& textureCache, uint32_t tic, std::vector<int>& wallFrames, std::vector<int>& flatFrames) const {
+    for(auto [frames, size] : {std::pair{&wallFrames, textureCache.Textures.size()}, std::pair{&flatFrames, textureCache.Flats.size()}}){
+        frames->resize(size);
+        for(int i{}; auto& frame : *frames){
+            frame = i++;
+        }
+    }
+
+    // Frame i show frame i + tic / speed like P_UpdateSpecials, every frame has to be resident
+    std::vector<int> indices;
+    for(auto&& animation : Animations){
+        indices.clear();
+        for(auto frame : animation.Frames){
+            const int index = animation.IsFlat ? textureCache.findFlat(frame) : textureCache.find(frame);
+            if(index < 0){
+                break;
+            }
+            indices.push_back(index);
+        }
+
+        if(indices.size() != animation.Frames.size()){
+            continue;
+        }
+
+        auto& frames = animation.IsFlat ? flatFrames : wallFrames;
+        const size_t step = tic / static_cast<uint32_t>(animation.Tics);
+        for(size_t i{}; i < indices.size(); ++i){
+            frames[indices[i]] = indices[(i + step) % indices.size()];
+        }
+    }
+}
+
+// Directory order like vanilla flat numbers, the first lump of a name keep its place
+std::vector<Name8> findFlatNames(const WAD& wadFile) {
+    std::vector<Name8> names;
+    std::unordered_set<Name8> seen;
+    bool isInFlats{false};
+
+    for(auto&& lump : wadFile.lumps){
+        if(lump.name == "F_START" || lump.name == "FF_START"){
+            isInFlats = true;
+        }
+        else if(lump.name == "F_END" || lump.name == "FF_END"){
+            isInFlats = false;
+        }
+        else if(isInFlats && lump.size > 0 && seen.insert(lump.name).second){
+            names.push_back(lump.name);
+        }
+    }
+
+    return names;
+}
+
+// Missing ends or a last before the first is skipped like vanilla does for the other game modes
+void appendFrames(TextureAnimations& animations, const AnimationDefinition& definition, std::span<const Name8> names) {
+    const auto first = std::ranges::find(names, definition.First);
+    const auto last = std::ranges::find(names, definition.Last);
+    if(first == names.end() || last == names.end() || last < first){
+        return;
+    }
+
+    if(last == first){
+        std::println("Animation With One Frame: {}", definition.First.toString());
+        return;
+    }
+
+    animations.Animations.push_back(TextureAnimation{std::vector<Name8>{first, last + 1}, definition.IsFlat, definition.Tics});
+}
@@ -0,0 +1,46 @@
+#include <Creepy/BSP.hpp>
+
+bool BSP::isPointOnBackSide(const GLNode& node, glm::vec2 point) {
+    const glm::vec2 delta = point - node.partition;
+    return delta.y * node.direction.x >= node.direction.y * delta.x;
+}
+
+uint16_t BSP::findSubSector(const GLMap& glMap, glm::vec2 point) {
+    if(glMap.nodes.empty()){
+        return 0;
+    }
+
+    uint16_t child = static_cast<uint16_t>(glMap.nodes.size() - 1);
+
+    while(!(child & SubSectorFlag)){
+        const auto& node = glMap.nodes[child];
+        child = node.children[isPointOnBackSide(node, point) ? 1 : 0];
+    }
+
+    return static_cast<uint16_t>(child & ~SubSectorFlag);
+}
+
+uint16_t BSP::findSector(const Map& map, const GLMap& glMap, glm::vec2 point) {
+    if(glMap.subSectors.empty()){
+        return 0;
+    }
+
+    auto&& subSector = glMap.subSectors.at(findSubSector(glMap, point));
+    for(uint16_t i{}; i < subSector.numSegments; ++i){
+        auto&& segment = glMap.segments.at(subSector.firstSegment + i);
+        if(segment.lineDef != NoLineDef){
+            auto&& line = map.lineDefs.at(segment.lineDef);
+            return map.sideDefs.at(segment.side == 0 ? line.frontSideDef : line.backSideDef).sectorIndex;
+        }
+    }
+
+    return 0;
+}
+
+glm::vec2 BSP::getSegmentVertex(const Map& map, const GLMap& glMap, uint16_t vertexIndex) {
+    if(vertexIndex & GLVertexFlag){
+        return glMap.vertices.at(vertexIndex & ~GLVertexFlag);
+    }
+
+    return map.vertices.at(vertexIndex);
+}
@@ -0,0 +1,128 @@
+#include <utility>
+#include <Creepy/BenchmarkMaps.hpp>
+
+constexpr float GridCellSize{64.0f};        // Map units, sector side
+constexpr int GridStepHeights{8};           // Floors and ceilings differ by up to 7 units
+constexpr int GridCeiling{160};
+
+static uint16_t addGridNode(GLMap& glMap, int gridSize, glm::ivec2 first, glm::ivec2 last);
+
+std::pair<Map, GLMap> BenchmarkMaps::makeSectorGrid(int gridSize) {
+    const int numVertices = gridSize + 1;
+    Map map{};
+    GLMap glMap{};
+
+    for(int y{}; y < numVertices; ++y){
+        for(int x{}; x < numVertices; ++x){
+            map.vertices.push_back(glm::vec2{static_cast<float>(x), static_cast<float>(y)} * GridCellSize);
+        }
+    }
+    map.min = glMap.min = glm::vec2{0.0f};
+    map.max = glMap.max = glm::vec2{static_cast<float>(gridSize) * GridCellSize};
+
+    for(int y{}; y < gridSize; ++y){
+        for(int x{}; x < gridSize; ++x){
+            // Steps of a few units hide little, light alone give each sector its own planes
+            const uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+            auto& sector = map.sectors.emplace_back();
+            sector.floor = static_cast<int16_t>(hash % GridStepHeights);
+            sector.ceiling = static_cast<int16_t>(GridCeiling + (hash >> 8) % GridStepHeights);
+            sector.lightLevel = static_cast<int16_t>(96 + (hash >> 16) % 160);
+        }
+    }
+
+    const auto getVertex = [numVertices](int x, int y){ return static_cast<uint16_t>(y * numVertices + x); };
+    const auto getSector = [gridSize](int x, int y){ return x >= 0 && y >= 0 && x < gridSize && y < gridSize ? y * gridSize + x : -1; };
+
+    // Front sector on the right like vanilla, a border line is turned so its only sector is the front
+    const auto addLine = [&map](uint16_t start, uint16_t end, int frontSector, int backSector){
+        if(frontSector < 0){
+            std::swap(start, end);
+            std::swap(frontSector, backSector);
+        }
+
+        LineDef line{start, end, 0, static_cast<uint16_t>(map.sideDefs.size()), 0xFFFF};
+        SideDef& front = map.sideDefs.emplace_back();
+        front.sectorIndex = static_cast<uint16_t>(frontSector);
+
+        if(backSector < 0){
+            line.flags = std::to_underlying(LineDefFormat::PLAYER);
+        }
+        else {
+            line.flags = std::to_underlying(LineDefFormat::TWO_SIDE);
+            line.backSideDef = static_cast<uint16_t>(map.sideDefs.size());
+            SideDef& back = map.sideDefs.emplace_back();
+            back.sectorIndex = static_cast<uint16_t>(backSector);
+        }
+
+        map.lineDefs.push_back(line);
+        return static_cast<uint16_t>(map.lineDefs.size() - 1);
+    };
+
+    // Line along +x at (x, y) has the cell under it on the right, line along +y has the cell on its right
+    std::vector<uint16_t> horizontalLines(static_cast<size_t>(gridSize) * numVertices), verticalLines(static_cast<size_t>(gridSize) * numVertices);
+    for(int y{}; y < numVertices; ++y){
+        for(int x{}; x < gridSize; ++x){
+            horizontalLines[y * gridSize + x] = addLine(getVertex(x, y), getVertex(x + 1, y), getSector(x, y - 1), getSector(x, y));
+        }
+    }
+    for(int x{}; x < numVertices; ++x){
+        for(int y{}; y < gridSize; ++y){
+            verticalLines[x * gridSize + y] = addLine(getVertex(x, y), getVertex(x, y + 1), getSector(x, y), getSector(x - 1, y));
+        }
+    }
+
+    // One subsector per cell, segments clockwise
+    const auto addSegment = [&map, &glMap](uint16_t start, uint16_t end, uint16_t lineIndex){
+        glMap.segments.push_back(GLSegment{start, end, lineIndex, static_cast<uint16_t>(map.lineDefs[lineIndex].startIndex == start ? 0 : 1)});
+    };
+    for(int y{}; y < gridSize; ++y){
+        for(int x{}; x < gridSize; ++x){
+            glMap.subSectors.push_back(GLSubSector{4, static_cast<uint16_t>(glMap.segments.size())});
+            addSegment(getVertex(x, y), getVertex(x, y + 1), verticalLines[x * gridSize + y]);
+            addSegment(getVertex(x, y + 1), getVertex(x + 1, y + 1), horizontalLines[(y + 1) * gridSize + x]);
+            addSegment(getVertex(x + 1, y + 1), getVertex(x + 1, y), verticalLines[(x + 1) * gridSize + y]);
+            addSegment(getVertex(x + 1, y), getVertex(x, y), horizontalLines[y * gridSize + x]);
+        }
+    }
+
+    addGridNode(glMap, gridSize, glm::ivec2{0}, glm::ivec2{gridSize - 1});
+
+    return {std::move(map), std::move(glMap)};
+}
+
+// Halve the longer side of the cell range, children before parents so the root end up last
+uint16_t addGridNode(GLMap& glMap, int gridSize, glm::ivec2 first, glm::ivec2 last) {
+    if(first == last){
+        return static_cast<uint16_t>((first.y * gridSize + first.x) | SubSectorFlag);
+    }
+
+    const auto getBox = [](glm::ivec2 boxFirst, glm::ivec2 boxLast){
+        return BoundingBox{glm::vec2{boxFirst} * GridCellSize, glm::vec2{boxLast + 1} * GridCellSize};
+    };
+
+    GLNode node{};
+    if(last.x - first.x >= last.y - first.y){
+        // Partition along +y, right (front) is the high x half
+        const int middle = (first.x + last.x + 1) / 2;
+        node.partition = glm::vec2{static_cast<float>(middle) * GridCellSize, 0.0f};
+        node.direction = glm::vec2{0.0f, 1.0f};
+        node.boxes[0] = getBox({middle, first.y}, last);
+        node.boxes[1] = getBox(first, {middle - 1, last.y});
+        node.children[0] = addGridNode(glMap, gridSize, {middle, first.y}, last);
+        node.children[1] = addGridNode(glMap, gridSize, first, {middle - 1, last.y});
+    }
+    else {
+        // Partition along +x, right (front) is the low y half
+        const int middle = (first.y + last.y + 1) / 2;
+        node.partition = glm::vec2{0.0f, static_cast<float>(middle) * GridCellSize};
+        node.direction = glm::vec2{1.0f, 0.0f};
+        node.boxes[0] = getBox(first, {last.x, middle - 1});
+        node.boxes[1] = getBox({first.x, middle}, last);
+        node.children[0] = addGridNode(glMap, gridSize, first, {last.x, middle - 1});
+        node.children[1] = addGridNode(glMap, gridSize, {first.x, middle}, last);
+    }
+
+    glMap.nodes.push_back(node);
+    return static_cast<uint16_t>(glMap.nodes.size() - 1);
+}
@@ -14,4 +14,14 @@ void Camera::UpdateDirection(Camera& camera){
 
     camera.Up = glm::normalize(glm::cross(camera.Forward, camera.Right));
     
-}
\ No newline at end of file
+}
+
+Camera Camera::Interpolate(const Camera& previous, const Camera& current, float alpha){
+    Camera camera{};
+    camera.Position = glm::mix(previous.Position, current.Position, alpha);
+    camera.Pitch = glm::mix(previous.Pitch, current.Pitch, alpha);
+    camera.Yaw = glm::mix(previous.Yaw, current.Yaw, alpha);
+    UpdateDirection(camera);
+
+    return camera;
+}
@@ -0,0 +1,153 @@
+#include <cmath>
+#include <utility>
+#include <Creepy/Collision.hpp>
+
+constexpr int MaxSlideAttempts{3};      // Into a corner the second wall stop what the first let slide
+constexpr float ContactEpsilon{0.01f};
+
+static bool isLineInCell(glm::vec2 start, glm::vec2 end, glm::vec2 cellMin, glm::vec2 cellMax);
+static glm::vec2 findClosestPoint(glm::vec2 start, glm::vec2 end, glm::vec2 point);
+
+BlockMap Collision::buildBlockMap(const Map& map) {
+    BlockMap blockMap{};
+    if(map.vertices.empty()){
+        return blockMap;
+    }
+
+    // Origin 8 units outside the map like BSP and ZDBSP
+    blockMap.origin = glm::ivec2{glm::floor(map.min)} - 8;
+    blockMap.columns = static_cast<int>(map.max.x - static_cast<float>(blockMap.origin.x)) / BlockSize + 1;
+    blockMap.rows = static_cast<int>(map.max.y - static_cast<float>(blockMap.origin.y)) / BlockSize + 1;
+
+    std::vector<std::vector<uint16_t>> cells(static_cast<size_t>(blockMap.columns) * static_cast<size_t>(blockMap.rows));
+
+    for(size_t lineIndex{}; lineIndex < map.lineDefs.size(); ++lineIndex){
+        auto&& line = map.lineDefs.at(lineIndex);
+        const glm::vec2 start = map.vertices.at(line.startIndex) - glm::vec2{blockMap.origin};
+        const glm::vec2 end = map.vertices.at(line.endIndex) - glm::vec2{blockMap.origin};
+
+        // Cells of the bounding box, a diagonal line skip the ones it pass by
+        const glm::ivec2 first = glm::clamp(glm::ivec2{glm::min(start, end)} / BlockSize, glm::ivec2{0}, glm::ivec2{blockMap.columns - 1, blockMap.rows - 1});
+        const glm::ivec2 last = glm::clamp(glm::ivec2{glm::max(start, end)} / BlockSize, glm::ivec2{0}, glm::ivec2{blockMap.columns - 1, blockMap.rows - 1});
+
+        for(int row{first.y}; row <= last.y; ++row){
+            for(int column{first.x}; column <= last.x; ++column){
+                const glm::vec2 cellMin{static_cast<float>(column * BlockSize), static_cast<float>(row * BlockSize)};
+                if(isLineInCell(start, end, cellMin, cellMin + static_cast<float>(BlockSize))){
+                    cells[static_cast<size_t>(row) * static_cast<size_t>(blockMap.columns) + static_cast<size_t>(column)].push_back(static_cast<uint16_t>(lineIndex));
+                }
+            }
+        }
+    }
+
+    blockMap.offsets.reserve(cells.size() + 1);
+    blockMap.offsets.push_back(0);
+    for(auto&& cell : cells){
+        blockMap.lines.insert(blockMap.lines.end(), cell.begin(), cell.end());
+        blockMap.offsets.push_back(static_cast<uint32_t>(blockMap.lines.size()));
+    }
+
+    return blockMap;
+}
+
+glm::vec2 Collision::slideMove(const Map& map, glm::vec2 position, float feetHeight, glm::vec2 move) {
+    // Steps no longer than the radius, a fast move can not jump over a line
+    const int numSteps = std::max(static_cast<int>(std::ceil(glm::length(move) / PlayerRadius)), 1);
+
+    for(int step{}; step < numSteps; ++step){
+        glm::vec2 destination = position + move / static_cast<float>(numSteps);
+
+        for(int attempt{}; attempt < MaxSlideAttempts; ++attempt){
+            // Deepest line the circle cut at destination while heading into it
+            float nearestDistance{PlayerRadius - ContactEpsilon};
+            glm::vec2 normal{};
+            bool isBlocked{false};
+
+            forEachLine(map.blockMap, destination - PlayerRadius, destination + PlayerRadius, [&](uint16_t lineIndex){
+                auto&& line = map.lineDefs[lineIndex];
+                const glm::vec2 start = map.vertices[line.startIndex];
+                const glm::vec2 end = map.vertices[line.endIndex];
+
+                const glm::vec2 away = destination - findClosestPoint(start, end, destination);
+                const float distance = glm::length(away);
+                if(distance >= nearestDistance || !isBlocking(map, line, feetHeight)){
+                    return;
+                }
+
+                // Away from the line, on it take the side the move come from
+                glm::vec2 lineNormal{};
+                if(distance > ContactEpsilon){
+                    lineNormal = away / distance;
+                }
+                else {
+                    const glm::vec2 direction = end - start;
+                    lineNormal = glm::normalize(glm::vec2{-direction.y, direction.x});
+                    if(glm::dot(position - start, lineNormal) < 0.0f){
+                        lineNormal = -lineNormal;
+                    }
+                }
+
+                // Already touching is fine as long as the move do not go deeper
+                if(glm::dot(destination - position, lineNormal) >= 0.0f){
+                    return;
+                }
+
+                nearestDistance = distance;
+                normal = lineNormal;
+                isBlocked = true;
+            });
+
+            if(!isBlocked){
+                position = destination;
+                break;
+            }
+
+            // Push back to touching, what is left of the move run along the wall
+            destination += normal * (PlayerRadius - nearestDistance);
+        }
+    }
+
+    return position;
+}
+
+bool Collision::isBlocking(const Map& map, const LineDef& line, float feetHeight) {
+    // PLAYER is the impassable flag, blocks monsters too
+    if(!(line.flags & std::to_underlying(LineDefFormat::TWO_SIDE)) || (line.flags & std::to_underlying(LineDefFormat::PLAYER))){
+        return true;
+    }
+
+    if(line.frontSideDef >= map.sideDefs.size() || line.backSideDef >= map.sideDefs.size()){
+        return true;
+    }
+
+    auto&& frontSector = map.sectors.at(map.sideDefs.at(line.frontSideDef).sectorIndex);
+    auto&& backSector = map.sectors.at(map.sideDefs.at(line.backSideDef).sectorIndex);
+
+    // Opening between the two sectors, too short to fit or a step too high
+    const float openingBottom = static_cast<float>(std::max(frontSector.floor, backSector.floor));
+    const float openingTop = static_cast<float>(std::min(frontSector.ceiling, backSector.ceiling));
+
+    return openingTop - openingBottom < PlayerHeight || openingBottom - feetHeight > MaxStepHeight;
+}
+
+// Corners not all on one side, the caller already know the bounding boxes overlap
+bool isLineInCell(glm::vec2 start, glm::vec2 end, glm::vec2 cellMin, glm::vec2 cellMax) {
+    const glm::vec2 direction = end - start;
+    const auto side = [&](glm::vec2 corner){
+        const float cross = direction.x * (corner.y - start.y) - direction.y * (corner.x - start.x);
+        return cross > 0.0f ? 1 : (cross < 0.0f ? -1 : 0);
+    };
+
+    const int sides[]{side(cellMin), side({cellMax.x, cellMin.y}), side(cellMax), side({cellMin.x, cellMax.y})};
+    return !std::ranges::all_of(sides, [](int s){ return s > 0; }) && !std::ranges::all_of(sides, [](int s){ return s < 0; });
+}
+
+glm::vec2 findClosestPoint(glm::vec2 start, glm::vec2 end, glm::vec2 point) {
+    const glm::vec2 direction = end - start;
+    const float lengthSquared = glm::dot(direction, direction);
+    if(lengthSquared <= 0.0f){
+        return start;
+    }
+
+    return start + direction * std::clamp(glm::dot(point - start, direction) / lengthSquared, 0.0f, 1.0f);
+}
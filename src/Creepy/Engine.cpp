@@ -8,35 +8,100 @@
 #include <Creepy/Renderer.hpp>
 #include <Creepy/Input.hpp>
 #include <Creepy/Mesh.hpp>
+#include <Creepy/Visibility.hpp>
+#include <Creepy/LevelCache.hpp>
+#include <Creepy/OcclusionCulling.hpp>
+#include <Creepy/SoftwareRenderer.hpp>
+#include <Creepy/SoftwareKernels.hpp>
+#include <Creepy/TileRasterizer.hpp>
+#include <Creepy/Texture.hpp>
+#include <Creepy/TextureCache.hpp>
+#include <Creepy/Sprites.hpp>
+#include <Creepy/BSP.hpp>
+#include <Creepy/Collision.hpp>
 
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 
 constexpr float fov{60.0f};
 Camera s_camera{};
+Camera s_previousCamera{};      // At the start of the last tic, Render blend the two
 glm::vec2 s_lastMousePosition{};
 
+constexpr float TicSeconds{1.0f / TicsPerSecond};
 constexpr float playerSpeed{5.0f};
 constexpr float mouseSensitivity{0.5f};
 
-struct WallNode{
-    glm::mat4 Model;
-    glm::vec4 Color;
-    const Sector* SectorPtr;
-};
-
 struct FlatNode{
     glm::mat4 Model;
     glm::vec4 Color;
     const Sector* SectorPtr;
 };
 
-std::vector<WallNode> s_wallNodeLists;
 std::vector<FlatNode> s_flatNodeLists;
 
+Map s_map{};
+GLMap s_glMap{};
+LevelCache s_levelCache{};
+glm::mat4 s_projectionMatrix{1.0f};
+
+// All walls baked in one mesh sorted by texture size class, one draw per class
+// Inside a class each LineDef own a contiguous index range
+Mesh s_worldMesh{};
+std::vector<std::vector<MeshRange>> s_lineDefRanges;    // [class][lineDef]
+std::vector<std::vector<MeshRange>> s_visibleRanges;    // [class]
+std::vector<uint32_t> s_unoccludedLineDefs;
+
 float modelAngle{0.0f};
 
+// Player walk on the floors and slide along walls, C toggle no clip flying where Space and Z move up and down
+bool s_isNoClip{false};
+bool s_wasNoClipKeyDown{false};
+
+// B toggle the software renderer, P dump its frame or print tile rasterizer stats
+bool s_isSoftwareRendering{false};
+bool s_wasSoftwareKeyDown{false};
+bool s_wasDumpKeyDown{false};
+std::vector<uint8_t> s_softwarePixels;
+
+// R toggle the CPU tile rasterizer, it draw the same world mesh from these copies
+bool s_isTileRasterizing{false};
+bool s_wasRasterKeyDown{false};
+std::vector<Vertex> s_worldVertices;
+std::vector<uint32_t> s_worldIndices;
+
+// T toggle palette shading of the wall textures
+ShaderFeature s_worldShaderFeatures{ShaderFeature::LIGHT_DIMINISHING};
+bool s_wasPaletteKeyDown{false};
+TextureCache s_textureCache{};
+TextureAtlas s_textureAtlas{};      // Last array is the placeholder for missing textures
+
+// Animations step on tics, the remap tables are only rewritten when a frame change
+uint32_t s_levelTic{};
+std::vector<int> s_wallFrames, s_flatFrames;
+
+// THINGS as billboards, sorted by subsector so the visible ones are a few ranges of one buffer
+SpriteSet s_sprites{};
+std::vector<SpriteInstance> s_spriteInstances;
+std::vector<SpriteRange> s_subSectorSprites;       // [subSector]
+std::vector<SpriteRange> s_visibleSprites;
+
+// Where a wall quad sample its texture, in map units
+struct QuadTexture{
+    int SizeClass{};
+    float Slot{};
+    float Height{};
+    float OffsetX{}, Top{};
+};
+
 static glm::mat4 verticesToModel(glm::vec3 point0, glm::vec3 point1, glm::vec3 point2, glm::vec3 point3);
+static void appendQuad(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const glm::mat4& model, const glm::vec4& color, int16_t lightLevel, const QuadTexture& texture);
+static QuadTexture getWallTexture(Name8 name, const SideDef& sideDef);
+static TextureArray makePlaceholderTexture();
+static void updateAnimations(uint32_t tic);
+static void groupSpritesBySubSector();
+static void walkPlayer(glm::vec3 move);
+static glm::vec4 getSectorColor(uint16_t sectorIndex, const Sector& sector);
 
 void Engine::Init(const WAD& wadFile, std::string_view mapName) {
     s_camera.Position = glm::vec3{0.0f, 0.0f, -30.0f};
@@ -44,34 +109,80 @@ void Engine::Init(const WAD& wadFile, std::string_view mapName) {
     s_camera.Pitch = 0.0f;
     s_camera.Yaw = 0.0f;
 
-    auto mapFile = WAD::readMap(mapName, wadFile).value();
+    s_map = WAD::readMap(mapName, wadFile).value();
 
     std::string glMapName{std::format("GL_{}", mapName)};
-    auto glMapFile = WAD::readGLMap(glMapName, wadFile).value();
+    s_glMap = WAD::readGLMap(glMapName, wadFile).value();
+
+    // Walk from the player 1 start, fly from the old spot when the map has none
+    const auto playerStart = std::ranges::find(s_map.things, uint16_t{1}, &Thing::type);
+    s_isNoClip = playerStart == s_map.things.end();
+    if(!s_isNoClip){
+        s_camera.Yaw = glm::radians(90.0f - static_cast<float>(playerStart->angle));
+        s_camera.Position = glm::vec3{playerStart->x, 0.0f, playerStart->y} / MapScaleFactor;
+        walkPlayer(glm::vec3{0.0f});
+    }
     
-    Renderer::setProjectionMatrix(glm::perspectiveLH(glm::radians(fov), 
-        static_cast<float>(Renderer::getSize().x) / static_cast<float>(Renderer::getSize().y), 0.001f, 100.0f));
+    s_projectionMatrix = glm::perspectiveLH(glm::radians(fov), 
+        static_cast<float>(Renderer::getSize().x) / static_cast<float>(Renderer::getSize().y), 0.001f, 100.0f);
+    Renderer::setProjectionMatrix(s_projectionMatrix);
 
-    s_wallNodeLists.reserve(mapFile.lineDefs.size());
+    // Compiled in background, generic variant is used until it is ready
+    Renderer::setShaderFeatures(s_worldShaderFeatures);
 
-    for(auto&& subSec : glMapFile.subSectors){
+    for(auto&& subSec : s_glMap.subSectors){
         const auto numVertex = subSec.numSegments;
         std::vector<Vertex> vertices;
         vertices.reserve(numVertex);
         // (1 << 15)
         for(uint16_t i{}; i < numVertex; ++i){
-            auto&& segment = glMapFile.segments.at(i + subSec.firstSegment);
+            auto&& segment = s_glMap.segments.at(i + subSec.firstSegment);
 
         }
     }
+
+    // Shareware and PWAD without palette lumps still get a grey image
+    const Palette palette = WAD::readPalette(wadFile).value_or(Palette::makeFallback());
+    const ColorMap colorMap = WAD::readColorMap(wadFile).value_or(ColorMap::makeFallback());
+
+    // Level cache hand over the mips before the atlas upload them
+    s_textureCache.loadLevel(wadFile, s_map);
+    s_levelCache = LevelCache::loadOrBuild(wadFile, mapName, s_map, s_textureCache, palette);
+    s_textureAtlas.release();
+    s_textureAtlas = TextureAtlas::build(s_textureCache);
+    s_textureAtlas.Arrays.push_back(makePlaceholderTexture());
+    Renderer::setTextureRemap(s_textureAtlas.SlotLayers);
+    TileRasterizer::setTextureRemap(s_textureAtlas.SlotLayers);
+
+    const size_t numSizeClasses = s_textureAtlas.Arrays.size();
+    s_lineDefRanges.assign(numSizeClasses, std::vector<MeshRange>(s_map.lineDefs.size()));
+    s_visibleRanges.resize(numSizeClasses);
+
+    // Indices per class first, joined after so a class is one contiguous block
+    std::vector<Vertex> worldVertices;
+    std::vector<std::vector<uint32_t>> classIndices(numSizeClasses);
+    worldVertices.reserve(s_map.lineDefs.size() * 8);
     
-    for(auto&& line : mapFile.lineDefs){
+    for(size_t lineIndex{}; lineIndex < s_map.lineDefs.size(); ++lineIndex){
+        auto&& line = s_map.lineDefs.at(lineIndex);
+        for(size_t sizeClass{}; sizeClass < numSizeClasses; ++sizeClass){
+            s_lineDefRanges[sizeClass][lineIndex].FirstIndex = static_cast<uint32_t>(classIndices[sizeClass].size());
+        }
+
+        auto&& sideDef = s_map.sideDefs.at(line.frontSideDef);
+        const uint16_t frontSectorIndex = sideDef.sectorIndex;
+        const glm::vec4 color = getSectorColor(frontSectorIndex, s_map.sectors.at(frontSectorIndex));
+        const int16_t lightLevel = s_map.sectors.at(frontSectorIndex).lightLevel;
+
+        const bool isUpperUnpegged = line.flags & std::to_underlying(LineDefFormat::UPPER_UNPEGGED);
+        const bool isLowerUnpegged = line.flags & std::to_underlying(LineDefFormat::LOWER_UNPEGGED);
+
         if(line.flags & std::to_underlying(LineDefFormat::TWO_SIDE)){
-            const auto start = mapFile.vertices.at(line.startIndex);
-            const auto end = mapFile.vertices.at(line.endIndex);
+            const auto start = s_map.vertices.at(line.startIndex);
+            const auto end = s_map.vertices.at(line.endIndex);
 
-            auto&& frontSector = mapFile.sectors.at(mapFile.sideDefs.at(line.frontSideDef).sectorIndex);
-            auto&& backSector = mapFile.sectors.at(mapFile.sideDefs.at(line.backSideDef).sectorIndex);
+            auto&& frontSector = s_map.sectors.at(frontSectorIndex);
+            auto&& backSector = s_map.sectors.at(s_map.sideDefs.at(line.backSideDef).sectorIndex);
 
             {   // Floor Node
                 const glm::vec3 floor_0{start.x, static_cast<float>(frontSector.floor), start.y};
@@ -79,9 +190,10 @@ void Engine::Init(const WAD& wadFile, std::string_view mapName) {
                 const glm::vec3 floor_2{end.x, static_cast<float>(backSector.floor), end.y};
                 const glm::vec3 floor_3{start.x, static_cast<float>(backSector.floor), start.y};
 
-                s_wallNodeLists.push_back({verticesToModel(floor_0, floor_1, floor_2, floor_3), 
-                    {1.0f, 1.0f, 1.0f, 1.0f}, 
-                    &mapFile.sectors.at(mapFile.sideDefs.at(line.frontSideDef).sectorIndex)});
+                // Lower texture start at the back floor, unpegged hang from the front ceiling
+                QuadTexture texture = getWallTexture(sideDef.lowerTexture, sideDef);
+                texture.Top += isLowerUnpegged ? frontSector.ceiling : backSector.floor;
+                appendQuad(worldVertices, classIndices[texture.SizeClass], verticesToModel(floor_0, floor_1, floor_2, floor_3), color, lightLevel, texture);
             }
 
             {   // Ceiling Node
@@ -90,63 +202,130 @@ void Engine::Init(const WAD& wadFile, std::string_view mapName) {
                 const glm::vec3 ceiling_2{end.x, static_cast<float>(backSector.ceiling), end.y};
                 const glm::vec3 ceiling_3{start.x, static_cast<float>(backSector.ceiling), start.y};
 
-                s_wallNodeLists.push_back({verticesToModel(ceiling_0, ceiling_1, ceiling_2, ceiling_3), 
-                    {1.0f, 1.0f, 1.0f, 1.0f}, 
-                    &mapFile.sectors.at(mapFile.sideDefs.at(line.frontSideDef).sectorIndex)});
+                // Upper texture bottom sit on the back ceiling, unpegged start at the front ceiling
+                QuadTexture texture = getWallTexture(sideDef.upperTexture, sideDef);
+                texture.Top += isUpperUnpegged ? frontSector.ceiling : backSector.ceiling + texture.Height;
+                appendQuad(worldVertices, classIndices[texture.SizeClass], verticesToModel(ceiling_0, ceiling_1, ceiling_2, ceiling_3), color, lightLevel, texture);
             }
         }
         else {
-            constexpr float scaleFactor{100.0f};
-            const auto start = mapFile.vertices.at(line.startIndex) / scaleFactor;
-            const auto end = mapFile.vertices.at(line.endIndex) / scaleFactor;
+            const auto start = s_map.vertices.at(line.startIndex) / MapScaleFactor;
+            const auto end = s_map.vertices.at(line.endIndex) / MapScaleFactor;
 
-            auto&& frontSector = mapFile.sectors.at(mapFile.sideDefs.at(line.frontSideDef).sectorIndex);
+            auto&& frontSector = s_map.sectors.at(frontSectorIndex);
 
-            const float secFloor = static_cast<float>(frontSector.floor) / scaleFactor;
-            const float secCeiling = static_cast<float>(frontSector.ceiling) / scaleFactor;
+            const float secFloor = static_cast<float>(frontSector.floor) / MapScaleFactor;
+            const float secCeiling = static_cast<float>(frontSector.ceiling) / MapScaleFactor;
             
             const float x = end.x - start.x;
             const float y = end.y - start.y;
             const float length = std::sqrt(x * x + y * y);
             const float height = secCeiling - secFloor;
 
+            // Middle texture hang from the ceiling, unpegged sit on the floor
+            QuadTexture texture = getWallTexture(sideDef.middleTexture, sideDef);
+            texture.Top += isLowerUnpegged ? frontSector.floor + texture.Height : frontSector.ceiling;
+
             const float angle = std::atan2(y, x) * -1.0f;   // Flip Rotation Angle
             const auto translationMatrix = glm::translate(glm::identity<glm::mat4>(), glm::vec3{start.x, secFloor, start.y});
             const auto scaleMatrix = glm::scale(glm::identity<glm::mat4>(), glm::vec3{length, height, 1.0f});
             const auto rotationMatrix = glm::rotate(glm::identity<glm::mat4>(), angle, {0.0f, 1.0f, 0.0f});
-            s_wallNodeLists.push_back({translationMatrix * rotationMatrix * scaleMatrix, {1.0f, 1.0f, 1.0f, 1.0f}, &mapFile.sectors.at(mapFile.sideDefs.at(line.frontSideDef).sectorIndex)});
+            appendQuad(worldVertices, classIndices[texture.SizeClass], translationMatrix * rotationMatrix * scaleMatrix, color, lightLevel, texture);
         }
+
+        for(size_t sizeClass{}; sizeClass < numSizeClasses; ++sizeClass){
+            auto& range = s_lineDefRanges[sizeClass][lineIndex];
+            range.NumIndices = static_cast<uint32_t>(classIndices[sizeClass].size()) - range.FirstIndex;
+        }
+    }
+
+    std::vector<uint32_t> worldIndices;
+    for(size_t sizeClass{}; sizeClass < numSizeClasses; ++sizeClass){
+        const uint32_t classStart = static_cast<uint32_t>(worldIndices.size());
+        for(auto& range : s_lineDefRanges[sizeClass]){
+            range.FirstIndex += classStart;
+        }
+
+        worldIndices.insert(worldIndices.end(), classIndices[sizeClass].begin(), classIndices[sizeClass].end());
     }
+
+    s_worldMesh = Mesh::createMesh(worldVertices, worldIndices);
+    s_worldVertices = std::move(worldVertices);
+    s_worldIndices = std::move(worldIndices);
+
+    Visibility::init(s_map, s_glMap, &s_levelCache.SectorVisibility);
+    OcclusionCulling::init(s_map);
+    s_unoccludedLineDefs.reserve(s_map.lineDefs.size());
+
+    SoftwareRenderer::init(s_map, s_glMap, palette, colorMap, s_textureCache, Renderer::getSize().x / 2, Renderer::getSize().y / 2);
+
+    Renderer::setPalette(palette, colorMap);
+    TileRasterizer::setPalette(palette, colorMap);
+
+    s_sprites = SpriteSet::load(wadFile);
+    s_spriteInstances = s_sprites.placeThings(s_map, s_glMap);
+    groupSpritesBySubSector();
+    Renderer::setSprites(s_sprites, s_spriteInstances);
+    TileRasterizer::setSprites(s_sprites, s_spriteInstances);
+    TileRasterizer::init(Renderer::getSize().x, Renderer::getSize().y);
+
+    s_levelTic = 0;
+    updateAnimations(0);
+
+    Camera::UpdateDirection(s_camera);
+    s_previousCamera = s_camera;
 }
 
 
 
-void Engine::Update(float deltaTime) {
+void Engine::Update() {
+    s_previousCamera = s_camera;
     Camera::UpdateDirection(s_camera);
 
+    updateAnimations(++s_levelTic);
+
+    // Walking keep to the floor plane, looking up or down do not slow it
+    const glm::vec3 forward = s_isNoClip ? s_camera.Forward : glm::vec3{std::sin(s_camera.Yaw), 0.0f, std::cos(s_camera.Yaw)};
+    glm::vec3 move{};
+
     if(Input::IsKeyPressed(KeyCode::KEY_UP)){
-        s_camera.Position += s_camera.Forward * playerSpeed * deltaTime;
+        move += forward;
     }
 
     if(Input::IsKeyPressed(KeyCode::KEY_DOWN)){
-        s_camera.Position -= s_camera.Forward * playerSpeed * deltaTime;
+        move -= forward;
     }
 
     if(Input::IsKeyPressed(KeyCode::KEY_LEFT)){
-        s_camera.Position -= s_camera.Right * playerSpeed * deltaTime;
+        move -= s_camera.Right;
     }
 
     if(Input::IsKeyPressed(KeyCode::KEY_RIGHT)){
-        s_camera.Position += s_camera.Right * playerSpeed * deltaTime;
+        move += s_camera.Right;
+    }
+
+    if(s_isNoClip && Input::IsKeyPressed(KeyCode::KEY_SPACE)){
+        move += s_camera.Up;
+    }
+
+    if(s_isNoClip && Input::IsKeyPressed(KeyCode::KEY_Z)){
+        move -= s_camera.Up;
     }
 
-    if(Input::IsKeyPressed(KeyCode::KEY_SPACE)){
-        s_camera.Position += s_camera.Up * playerSpeed * deltaTime;
+    move *= playerSpeed * TicSeconds;
+    if(s_isNoClip){
+        s_camera.Position += move;
+    }
+    else {
+        walkPlayer(move);
     }
 
-    if(Input::IsKeyPressed(KeyCode::KEY_Z)){
-        s_camera.Position -= s_camera.Up * playerSpeed * deltaTime;
+    const bool isNoClipKeyDown = Input::IsKeyPressed(KeyCode::KEY_C);
+    if(isNoClipKeyDown && !s_wasNoClipKeyDown){
+        s_isNoClip = !s_isNoClip;
+        std::println("No Clip: {}", s_isNoClip ? "On" : "Off");
     }
+    s_wasNoClipKeyDown = isNoClipKeyDown;
 
     if(Input::IsKeyPressed(KeyCode::KEY_N)){
         modelAngle += 0.1f;
@@ -158,6 +337,63 @@ void Engine::Update(float deltaTime) {
         std::println("Angle: {}", glm::radians(modelAngle));
     }
 
+    if(Input::IsKeyPressed(KeyCode::KEY_V)){
+        const auto& stats = Visibility::getStats();
+        std::println("Nodes: {} Culled: {} Occluded: {} | SubSectors: {} Culled: {} Occluded: {} PVS Rejected: {} Portal Rejected: {} | Segments Occluded: {} | Sector: {} | LineDefs: {} / {}{}", 
+            stats.VisitedNodes, stats.CulledNodes, stats.OccludedNodes, 
+            stats.VisibleSubSectors, stats.CulledSubSectors, stats.OccludedSubSectors, stats.PVSRejectedSubSectors, stats.PortalRejectedSubSectors, stats.OccludedSegments, stats.ViewSector, 
+            stats.VisibleLineDefs, stats.TotalLineDefs, stats.ScreenCovered ? " | Screen Covered" : "");
+        std::println("Portals Crossed: {} | Sectors: {} | {:.1f} us", stats.PortalCrossings, stats.PortalVisibleSectors, stats.PortalMicroseconds);
+
+        std::println("Visibility Cache: {} Age: {} | Hit Rate: {:.1f}% | Update: {:.1f} us Full: {:.1f} us | Saved: {:.1f} ms", 
+            stats.CacheHit ? "Hit" : "Miss", stats.CacheAge, 
+            stats.CacheQueries > 0 ? 100.0 * static_cast<double>(stats.CacheHits) / static_cast<double>(stats.CacheQueries) : 0.0, 
+            stats.UpdateMicroseconds, stats.FullMicroseconds, stats.SavedMicroseconds / 1000.0f);
+
+        const auto& occlusion = OcclusionCulling::getStats();
+        std::println("Occluders: {} Triangles: {} | Draws Rejected: {} / {} | Raster: {:.1f} us Wait: {:.1f} us", 
+            occlusion.Occluders, occlusion.OccluderTriangles, occlusion.RejectedBoxes, occlusion.TestedBoxes, 
+            occlusion.RasterMicroseconds, occlusion.WaitMicroseconds);
+    }
+
+    const bool isSoftwareKeyDown = Input::IsKeyPressed(KeyCode::KEY_B);
+    if(isSoftwareKeyDown && !s_wasSoftwareKeyDown){
+        s_isSoftwareRendering = !s_isSoftwareRendering;
+        std::println("Software Renderer: {}", s_isSoftwareRendering ? "On" : "Off");
+    }
+    s_wasSoftwareKeyDown = isSoftwareKeyDown;
+
+    const bool isDumpKeyDown = Input::IsKeyPressed(KeyCode::KEY_P);
+    if(isDumpKeyDown && !s_wasDumpKeyDown && s_isSoftwareRendering){
+        const auto& stats = SoftwareRenderer::getStats();
+        std::println("Segments: {} Columns: {} Spans: {} VisPlanes: {} | Threads: {} Kernel: {} | {:.2f} ms", 
+            stats.Segments, stats.Columns, stats.Spans, stats.VisPlanes, 
+            stats.Threads, SoftwareKernels::getKernelName(), stats.Milliseconds);
+        SoftwareRenderer::getFrame().writePPM("./software.ppm", SoftwareRenderer::getPalette());
+    }
+    if(isDumpKeyDown && !s_wasDumpKeyDown && s_isTileRasterizing && !s_isSoftwareRendering){
+        const auto& stats = TileRasterizer::getStats();
+        std::println("Triangles: {} Clipped: {} Binned: {} Sprites: {} | Tiles: {} Threads: {} | Bin: {:.2f} ms Raster: {:.2f} ms", 
+            stats.Triangles, stats.ClippedTriangles, stats.BinnedTriangles, stats.Sprites, stats.Tiles, stats.Threads, 
+            stats.BinMilliseconds, stats.RasterMilliseconds);
+    }
+    s_wasDumpKeyDown = isDumpKeyDown;
+
+    const bool isRasterKeyDown = Input::IsKeyPressed(KeyCode::KEY_R);
+    if(isRasterKeyDown && !s_wasRasterKeyDown){
+        s_isTileRasterizing = !s_isTileRasterizing;
+        std::println("Tile Rasterizer: {}", s_isTileRasterizing ? "On" : "Off");
+    }
+    s_wasRasterKeyDown = isRasterKeyDown;
+
+    const bool isPaletteKeyDown = Input::IsKeyPressed(KeyCode::KEY_T);
+    if(isPaletteKeyDown && !s_wasPaletteKeyDown){
+        s_worldShaderFeatures = hasFeature(s_worldShaderFeatures, ShaderFeature::PALETTE) ? ShaderFeature::LIGHT_DIMINISHING : ShaderFeature::LIGHT_DIMINISHING | ShaderFeature::PALETTE;
+        Renderer::setShaderFeatures(s_worldShaderFeatures);
+        std::println("Palette Shading: {}", hasFeature(s_worldShaderFeatures, ShaderFeature::PALETTE) ? "On" : "Off");
+    }
+    s_wasPaletteKeyDown = isPaletteKeyDown;
+
     if(Input::IsButtonPressed(ButtonCode::BUTTON_RIGHT)){
         if(!Input::IsMouseCapture()){
             s_lastMousePosition = Input::GetMousePosition();
@@ -168,8 +404,8 @@ void Engine::Update(float deltaTime) {
         const auto deltaMouse = currentMousePosition - s_lastMousePosition;
         s_lastMousePosition = currentMousePosition;
 
-        s_camera.Yaw += deltaMouse.x * mouseSensitivity * deltaTime;
-        s_camera.Pitch += deltaMouse.y * mouseSensitivity * deltaTime;
+        s_camera.Yaw += deltaMouse.x * mouseSensitivity * TicSeconds;
+        s_camera.Pitch += deltaMouse.y * mouseSensitivity * TicSeconds;
         s_camera.Pitch = std::clamp(s_camera.Pitch, -glm::radians(90.0f), glm::radians(90.0f));
     }
     else if(Input::IsMouseCapture()){
@@ -181,21 +417,120 @@ static glm::vec4 getRandomColor(const uint64_t seed);
 
 extern Mesh s_quadMesh;
 
-void Engine::Render(){
-    Renderer::setViewMatrix(glm::lookAtLH(s_camera.Position, s_camera.Position + s_camera.Forward, s_camera.Up));
+void Engine::Render(float interpolation){
+    const Camera camera = Camera::Interpolate(s_previousCamera, s_camera, interpolation);
 
-    // glm::mat4 tran = glm::translate(glm::identity<glm::mat4>(), {0.0f, 0.0f, 0.0f});
-    // glm::mat4 scal = glm::scale(glm::identity<glm::mat4>(), {1.0f, 1.0f, 1.0f});
-    
-    // glm::mat4 rott = glm::rotate(glm::identity<glm::mat4>(), glm::radians(modelAngle), glm::vec3{0.0f, 1.0f, 0.0f});
-    // Renderer::drawMesh(s_quadMesh, tran * rott * scal, {1.0f, 1.0f, 1.0f, 1.0f});
-    for(const auto& node : s_wallNodeLists){
-        auto color = getRandomColor((uint64_t)node.SectorPtr) * (static_cast<float>(node.SectorPtr->lightLevel) / 255.0f);
-        Renderer::drawMesh(s_quadMesh, node.Model, color);
+    if(s_isSoftwareRendering){
+        SoftwareRenderer::render(camera.Position * MapScaleFactor, camera.Forward);
+
+        const auto& frame = SoftwareRenderer::getFrame();
+        frame.toRGBA(SoftwareRenderer::getPalette(), s_softwarePixels);
+        Renderer::blitImage(s_softwarePixels, frame.Width, frame.Height);
+        return;
+    }
+
+    const glm::mat4 viewMatrix = glm::lookAtLH(camera.Position, camera.Position + camera.Forward, camera.Up);
+    Renderer::setViewMatrix(viewMatrix);
+
+    // Visibility work in map units
+    const glm::mat4 worldToMap = glm::scale(glm::identity<glm::mat4>(), glm::vec3{1.0f / MapScaleFactor});
+
+    ViewState view{};
+    view.Position = camera.Position * MapScaleFactor;
+    view.Forward = camera.Forward;
+    view.Projection = s_projectionMatrix;
+    view.ViewProjection = s_projectionMatrix * viewMatrix * worldToMap;
+    view.ScreenWidth = Renderer::getSize().x;
+
+    // Occluders rasterize on the worker while the BSP walk run here
+    OcclusionCulling::beginFrame(view.ViewProjection, view.Position);
+    Visibility::update(view);
+    OcclusionCulling::endFrame();
+
+    s_unoccludedLineDefs.clear();
+    OcclusionCulling::filterVisible(Visibility::getLineDefBounds(), Visibility::getVisibleLineDefs(), s_unoccludedLineDefs);
+
+    for(auto& ranges : s_visibleRanges){
+        ranges.clear();
+    }
+
+    for(auto lineDef : s_unoccludedLineDefs){
+        for(size_t sizeClass{}; sizeClass < s_visibleRanges.size(); ++sizeClass){
+            const auto& range = s_lineDefRanges[sizeClass][lineDef];
+            auto& ranges = s_visibleRanges[sizeClass];
+            if(range.NumIndices == 0){
+                continue;
+            }
+
+            // Merge neighbor LineDefs into one draw range
+            if(!ranges.empty() && ranges.back().FirstIndex + ranges.back().NumIndices == range.FirstIndex){
+                ranges.back().NumIndices += range.NumIndices;
+            }
+            else {
+                ranges.push_back(range);
+            }
+        }
+    }
+
+    // Like vanilla R_AddSprites, things of the subsectors the walk reached
+    s_visibleSprites.clear();
+    for(auto subSector : Visibility::getVisibleSubSectors()){
+        const auto& range = s_subSectorSprites[subSector];
+        if(range.NumInstances == 0){
+            continue;
+        }
+
+        if(!s_visibleSprites.empty() && s_visibleSprites.back().FirstInstance + s_visibleSprites.back().NumInstances == range.FirstInstance){
+            s_visibleSprites.back().NumInstances += range.NumInstances;
+        }
+        else {
+            s_visibleSprites.push_back(range);
+        }
+    }
+
+    if(s_isTileRasterizing){
+        TileRasterizer::setViewMatrix(viewMatrix);
+        TileRasterizer::setProjectionMatrix(s_projectionMatrix);
+        TileRasterizer::setShaderFeatures(s_worldShaderFeatures);
+
+        // Same draws as the GL path below
+        TileRasterizer::beginFrame({0.2f, 0.2f, 0.2f, 1.0f});
+        for(size_t sizeClass{}; sizeClass < s_visibleRanges.size(); ++sizeClass){
+            if(!s_visibleRanges[sizeClass].empty()){
+                TileRasterizer::bindTexture(s_textureAtlas.Arrays[sizeClass]);
+                TileRasterizer::drawMeshRanges(s_worldVertices, s_worldIndices, s_visibleRanges[sizeClass], glm::identity<glm::mat4>(), {1.0f, 1.0f, 1.0f, 1.0f});
+            }
+        }
+        TileRasterizer::drawSprites(s_visibleSprites);
+        TileRasterizer::endFrame();
+
+        Renderer::blitImage(TileRasterizer::getColorBuffer(), TileRasterizer::getSize().x, TileRasterizer::getSize().y);
+        return;
     }
+
+    // One multi draw per size class, the class array replace the last one on unit 1
+    for(size_t sizeClass{}; sizeClass < s_visibleRanges.size(); ++sizeClass){
+        if(!s_visibleRanges[sizeClass].empty()){
+            Renderer::bindTexture(s_textureAtlas.Arrays[sizeClass]);
+            Renderer::drawMeshRanges(s_worldMesh, s_visibleRanges[sizeClass], glm::identity<glm::mat4>(), {1.0f, 1.0f, 1.0f, 1.0f});
+        }
+    }
+
+    Renderer::drawSprites(s_visibleSprites);
+}
+
+void Engine::Shutdown() {
+    OcclusionCulling::shutdown();
+    SoftwareRenderer::shutdown();
+    TileRasterizer::shutdown();
+    s_textureAtlas.release();
 }
 
-// We use ptr to gen color
+const VisibilityStats& Engine::GetVisibilityStats() {
+    return Visibility::getStats();
+}
+
+// We use sector index to gen color
 glm::vec4 getRandomColor(const uint64_t seed){
     std::mt19937_64 gen{seed};
     std::uniform_real_distribution<float> dis{0.0f, 1.0f};
@@ -203,11 +538,10 @@ glm::vec4 getRandomColor(const uint64_t seed){
 }
 
 glm::mat4 verticesToModel(glm::vec3 point0, glm::vec3 point1, glm::vec3 point2, glm::vec3 point3) {
-    constexpr float scaleFactor{100.0f};
-    point0 /= scaleFactor;
-    point1 /= scaleFactor;
-    point2 /= scaleFactor;
-    point3 /= scaleFactor;
+    point0 /= MapScaleFactor;
+    point1 /= MapScaleFactor;
+    point2 /= MapScaleFactor;
+    point3 /= MapScaleFactor;
 
     const float x = point1.x - point0.x;
     const float y = point1.z - point0.z;
@@ -220,4 +554,123 @@ glm::mat4 verticesToModel(glm::vec3 point0, glm::vec3 point1, glm::vec3 point2,
     const auto rotationMatrix = glm::rotate(glm::identity<glm::mat4>(), angle, {0.0f, 1.0f, 0.0f});
 
     return translationMatrix * rotationMatrix * scaleMatrix;
-}
\ No newline at end of file
+}
+
+void appendQuad(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const glm::mat4& model, const glm::vec4& color, int16_t lightLevel, const QuadTexture& texture) {
+    // Same corners and winding as Renderer quad mesh
+    constexpr glm::vec3 corners[]{
+        {1.0f, 1.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 0.0f},
+        {1.0f, 0.0f, 0.0f}
+    };
+
+    const uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+
+    // Texels are map units, u along the wall and v down from the texture top
+    const float length = glm::length(glm::vec3{model[0]}) * MapScaleFactor;
+
+    for(auto&& corner : corners){
+        const glm::vec3 position{model * glm::vec4{corner, 1.0f}};
+        const glm::vec2 texCoord{corner.x * length + texture.OffsetX, texture.Top - position.y * MapScaleFactor};
+        vertices.push_back({position, color, texCoord, static_cast<float>(lightLevel), texture.Slot});
+    }
+
+    for(uint32_t index : {0u, 1u, 3u, 1u, 2u, 3u}){
+        indices.push_back(baseVertex + index);
+    }
+}
+
+glm::vec4 getSectorColor(uint16_t sectorIndex, const Sector& sector) {
+    return getRandomColor(sectorIndex) * (static_cast<float>(sector.lightLevel) / 255.0f);
+}
+
+// Size class and slot of a SideDef texture, slot 0 is the placeholder, Top start at the row offset and the caller add the pegging
+// Slots past MaxTextureSlots are not in the remap buffer, those textures draw the placeholder too
+QuadTexture getWallTexture(Name8 name, const SideDef& sideDef) {
+    QuadTexture texture{};
+    texture.OffsetX = sideDef.xOffset;
+    texture.Top = sideDef.yOffset;
+
+    const int index = s_textureCache.find(name);
+    if(index >= 0 && s_textureAtlas.Locations[index].x >= 0 && static_cast<size_t>(s_textureAtlas.Slots[index]) < MaxTextureSlots){
+        const glm::ivec2 location = s_textureAtlas.Locations[index];
+        texture.SizeClass = location.x;
+        texture.Slot = static_cast<float>(s_textureAtlas.Slots[index]);
+        texture.Height = static_cast<float>(s_textureCache.Textures[index].Height);
+    }
+    else {
+        texture.SizeClass = static_cast<int>(s_textureAtlas.Arrays.size()) - 1;
+        texture.Height = static_cast<float>(s_textureAtlas.Arrays.back().Height);
+    }
+
+    return texture;
+}
+
+// Bricks from one Doom palette ramp for walls without a texture
+TextureArray makePlaceholderTexture() {
+    constexpr int Width{64}, Height{128};
+    constexpr uint8_t BrickRamp{80};
+
+    std::vector<uint8_t> indices(Width * Height);
+    for(int v{}; v < Height; ++v){
+        for(int u{}; u < Width; ++u){
+            const bool isMortar = (v & 15) == 0 || ((u + ((v >> 4) & 1) * 16) & 31) == 0;
+            indices[v * Width + u] = static_cast<uint8_t>(BrickRamp + (isMortar ? 12 : ((u * 7 + v * 13) & 3)));
+        }
+    }
+
+    TextureArray textureArray = TextureArray::createIndexed(Width, Height, 1);
+    textureArray.uploadLayer(0, indices);
+    return textureArray;
+}
+
+// Move is in world units, collision and sector heights work in map units
+// Step up and drop down happen in one tic, only the render interpolation smooth them
+void walkPlayer(glm::vec3 move) {
+    const glm::vec2 position = glm::vec2{s_camera.Position.x, s_camera.Position.z} * MapScaleFactor;
+    const float feetHeight = static_cast<float>(s_map.sectors.at(BSP::findSector(s_map, s_glMap, position)).floor);
+
+    const glm::vec2 destination = Collision::slideMove(s_map, position, feetHeight, glm::vec2{move.x, move.z} * MapScaleFactor);
+    const float floor = static_cast<float>(s_map.sectors.at(BSP::findSector(s_map, s_glMap, destination)).floor);
+
+    s_camera.Position = glm::vec3{destination.x, floor + ViewHeight, destination.y} / MapScaleFactor;
+}
+
+void updateAnimations(uint32_t tic) {
+    s_textureCache.Animations.getFrames(s_textureCache, tic, s_wallFrames, s_flatFrames);
+    if(s_textureAtlas.animate(s_wallFrames)){
+        Renderer::setTextureRemap(s_textureAtlas.SlotLayers);
+        TileRasterizer::setTextureRemap(s_textureAtlas.SlotLayers);
+    }
+
+    SoftwareRenderer::setAnimationFrames(s_wallFrames, s_flatFrames);
+}
+
+void groupSpritesBySubSector() {
+    std::vector<uint16_t> subSectors;
+    subSectors.reserve(s_spriteInstances.size());
+    for(auto&& instance : s_spriteInstances){
+        subSectors.push_back(BSP::findSubSector(s_glMap, glm::vec2{instance.Position.x, instance.Position.z} * MapScaleFactor));
+    }
+
+    // Counting sort, each subsector end as one range
+    s_subSectorSprites.assign(s_glMap.subSectors.size(), SpriteRange{});
+    for(auto subSector : subSectors){
+        ++s_subSectorSprites[subSector].NumInstances;
+    }
+
+    uint32_t firstInstance{};
+    for(auto& range : s_subSectorSprites){
+        range.FirstInstance = firstInstance;
+        firstInstance += range.NumInstances;
+        range.NumInstances = 0;
+    }
+
+    std::vector<SpriteInstance> instances(s_spriteInstances.size());
+    for(size_t i{}; i < s_spriteInstances.size(); ++i){
+        auto& range = s_subSectorSprites[subSectors[i]];
+        instances[range.FirstInstance + range.NumInstances++] = s_spriteInstances[i];
+    }
+    s_spriteInstances = std::move(instances);
+}
@@ -0,0 +1,257 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <Creepy/Frustum.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define CREEPY_X86_SIMD
+#endif
+
+using CullKernel = uint32_t(*)(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices);
+
+static uint32_t cullScalar(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices, size_t first);
+static CullKernel selectCullKernel();
+static const char* s_cullKernelName{"Scalar"};
+
+#ifdef CREEPY_X86_SIMD
+static uint32_t cullSSE(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices);
+__attribute__((target("avx"))) static uint32_t cullAVX(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices);
+#endif
+
+static const CullKernel s_cullKernel = selectCullKernel();
+
+void BoundsSoA::clear() {
+    for(auto* component : {&MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ}){
+        component->clear();
+    }
+}
+
+void BoundsSoA::reserve(size_t count) {
+    for(auto* component : {&MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ}){
+        component->reserve(count);
+    }
+}
+
+void BoundsSoA::push(glm::vec3 min, glm::vec3 max) {
+    MinX.push_back(min.x);
+    MinY.push_back(min.y);
+    MinZ.push_back(min.z);
+    MaxX.push_back(max.x);
+    MaxY.push_back(max.y);
+    MaxZ.push_back(max.z);
+}
+
+size_t BoundsSoA::size() const {
+    return MinX.size();
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+    const glm::mat4 matrix = glm::transpose(viewProjection);    // Rows as columns
+
+    Frustum frustum{};
+    frustum.Planes[0] = matrix[3] + matrix[0];      // Left
+    frustum.Planes[1] = matrix[3] - matrix[0];      // Right
+    frustum.Planes[2] = matrix[3] + matrix[1];      // Bottom
+    frustum.Planes[3] = matrix[3] - matrix[1];      // Top
+    frustum.Planes[4] = matrix[3] + matrix[2];      // Near, clip z in [-1, 1]
+    frustum.Planes[5] = matrix[3] - matrix[2];      // Far
+
+    for(auto& plane : frustum.Planes){
+        plane /= glm::length(glm::vec3{plane});
+    }
+
+    return frustum;
+}
+
+bool Frustum::isBoxVisible(glm::vec3 min, glm::vec3 max) const {
+    for(const auto& plane : Planes){
+        // Corner furthest along the plane normal
+        const glm::vec3 corner{
+            plane.x >= 0.0f ? max.x : min.x,
+            plane.y >= 0.0f ? max.y : min.y,
+            plane.z >= 0.0f ? max.z : min.z
+        };
+
+        if(glm::dot(glm::vec3{plane}, corner) + plane.w < 0.0f){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t Frustum::cullBoxes(const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices) const {
+    return s_cullKernel(Planes, bounds, visibleIndices);
+}
+
+uint32_t Frustum::cullBoxesScalar(const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices) const {
+    return cullScalar(Planes, bounds, visibleIndices, 0);
+}
+
+const char* Frustum::getCullKernelName() {
+    return s_cullKernelName;
+}
+
+void Frustum::benchmarkCulling(uint32_t numBoxes, uint32_t numIterations) {
+    std::mt19937 gen{1234};
+    std::uniform_real_distribution<float> position{-1000.0f, 1000.0f};
+    std::uniform_real_distribution<float> extent{1.0f, 20.0f};
+
+    BoundsSoA bounds{};
+    bounds.reserve(numBoxes);
+    for(uint32_t i{}; i < numBoxes; ++i){
+        const glm::vec3 center{position(gen), position(gen) * 0.1f, position(gen)};
+        const glm::vec3 halfSize{extent(gen), extent(gen), extent(gen)};
+        bounds.push(center - halfSize, center + halfSize);
+    }
+
+    const glm::mat4 projection = glm::perspectiveLH(glm::radians(60.0f), 1.0f, 1.0f, 1500.0f);
+    const glm::mat4 view = glm::lookAtLH(glm::vec3{0.0f}, glm::vec3{1.0f, 0.0f, 1.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+    const Frustum frustum = fromMatrix(projection * view);
+
+    std::vector<uint32_t> scalarIndices, simdIndices;
+    scalarIndices.reserve(numBoxes);
+    simdIndices.reserve(numBoxes);
+
+    auto measure = [&](auto&& cull, std::vector<uint32_t>& indices){
+        const auto startTime = std::chrono::steady_clock::now();
+        for(uint32_t i{}; i < numIterations; ++i){
+            indices.clear();
+            cull(bounds, indices);
+        }
+        const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+        return elapsed.count() / static_cast<float>(numIterations);
+    };
+
+    const float scalarTime = measure([&](const BoundsSoA& boxes, std::vector<uint32_t>& indices){ frustum.cullBoxesScalar(boxes, indices); }, scalarIndices);
+    const float simdTime = measure([&](const BoundsSoA& boxes, std::vector<uint32_t>& indices){ frustum.cullBoxes(boxes, indices); }, simdIndices);
+
+    std::println("Frustum Cull {} Boxes: Scalar {:.1f} us | {} {:.1f} us | Speedup {:.2f}x | Visible {} | {}", 
+        numBoxes, scalarTime, s_cullKernelName, simdTime, scalarTime / simdTime, simdIndices.size(), 
+        scalarIndices == simdIndices ? "Match" : "MISMATCH");
+}
+
+uint32_t cullScalar(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices, size_t first) {
+    uint32_t numVisible{};
+
+    for(size_t i = first; i < bounds.size(); ++i){
+        bool isVisible{true};
+
+        for(const auto& plane : planes){
+            const float x = plane.x >= 0.0f ? bounds.MaxX[i] : bounds.MinX[i];
+            const float y = plane.y >= 0.0f ? bounds.MaxY[i] : bounds.MinY[i];
+            const float z = plane.z >= 0.0f ? bounds.MaxZ[i] : bounds.MinZ[i];
+
+            // Same add order as the SIMD kernels so results match bit for bit
+            if((plane.x * x + plane.y * y) + (plane.z * z + plane.w) < 0.0f){
+                isVisible = false;
+                break;
+            }
+        }
+
+        if(isVisible){
+            visibleIndices.push_back(static_cast<uint32_t>(i));
+            ++numVisible;
+        }
+    }
+
+    return numVisible;
+}
+
+CullKernel selectCullKernel() {
+#ifdef CREEPY_X86_SIMD
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx")){
+        s_cullKernelName = "AVX";
+        return cullAVX;
+    }
+
+    // SSE2 is baseline on x86-64
+    s_cullKernelName = "SSE";
+    return cullSSE;
+#else
+    return [](const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices){
+        return cullScalar(planes, bounds, visibleIndices, 0);
+    };
+#endif
+}
+
+#ifdef CREEPY_X86_SIMD
+
+// Plane is the same for every lane, so the corner pick is one pointer choice per plane, not a blend
+struct PlaneLanes{
+    const float* x;
+    const float* y;
+    const float* z;
+};
+
+static std::array<PlaneLanes, 6> pickCorners(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds) {
+    std::array<PlaneLanes, 6> lanes{};
+
+    for(size_t i{}; i < planes.size(); ++i){
+        lanes[i].x = planes[i].x >= 0.0f ? bounds.MaxX.data() : bounds.MinX.data();
+        lanes[i].y = planes[i].y >= 0.0f ? bounds.MaxY.data() : bounds.MinY.data();
+        lanes[i].z = planes[i].z >= 0.0f ? bounds.MaxZ.data() : bounds.MinZ.data();
+    }
+
+    return lanes;
+}
+
+uint32_t cullSSE(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices) {
+    const auto lanes = pickCorners(planes, bounds);
+    const size_t count = bounds.size();
+    const size_t batchEnd = count & ~size_t{3};
+    const size_t firstIndex = visibleIndices.size();
+
+    for(size_t i{}; i < batchEnd; i += 4){
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for(size_t p{}; p < planes.size(); ++p){
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), _mm_loadu_ps(lanes[p].x + i)), 
+                           _mm_mul_ps(_mm_set1_ps(planes[p].y), _mm_loadu_ps(lanes[p].y + i))),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z), _mm_loadu_ps(lanes[p].z + i)), _mm_set1_ps(planes[p].w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+
+        for(int mask = _mm_movemask_ps(inside); mask != 0; mask &= mask - 1){
+            visibleIndices.push_back(static_cast<uint32_t>(i + __builtin_ctz(mask)));
+        }
+    }
+
+    cullScalar(planes, bounds, visibleIndices, batchEnd);
+    return static_cast<uint32_t>(visibleIndices.size() - firstIndex);
+}
+
+__attribute__((target("avx")))
+uint32_t cullAVX(const std::array<glm::vec4, 6>& planes, const BoundsSoA& bounds, std::vector<uint32_t>& visibleIndices) {
+    const auto lanes = pickCorners(planes, bounds);
+    const size_t count = bounds.size();
+    const size_t batchEnd = count & ~size_t{7};
+    const size_t firstIndex = visibleIndices.size();
+
+    for(size_t i{}; i < batchEnd; i += 8){
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for(size_t p{}; p < planes.size(); ++p){
+            const __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].x), _mm256_loadu_ps(lanes[p].x + i)), 
+                              _mm256_mul_ps(_mm256_set1_ps(planes[p].y), _mm256_loadu_ps(lanes[p].y + i))),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].z), _mm256_loadu_ps(lanes[p].z + i)), _mm256_set1_ps(planes[p].w)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        for(int mask = _mm256_movemask_ps(inside); mask != 0; mask &= mask - 1){
+            visibleIndices.push_back(static_cast<uint32_t>(i + __builtin_ctz(mask)));
+        }
+    }
+
+    cullScalar(planes, bounds, visibleIndices, batchEnd);
+    return static_cast<uint32_t>(visibleIndices.size() - firstIndex);
+}
+
+#endif
@@ -0,0 +1,219 @@
+#include <print>
+#include <fstream>
+#include <chrono>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <Creepy/LevelCache.hpp>
+#include <Creepy/WAD.hpp>
+#include <Creepy/Utils.hpp>
+#include <Creepy/MipChain.hpp>
+#include <Creepy/TextureCache.hpp>
+
+static std::filesystem::path s_cacheDirectory{"./res/cache"};
+
+constexpr uint32_t CacheMagic{0x4C56434C};     // "LCVL"
+constexpr uint32_t CacheVersion{4};
+constexpr int NumMapLumps{10};                  // THINGS to BLOCKMAP follow the map marker
+
+struct CacheHeader{
+    uint32_t magic{CacheMagic};
+    uint32_t version{CacheVersion};
+    uint64_t key{};
+};
+
+template <typename T>
+static void writeVector(std::ofstream& fileOut, const std::vector<T>& values);
+
+template <typename T>
+static bool readVector(std::ifstream& fileIn, std::vector<T>& values);
+
+static uint64_t hashTexels(const CompositeTexture& texture);
+static size_t applyMips(LevelCache& levelCache, TextureCache& textureCache);
+static void collectMips(LevelCache& levelCache, const TextureCache& textureCache);
+
+void LevelCache::setCacheDirectory(const std::filesystem::path& directory) {
+    s_cacheDirectory = directory;
+}
+
+uint64_t LevelCache::makeKey(const WAD& wadFile, std::string_view mapName) {
+    uint64_t key = hashBytes(std::as_bytes(std::span{&CacheVersion, 1}));
+
+    const int mapIndex = WAD::findLump(mapName, wadFile);
+    if(mapIndex < 0){
+        return key;
+    }
+
+    for(int i = mapIndex + 1; i <= mapIndex + NumMapLumps && i < static_cast<int>(wadFile.lumps.size()); ++i){
+        key = hashBytes(wadFile.lumps[i].data, key);
+    }
+
+    // Mips are picked from the palette, a new PLAYPAL invalidate them all
+    if(const int paletteIndex = WAD::findLump("PLAYPAL", wadFile); paletteIndex >= 0){
+        key = hashBytes(wadFile.lumps[paletteIndex].data, key);
+    }
+
+    return key;
+}
+
+LevelCache LevelCache::loadOrBuild(const WAD& wadFile, std::string_view mapName, const Map& map, TextureCache& textureCache, const Palette& palette) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const uint64_t key = makeKey(wadFile, mapName);
+    const auto filePath = s_cacheDirectory / std::format("{}.lvl", mapName);
+
+    if(auto levelCache = load(filePath, key); levelCache.has_value()){
+        // Texture lumps are not in the key, a PWAD over them only cost the changed textures
+        if(applyMips(levelCache.value(), textureCache) > 0){
+            MipChain::build(palette).generateMissing(textureCache);
+            collectMips(levelCache.value(), textureCache);
+            store(filePath, levelCache.value());
+            levelCache->TextureMips.clear();
+        }
+
+        const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        std::println("Level Cache Hit: {} - {:.3f} ms", mapName, elapsed.count());
+        return std::move(levelCache.value());
+    }
+
+    LevelCache levelCache{};
+    levelCache.Key = key;
+    levelCache.SectorVisibility = PVS::compute(map);
+
+    MipChain::build(palette).generateMissing(textureCache);
+    collectMips(levelCache, textureCache);
+    store(filePath, levelCache);
+    levelCache.TextureMips.clear();
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::println("Level Cache Miss: {} - {:.3f} ms", mapName, elapsed.count());
+
+    return levelCache;
+}
+
+std::optional<LevelCache> LevelCache::load(const std::filesystem::path& filePath, uint64_t key) {
+    std::ifstream fileIn{filePath, std::ios::binary};
+
+    if(!fileIn.good()){
+        return std::nullopt;
+    }
+
+    CacheHeader header{};
+    fileIn.read(std::bit_cast<char*>(&header), sizeof(CacheHeader));
+
+    if(!fileIn.good() || header.magic != CacheMagic || header.version != CacheVersion || header.key != key){
+        return std::nullopt;
+    }
+
+    LevelCache levelCache{};
+    levelCache.Key = key;
+
+    auto& pvs = levelCache.SectorVisibility;
+    fileIn.read(std::bit_cast<char*>(&pvs.NumSectors), sizeof(pvs.NumSectors));
+
+    if(!fileIn.good() || !readVector(fileIn, pvs.RowOffsets) || !readVector(fileIn, pvs.Data) || pvs.RowOffsets.size() != pvs.NumSectors){
+        std::println("Level Cache Rejected: {}", filePath.string());
+        return std::nullopt;
+    }
+
+    uint32_t numMips{};
+    fileIn.read(std::bit_cast<char*>(&numMips), sizeof(numMips));
+    levelCache.TextureMips.resize(fileIn.good() ? numMips : 0);
+
+    for(auto& cachedMips : levelCache.TextureMips){
+        fileIn.read(std::bit_cast<char*>(&cachedMips.Name.Value), sizeof(cachedMips.Name.Value));
+        fileIn.read(std::bit_cast<char*>(&cachedMips.TexelHash), sizeof(cachedMips.TexelHash));
+        if(!fileIn.good() || !readVector(fileIn, cachedMips.Mips)){
+            std::println("Level Cache Rejected: {}", filePath.string());
+            return std::nullopt;
+        }
+    }
+
+    return levelCache;
+}
+
+void LevelCache::store(const std::filesystem::path& filePath, const LevelCache& levelCache) {
+    std::error_code errorCode;
+    std::filesystem::create_directories(filePath.parent_path(), errorCode);
+
+    std::ofstream fileOut{filePath, std::ios::binary | std::ios::trunc};
+
+    if(!fileOut.good()){
+        std::println("Failed Write Level Cache: {}", filePath.string());
+        return;
+    }
+
+    CacheHeader header{};
+    header.key = levelCache.Key;
+    fileOut.write(std::bit_cast<const char*>(&header), sizeof(CacheHeader));
+
+    const auto& pvs = levelCache.SectorVisibility;
+    fileOut.write(std::bit_cast<const char*>(&pvs.NumSectors), sizeof(pvs.NumSectors));
+    writeVector(fileOut, pvs.RowOffsets);
+    writeVector(fileOut, pvs.Data);
+
+    const uint32_t numMips = static_cast<uint32_t>(levelCache.TextureMips.size());
+    fileOut.write(std::bit_cast<const char*>(&numMips), sizeof(numMips));
+
+    for(auto&& cachedMips : levelCache.TextureMips){
+        fileOut.write(std::bit_cast<const char*>(&cachedMips.Name.Value), sizeof(cachedMips.Name.Value));
+        fileOut.write(std::bit_cast<const char*>(&cachedMips.TexelHash), sizeof(cachedMips.TexelHash));
+        writeVector(fileOut, cachedMips.Mips);
+    }
+}
+
+template <typename T>
+void writeVector(std::ofstream& fileOut, const std::vector<T>& values) {
+    const uint32_t size = static_cast<uint32_t>(values.size());
+    fileOut.write(std::bit_cast<const char*>(&size), sizeof(size));
+    fileOut.write(std::bit_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readVector(std::ifstream& fileIn, std::vector<T>& values) {
+    uint32_t size{};
+    fileIn.read(std::bit_cast<char*>(&size), sizeof(size));
+
+    if(!fileIn.good()){
+        return false;
+    }
+
+    values.resize(size);
+    fileIn.read(std::bit_cast<char*>(values.data()), values.size() * sizeof(T));
+    return fileIn.good();
+}
+
+uint64_t hashTexels(const CompositeTexture& texture) {
+    const std::array size{texture.Width, texture.Height};
+    return hashBytes(std::as_bytes(std::span{texture.Texels}), hashBytes(std::as_bytes(std::span{size})));
+}
+
+// Level textures still without mips after the cached ones are handed over
+size_t applyMips(LevelCache& levelCache, TextureCache& textureCache) {
+    for(auto& cachedMips : levelCache.TextureMips){
+        const int index = textureCache.find(cachedMips.Name);
+        if(index < 0){
+            continue;
+        }
+
+        auto& texture = textureCache.Textures[index];
+        if(texture.Mips.empty() && cachedMips.Mips.size() == MipChain::getChainSize(texture.Height, texture.Width) && cachedMips.TexelHash == hashTexels(texture)){
+            texture.Mips = std::move(cachedMips.Mips);
+        }
+    }
+
+    levelCache.TextureMips.clear();
+
+    return std::ranges::count_if(textureCache.Textures, [&textureCache](const CompositeTexture& texture){
+        return textureCache.isInLevel(texture) && texture.Mips.empty();
+    });
+}
+
+// Textures kept from an older level have mips already but still belong in this level file
+void collectMips(LevelCache& levelCache, const TextureCache& textureCache) {
+    levelCache.TextureMips.clear();
+    for(auto&& texture : textureCache.Textures){
+        if(textureCache.isInLevel(texture) && !texture.Mips.empty()){
+            levelCache.TextureMips.push_back(CachedMips{texture.Name, hashTexels(texture), texture.Mips});
+        }
+    }
+}
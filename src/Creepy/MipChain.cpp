@@ -0,0 +1,208 @@
+#include <print>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <Creepy/MipChain.hpp>
+#include <Creepy/TextureCache.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define CREEPY_X86_SIMD
+#endif
+
+static float toLinear(float srgb);
+static float toSrgb(float linear);
+static void boxFilter(const MipChain& mipChain, const uint8_t* source, int width, int height, uint8_t* destination);
+static int getLinearStep(float sum);
+static uint8_t getNearestIndex(const MipChain& mipChain, int red, int green, int blue);
+
+MipChain MipChain::build(const Palette& palette) {
+    MipChain mipChain{};
+
+    for(int i{}; i < 256; ++i){
+        const glm::vec3 color = glm::vec3{palette.Colors[i]} / 255.0f;
+        mipChain.LinearColors[i] = glm::vec4{toLinear(color.r), toLinear(color.g), toLinear(color.b), 0.0f};
+    }
+
+    for(int i{}; i < LinearSteps; ++i){
+        const float srgb = toSrgb(static_cast<float>(i) / (LinearSteps - 1));
+        mipChain.LinearToCell[i] = static_cast<uint8_t>(std::min(static_cast<int>(srgb * PaletteGridSize), PaletteGridSize - 1));
+    }
+
+    // Nearest in sRGB from the cell center, closer to how different colors look than linear distance
+    mipChain.NearestIndex.resize(PaletteGridSize * PaletteGridSize * PaletteGridSize);
+    for(int red{}; red < PaletteGridSize; ++red){
+        for(int green{}; green < PaletteGridSize; ++green){
+            for(int blue{}; blue < PaletteGridSize; ++blue){
+                const glm::vec3 center = (glm::vec3{red, green, blue} + 0.5f) * (255.0f / PaletteGridSize);
+
+                float bestDistance{std::numeric_limits<float>::max()};
+                int bestIndex{};
+                for(int i{}; i < 256; ++i){
+                    const glm::vec3 delta = glm::vec3{palette.Colors[i]} - center;
+                    const float distance = glm::dot(delta, delta);
+                    if(distance < bestDistance){
+                        bestDistance = distance;
+                        bestIndex = i;
+                    }
+                }
+
+                mipChain.NearestIndex[(red << (PaletteGridBits * 2)) | (green << PaletteGridBits) | blue] = static_cast<uint8_t>(bestIndex);
+            }
+        }
+    }
+
+    return mipChain;
+}
+
+int MipChain::getLevelCount(int width, int height) {
+    return static_cast<int>(std::floor(std::log2(std::max({width, height, 1})))) + 1;
+}
+
+size_t MipChain::getChainSize(int width, int height) {
+    size_t size{};
+    for(int level{1}; level < getLevelCount(width, height); ++level){
+        size += static_cast<size_t>(std::max(width >> level, 1)) * std::max(height >> level, 1);
+    }
+    return size;
+}
+
+void MipChain::generate(std::span<const uint8_t> texels, int width, int height, std::span<uint8_t> mips) const {
+    if(texels.size() < static_cast<size_t>(width) * height || mips.size() < getChainSize(width, height)){
+        return;
+    }
+
+    // Each level from the one before, not the base, so the cost stay near one pass over the texture
+    const uint8_t* source = texels.data();
+    uint8_t* destination = mips.data();
+    const int numLevels = getLevelCount(width, height);
+    for(int level{1}; level < numLevels; ++level){
+        boxFilter(*this, source, width, height, destination);
+
+        source = destination;
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+        destination += static_cast<size_t>(width) * height;
+    }
+}
+
+void MipChain::generateMissing(TextureCache& textureCache, int numThreads) const {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<CompositeTexture*> textures;
+    for(auto& texture : textureCache.Textures){
+        if(textureCache.isInLevel(texture) && texture.Mips.empty()){
+            textures.push_back(&texture);
+        }
+    }
+
+    if(textures.empty()){
+        return;
+    }
+
+    if(numThreads <= 0){
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Textures are independent, workers take the next one
+    std::atomic<size_t> nextTexture{};
+    auto worker = [&](){
+        for(size_t i = nextTexture.fetch_add(1); i < textures.size(); i = nextTexture.fetch_add(1)){
+            auto& texture = *textures[i];
+            texture.Mips.resize(getChainSize(texture.Height, texture.Width));
+            generate(texture.Texels, texture.Height, texture.Width, texture.Mips);
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        for(int i{1}; i < std::min<int>(numThreads, static_cast<int>(textures.size())); ++i){
+            workers.emplace_back(worker);
+        }
+
+        worker();
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::println("Mips: {} Textures In {:.3f} ms", textures.size(), elapsed.count());
+}
+
+float toLinear(float srgb) {
+    return srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+}
+
+float toSrgb(float linear) {
+    return linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+}
+
+// Round half up in integers, a lone multiply can not be fused so SSE and scalar builds agree bit for bit
+// The level cache keep the result, it must not change with the build
+int getLinearStep(float sum) {
+    return (static_cast<int>(sum * (0.5f * (LinearSteps - 1))) + 1) >> 1;
+}
+
+uint8_t getNearestIndex(const MipChain& mipChain, int red, int green, int blue) {
+    return mipChain.NearestIndex[mipChain.LinearToCell[red] << (PaletteGridBits * 2) | mipChain.LinearToCell[green] << PaletteGridBits | mipChain.LinearToCell[blue]];
+}
+
+// Odd sizes drop the last row or column like a GL box, 1 wide levels clamp to the same texel
+void boxFilter(const MipChain& mipChain, const uint8_t* source, int width, int height, uint8_t* destination) {
+    const int mipWidth = std::max(width >> 1, 1);
+    const int mipHeight = std::max(height >> 1, 1);
+
+    for(int y{}; y < mipHeight; ++y){
+        const uint8_t* row0 = source + static_cast<size_t>(std::min(y * 2, height - 1)) * width;
+        const uint8_t* row1 = source + static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width;
+        uint8_t* mipRow = destination + static_cast<size_t>(y) * mipWidth;
+        int x{};
+
+#ifdef CREEPY_X86_SIMD
+        // 4 output texels per step, box sums transposed to red, green, blue registers
+        // Width 1 clamp the columns, left to the scalar tail
+        for(; width >= 2 && x + 4 <= mipWidth; x += 4){
+            __m128 sums[4];
+            for(int lane{}; lane < 4; ++lane){
+                const int x0 = (x + lane) * 2;
+                sums[lane] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_loadu_ps(&mipChain.LinearColors[row0[x0]].x), _mm_loadu_ps(&mipChain.LinearColors[row0[x0 + 1]].x)),
+                    _mm_loadu_ps(&mipChain.LinearColors[row1[x0]].x)), _mm_loadu_ps(&mipChain.LinearColors[row1[x0 + 1]].x));
+            }
+            _MM_TRANSPOSE4_PS(sums[0], sums[1], sums[2], sums[3]);
+
+            // Same as getLinearStep on each lane
+            const __m128 scale = _mm_set1_ps(0.5f * (LinearSteps - 1));
+            const __m128i one = _mm_set1_epi32(1);
+            alignas(16) std::array<std::array<int, 4>, 3> steps;
+            for(int channel{}; channel < 3; ++channel){
+                const __m128i doubled = _mm_cvttps_epi32(_mm_mul_ps(sums[channel], scale));
+                _mm_store_si128(reinterpret_cast<__m128i*>(steps[channel].data()), _mm_srai_epi32(_mm_add_epi32(doubled, one), 1));
+            }
+
+            for(int lane{}; lane < 4; ++lane){
+                const int x0 = (x + lane) * 2;
+                const uint8_t a = row0[x0], b = row0[x0 + 1], c = row1[x0], d = row1[x0 + 1];
+
+                // Flat areas keep their index, the grid could land on a close neighbour
+                mipRow[x + lane] = a == b && a == c && a == d ? a : getNearestIndex(mipChain, steps[0][lane], steps[1][lane], steps[2][lane]);
+            }
+        }
+#endif
+
+        for(; x < mipWidth; ++x){
+            const int x0 = std::min(x * 2, width - 1);
+            const int x1 = std::min(x * 2 + 1, width - 1);
+            const uint8_t a = row0[x0], b = row0[x1], c = row1[x0], d = row1[x1];
+
+            if(a == b && a == c && a == d){
+                mipRow[x] = a;
+                continue;
+            }
+
+            // Same add order as the SIMD path
+            const glm::vec4 sum = ((mipChain.LinearColors[a] + mipChain.LinearColors[b]) + mipChain.LinearColors[c]) + mipChain.LinearColors[d];
+            mipRow[x] = getNearestIndex(mipChain, getLinearStep(sum.r), getLinearStep(sum.g), getLinearStep(sum.b));
+        }
+    }
+}
@@ -0,0 +1,498 @@
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <condition_variable>
+#include <Creepy/OcclusionCulling.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define CREEPY_X86_SIMD
+#endif
+
+// Depth is stored as 1 / w, bigger is closer and 0 is empty
+struct DepthLevel{
+    int Width{}, Height{};
+    std::vector<float> Min, Max;
+};
+
+struct OccluderQuad{
+    std::array<glm::vec3, 4> Corners;     // Map units, y up
+    glm::vec3 Center;
+    float Area{};
+};
+
+struct ScreenVertex{
+    float x, y, z;
+};
+
+constexpr int DepthWidth{256};
+constexpr int DepthHeight{128};
+constexpr int MaxOccluders{192};
+constexpr float NearW{1.0f / MapScaleFactor};     // Clip w is view depth in world units, this is 1 map unit
+constexpr float MinOccluderArea{64.0f * 64.0f};
+
+static std::vector<OccluderQuad> s_occluders;
+static std::vector<DepthLevel> s_depthLevels;
+static std::vector<uint32_t> s_occluderOrder;
+static std::vector<float> s_occluderScores;
+static OcclusionStats s_stats{};
+
+static glm::mat4 s_viewProjection{1.0f};
+static glm::vec3 s_viewPosition{};
+
+static std::mutex s_mutex;
+static std::condition_variable_any s_jobCondition;
+static std::condition_variable s_doneCondition;
+static bool s_hasJob{}, s_isDone{true}, s_isPending{};
+static std::jthread s_worker;
+
+static void workerLoop(std::stop_token stopToken);
+static void rasterizeOccluders();
+static void rasterizeQuad(const OccluderQuad& quad);
+static void rasterizePolygon(std::span<const ScreenVertex> vertices);
+static void buildPyramid();
+static bool isBoxVisible(glm::vec3 min, glm::vec3 max);
+
+void OcclusionCulling::init(const Map& map) {
+    shutdown();
+    s_occluders.clear();
+
+    auto addWall = [](glm::vec2 start, glm::vec2 end, float bottom, float top){
+        const float area = glm::distance(start, end) * (top - bottom);
+        if(area < MinOccluderArea){
+            return;
+        }
+
+        OccluderQuad quad{};
+        quad.Corners = {glm::vec3{start.x, bottom, start.y}, glm::vec3{end.x, bottom, end.y}, glm::vec3{end.x, top, end.y}, glm::vec3{start.x, top, start.y}};
+        quad.Center = (quad.Corners[0] + quad.Corners[2]) * 0.5f;
+        quad.Area = area;
+        s_occluders.push_back(quad);
+    };
+
+    for(auto&& line : map.lineDefs){
+        const glm::vec2 start = map.vertices.at(line.startIndex);
+        const glm::vec2 end = map.vertices.at(line.endIndex);
+        auto&& frontSector = map.sectors.at(map.sideDefs.at(line.frontSideDef).sectorIndex);
+
+        if(!(line.flags & std::to_underlying(LineDefFormat::TWO_SIDE))){
+            addWall(start, end, frontSector.floor, frontSector.ceiling);
+            continue;
+        }
+
+        // Step and lintel between the two sectors are solid too
+        auto&& backSector = map.sectors.at(map.sideDefs.at(line.backSideDef).sectorIndex);
+        addWall(start, end, std::min(frontSector.floor, backSector.floor), std::max(frontSector.floor, backSector.floor));
+        addWall(start, end, std::min(frontSector.ceiling, backSector.ceiling), std::max(frontSector.ceiling, backSector.ceiling));
+    }
+
+    s_occluderOrder.reserve(s_occluders.size());
+    s_occluderScores.resize(s_occluders.size());
+
+    s_depthLevels.clear();
+    for(int width{DepthWidth}, height{DepthHeight}; ; width = (width + 1) / 2, height = (height + 1) / 2){
+        auto& level = s_depthLevels.emplace_back();
+        level.Width = width;
+        level.Height = height;
+        level.Min.assign(static_cast<size_t>(width) * height, 0.0f);
+        level.Max.assign(static_cast<size_t>(width) * height, 0.0f);
+
+        if(width == 1 && height == 1){
+            break;
+        }
+    }
+
+    s_isDone = true;
+    s_isPending = false;
+    s_hasJob = false;
+    s_worker = std::jthread{workerLoop};
+}
+
+void OcclusionCulling::shutdown() {
+    if(s_worker.joinable()){
+        s_worker.request_stop();
+        s_worker.join();
+    }
+}
+
+void OcclusionCulling::beginFrame(const glm::mat4& viewProjection, glm::vec3 viewPosition) {
+    if(!s_worker.joinable() || s_isPending){
+        return;
+    }
+
+    {
+        std::lock_guard lock{s_mutex};
+        s_viewProjection = viewProjection;
+        s_viewPosition = viewPosition;
+        s_hasJob = true;
+        s_isDone = false;
+    }
+
+    s_isPending = true;
+    s_jobCondition.notify_one();
+}
+
+void OcclusionCulling::endFrame() {
+    s_stats.TestedBoxes = 0;
+    s_stats.RejectedBoxes = 0;
+
+    if(!s_isPending){
+        return;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    {
+        std::unique_lock lock{s_mutex};
+        s_doneCondition.wait(lock, []{ return s_isDone; });
+    }
+    s_isPending = false;
+
+    const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+    s_stats.WaitMicroseconds = elapsed.count();
+}
+
+void OcclusionCulling::filterVisible(const BoundsSoA& bounds, std::span<const uint32_t> indices, std::vector<uint32_t>& visibleIndices) {
+    for(auto index : indices){
+        ++s_stats.TestedBoxes;
+
+        if(isBoxVisible({bounds.MinX[index], bounds.MinY[index], bounds.MinZ[index]}, {bounds.MaxX[index], bounds.MaxY[index], bounds.MaxZ[index]})){
+            visibleIndices.push_back(index);
+        }
+        else {
+            ++s_stats.RejectedBoxes;
+        }
+    }
+}
+
+const OcclusionStats& OcclusionCulling::getStats() {
+    return s_stats;
+}
+
+void workerLoop(std::stop_token stopToken) {
+    while(true){
+        {
+            std::unique_lock lock{s_mutex};
+            if(!s_jobCondition.wait(lock, stopToken, []{ return s_hasJob; })){
+                return;
+            }
+            s_hasJob = false;
+        }
+
+        // Main thread only read the depth levels after endFrame
+        rasterizeOccluders();
+
+        {
+            std::lock_guard lock{s_mutex};
+            s_isDone = true;
+        }
+        s_doneCondition.notify_one();
+    }
+}
+
+void rasterizeOccluders() {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    auto& depth = s_depthLevels.front();
+    std::ranges::fill(depth.Max, 0.0f);
+
+    // Big and close first, area over squared distance is close to the covered screen area
+    const Frustum frustum = Frustum::fromMatrix(s_viewProjection);
+    s_occluderOrder.clear();
+
+    for(uint32_t i{}; i < s_occluders.size(); ++i){
+        const auto& quad = s_occluders[i];
+        if(!frustum.isBoxVisible(glm::min(quad.Corners[0], quad.Corners[2]), glm::max(quad.Corners[0], quad.Corners[2]))){
+            continue;
+        }
+
+        const glm::vec3 delta = quad.Center - s_viewPosition;
+        s_occluderScores[i] = quad.Area / (glm::dot(delta, delta) + 1.0f);
+        s_occluderOrder.push_back(i);
+    }
+
+    const size_t numOccluders = std::min<size_t>(s_occluderOrder.size(), MaxOccluders);
+    std::ranges::nth_element(s_occluderOrder, s_occluderOrder.begin() + numOccluders, [](uint32_t a, uint32_t b){
+        return s_occluderScores[a] > s_occluderScores[b];
+    });
+
+    s_stats.Occluders = static_cast<uint32_t>(numOccluders);
+    s_stats.OccluderTriangles = 0;
+
+    for(size_t i{}; i < numOccluders; ++i){
+        rasterizeQuad(s_occluders[s_occluderOrder[i]]);
+    }
+
+    buildPyramid();
+
+    const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+    s_stats.RasterMicroseconds = elapsed.count();
+}
+
+void rasterizeQuad(const OccluderQuad& quad) {
+    // Clip against w = NearW, a quad stay a convex polygon of at most 5 vertices
+    std::array<glm::vec4, 8> clipped;
+    size_t numClipped{};
+
+    for(size_t i{}; i < quad.Corners.size(); ++i){
+        const glm::vec4 current = s_viewProjection * glm::vec4{quad.Corners[i], 1.0f};
+        const glm::vec4 next = s_viewProjection * glm::vec4{quad.Corners[(i + 1) % quad.Corners.size()], 1.0f};
+
+        if(current.w >= NearW){
+            clipped[numClipped++] = current;
+        }
+
+        if((current.w >= NearW) != (next.w >= NearW)){
+            const float t = (NearW - current.w) / (next.w - current.w);
+            clipped[numClipped++] = current + (next - current) * t;
+        }
+    }
+
+    if(numClipped < 3){
+        return;
+    }
+
+    std::array<ScreenVertex, 8> screen;
+    for(size_t i{}; i < numClipped; ++i){
+        const float inverseW = 1.0f / clipped[i].w;
+        screen[i] = {
+            (clipped[i].x * inverseW * 0.5f + 0.5f) * DepthWidth,
+            (clipped[i].y * inverseW * 0.5f + 0.5f) * DepthHeight,
+            inverseW
+        };
+    }
+
+    // Whole polygon at once, split triangles would lose the pixels along the shared edge
+    rasterizePolygon(std::span{screen.data(), numClipped});
+    s_stats.OccluderTriangles += static_cast<uint32_t>(numClipped - 2);
+}
+
+void rasterizePolygon(std::span<const ScreenVertex> vertices) {
+    const size_t numVertices = vertices.size();
+
+    // Signed area, walls occlude from both sides so flip edges to one winding
+    float area{};
+    for(size_t i{}; i < numVertices; ++i){
+        const auto& start = vertices[i];
+        const auto& end = vertices[(i + 1) % numVertices];
+        area += start.x * end.y - start.y * end.x;
+    }
+
+    if(std::abs(area) < 1e-6f){
+        return;
+    }
+
+    const float winding = area > 0.0f ? 1.0f : -1.0f;
+
+    float minX{std::numeric_limits<float>::max()}, minY{std::numeric_limits<float>::max()};
+    float maxX{-std::numeric_limits<float>::max()}, maxY{-std::numeric_limits<float>::max()};
+    float depthFloor{std::numeric_limits<float>::max()};
+
+    for(auto&& vertex : vertices){
+        minX = std::min(minX, vertex.x);
+        maxX = std::max(maxX, vertex.x);
+        minY = std::min(minY, vertex.y);
+        maxY = std::max(maxY, vertex.y);
+        depthFloor = std::min(depthFloor, vertex.z);
+    }
+
+    const int firstX = std::max(0, static_cast<int>(std::floor(minX)));
+    const int lastX = std::min(DepthWidth - 1, static_cast<int>(std::ceil(maxX)));
+    const int firstY = std::max(0, static_cast<int>(std::floor(minY)));
+    const int lastY = std::min(DepthHeight - 1, static_cast<int>(std::ceil(maxY)));
+
+    if(firstX > lastX || firstY > lastY){
+        return;
+    }
+
+    // Edge function E(x, y) = A * x + B * y + C, inside when all >= 0
+    std::array<float, 8> edgeA, edgeB, edgeC;
+    for(size_t i{}; i < numVertices; ++i){
+        const auto& start = vertices[i];
+        const auto& end = vertices[(i + 1) % numVertices];
+        edgeA[i] = (start.y - end.y) * winding;
+        edgeB[i] = (end.x - start.x) * winding;
+        edgeC[i] = (start.x * end.y - start.y * end.x) * winding;
+
+        // Only count pixels fully inside, test the pixel corner closest to the edge
+        edgeC[i] -= 0.5f * (std::abs(edgeA[i]) + std::abs(edgeB[i]));
+    }
+
+    // Wall is planar and 1 / w is linear in screen space, fit the plane on the biggest fan triangle
+    size_t planeVertex{1};
+    float planeArea{};
+    for(size_t i{1}; i + 1 < numVertices; ++i){
+        const float triangleArea = std::abs((vertices[i].x - vertices[0].x) * (vertices[i + 1].y - vertices[0].y) - 
+            (vertices[i].y - vertices[0].y) * (vertices[i + 1].x - vertices[0].x));
+        if(triangleArea > planeArea){
+            planeArea = triangleArea;
+            planeVertex = i;
+        }
+    }
+
+    if(planeArea < 1e-6f){
+        return;
+    }
+
+    const auto& a = vertices[0];
+    const auto& b = vertices[planeVertex];
+    const auto& c = vertices[planeVertex + 1];
+    const float planeDenominator = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    const float depthA = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / planeDenominator;
+    const float depthB = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / planeDenominator;
+
+    // Take the farthest value over the pixel
+    const float depthC = a.z - depthA * a.x - depthB * a.y - 0.5f * (std::abs(depthA) + std::abs(depthB));
+
+    auto& depth = s_depthLevels.front().Max;
+
+#ifdef CREEPY_X86_SIMD
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const int alignedFirstX = firstX & ~3;
+
+    for(int y = firstY; y <= lastY; ++y){
+        const float centerY = static_cast<float>(y) + 0.5f;
+
+        for(int x = alignedFirstX; x <= lastX; x += 4){
+            const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(size_t i{}; i < numVertices; ++i){
+                const __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[i]), centerX), _mm_set1_ps(edgeB[i] * centerY + edgeC[i]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, zero));
+            }
+
+            if(_mm_movemask_ps(inside) == 0){
+                continue;
+            }
+
+            __m128 value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), centerX), _mm_set1_ps(depthB * centerY + depthC));
+            value = _mm_max_ps(value, _mm_set1_ps(depthFloor));
+
+            // Buffer width is a multiple of 4, a row never spill
+            float* row = depth.data() + static_cast<size_t>(y) * DepthWidth + x;
+            const __m128 current = _mm_loadu_ps(row);
+            const __m128 closer = _mm_max_ps(current, value);
+            _mm_storeu_ps(row, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, current)));
+        }
+    }
+#else
+    for(int y = firstY; y <= lastY; ++y){
+        const float centerY = static_cast<float>(y) + 0.5f;
+
+        for(int x = firstX; x <= lastX; ++x){
+            const float centerX = static_cast<float>(x) + 0.5f;
+
+            bool isInside{true};
+            for(size_t i{}; i < numVertices; ++i){
+                isInside &= edgeA[i] * centerX + edgeB[i] * centerY + edgeC[i] >= 0.0f;
+            }
+
+            if(isInside){
+                float& current = depth[static_cast<size_t>(y) * DepthWidth + x];
+                current = std::max(current, std::max(depthA * centerX + depthB * centerY + depthC, depthFloor));
+            }
+        }
+    }
+#endif
+}
+
+void buildPyramid() {
+    auto& base = s_depthLevels.front();
+    base.Min = base.Max;
+
+    for(size_t i{1}; i < s_depthLevels.size(); ++i){
+        const auto& source = s_depthLevels[i - 1];
+        auto& level = s_depthLevels[i];
+
+        for(int y{}; y < level.Height; ++y){
+            for(int x{}; x < level.Width; ++x){
+                float minValue = std::numeric_limits<float>::max();
+                float maxValue{};
+
+                // Odd size source has no last texel pair
+                for(int sy = y * 2; sy < std::min(y * 2 + 2, source.Height); ++sy){
+                    for(int sx = x * 2; sx < std::min(x * 2 + 2, source.Width); ++sx){
+                        const size_t sourceIndex = static_cast<size_t>(sy) * source.Width + sx;
+                        minValue = std::min(minValue, source.Min[sourceIndex]);
+                        maxValue = std::max(maxValue, source.Max[sourceIndex]);
+                    }
+                }
+
+                level.Min[static_cast<size_t>(y) * level.Width + x] = minValue;
+                level.Max[static_cast<size_t>(y) * level.Width + x] = maxValue;
+            }
+        }
+    }
+}
+
+bool isBoxVisible(glm::vec3 min, glm::vec3 max) {
+    if(s_depthLevels.empty()){
+        return true;
+    }
+
+    float minX{std::numeric_limits<float>::max()}, minY{std::numeric_limits<float>::max()};
+    float maxX{-std::numeric_limits<float>::max()}, maxY{-std::numeric_limits<float>::max()};
+    float nearest{};
+
+    for(int i{}; i < 8; ++i){
+        const glm::vec3 corner{(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z};
+        const glm::vec4 clip = s_viewProjection * glm::vec4{corner, 1.0f};
+
+        // Crossing the near plane, too close to judge
+        if(clip.w < NearW){
+            return true;
+        }
+
+        const float inverseW = 1.0f / clip.w;
+        const float x = (clip.x * inverseW * 0.5f + 0.5f) * DepthWidth;
+        const float y = (clip.y * inverseW * 0.5f + 0.5f) * DepthHeight;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::max(nearest, inverseW);
+    }
+
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    int x1 = std::min(DepthWidth - 1, static_cast<int>(std::floor(maxX)));
+    int y1 = std::min(DepthHeight - 1, static_cast<int>(std::floor(maxY)));
+
+    // Off screen, frustum test own that
+    if(x0 > x1 || y0 > y1){
+        return true;
+    }
+
+    // Coarsest level first can accept early, then the level where the box cover at most 2x2 texels decide
+    const auto& top = s_depthLevels.back();
+    if(nearest > top.Max.front()){
+        return true;
+    }
+
+    size_t levelIndex{};
+    while(levelIndex + 1 < s_depthLevels.size() && std::max(x1 - x0, y1 - y0) > 1){
+        x0 >>= 1;
+        y0 >>= 1;
+        x1 >>= 1;
+        y1 >>= 1;
+        ++levelIndex;
+    }
+
+    const auto& level = s_depthLevels[levelIndex];
+    for(int y = y0; y <= y1; ++y){
+        for(int x = x0; x <= x1; ++x){
+            // Some texel under the box has an occluder farther than the box, or nothing at all
+            if(nearest >= level.Min[static_cast<size_t>(y) * level.Width + x]){
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
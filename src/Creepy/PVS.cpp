@@ -0,0 +1,318 @@
+#include <print>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <utility>
+#include <cstring>
+#include <Creepy/PVS.hpp>
+#include <Creepy/Portal.hpp>
+
+struct FlowContext{
+    const PortalGraph* graph;
+    const std::vector<std::vector<uint64_t>>* portalMightSee;   // Per portal side, see getLinkIndex
+    std::vector<uint8_t> visible;                               // Padded to whole words while flowing
+    std::vector<uint8_t> onStack;
+    std::vector<std::vector<uint64_t>> pathMightSee;            // Per depth, never resized while flowing
+    uint32_t steps{};
+};
+
+constexpr float ClipEpsilon{0.1f};          // Map units
+constexpr uint32_t MaxFlowSteps{1u << 20};  // Per source sector, then fall back to plain flood
+
+static bool clipToLeftSide(PortalSegment& segment, glm::vec2 lineStart, glm::vec2 lineEnd);
+static bool clipToSeparators(PortalSegment& target, const PortalSegment& source, const PortalSegment& pass);
+static uint32_t getLinkIndex(const PortalLink& link);
+static void floodMightSee(const PortalGraph& graph, const PortalLink& link, std::vector<uint64_t>& mightSee, std::vector<uint16_t>& queue, std::vector<uint8_t>& visited);
+static void flowThrough(FlowContext& context, uint16_t sector, const PortalSegment& source, const PortalSegment& pass, uint32_t fromPortal, bool isFirst, const std::vector<uint64_t>& mightSee, uint32_t depth);
+static void floodFill(FlowContext& context, uint16_t sector);
+static void markVisible(std::vector<uint8_t>& bits, uint32_t sector);
+
+PVS PVS::compute(const Map& map) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const uint32_t numSectors = static_cast<uint32_t>(map.sectors.size());
+
+    const PortalGraph graph = PortalGraph::build(map);
+
+    const uint32_t rowBytes = (numSectors + 7) / 8;
+    std::vector<std::vector<uint8_t>> rows(numSectors);
+
+    const auto runWorkers = [](auto&& work){
+        std::vector<std::jthread> workers;
+        const uint32_t numWorkers = std::max(1u, std::thread::hardware_concurrency());
+        for(uint32_t i{}; i < numWorkers; ++i){
+            workers.emplace_back(work);
+        }
+    };
+
+    // Sectors each portal side could ever see like vis's BasePortalVis, the flow stop on a path
+    // once everything it might still reach is already visible
+    std::vector<std::vector<uint64_t>> portalMightSee(graph.portals.size() * 2);
+    std::atomic<uint32_t> nextBaseSector{0};
+
+    runWorkers([&]{
+        std::vector<uint16_t> queue;
+        std::vector<uint8_t> visited;
+
+        for(uint32_t sector = nextBaseSector++; sector < numSectors; sector = nextBaseSector++){
+            for(auto&& link : graph.links[sector]){
+                floodMightSee(graph, link, portalMightSee[getLinkIndex(link)], queue, visited);
+            }
+        }
+    });
+
+    std::atomic<uint32_t> nextSector{0};
+
+    runWorkers([&]{
+        FlowContext context{};
+        context.graph = &graph;
+        context.portalMightSee = &portalMightSee;
+        context.pathMightSee.resize(numSectors + 1);
+
+        for(uint32_t sector = nextSector++; sector < numSectors; sector = nextSector++){
+            context.visible.assign((numSectors + 63) / 64 * 8, 0);
+            context.onStack.assign(numSectors, 0);
+            context.steps = 0;
+
+            markVisible(context.visible, sector);
+            context.onStack[sector] = 1;
+
+            for(auto&& link : graph.links[sector]){
+                const PortalSegment source = graph.getSegment(link);
+                flowThrough(context, link.nextSector, source, source, link.portal, true, portalMightSee[getLinkIndex(link)], 0);
+            }
+
+            if(context.steps >= MaxFlowSteps){
+                std::println("PVS Sector {} Hit Step Limit, Use Flood Fill", sector);
+                floodFill(context, static_cast<uint16_t>(sector));
+            }
+
+            context.visible.resize(rowBytes);
+            rows[sector] = std::move(context.visible);
+        }
+    });
+
+    PVS pvs{};
+    pvs.NumSectors = numSectors;
+    pvs.RowOffsets.reserve(numSectors);
+
+    // Quake style compression, zero bytes become (0, count)
+    for(auto&& row : rows){
+        pvs.RowOffsets.push_back(static_cast<uint32_t>(pvs.Data.size()));
+
+        for(uint32_t i{}; i < rowBytes; ++i){
+            if(row[i] != 0){
+                pvs.Data.push_back(row[i]);
+                continue;
+            }
+
+            uint32_t count{1};
+            while(i + 1 < rowBytes && row[i + 1] == 0 && count < 255){
+                ++count;
+                ++i;
+            }
+
+            pvs.Data.push_back(0);
+            pvs.Data.push_back(static_cast<uint8_t>(count));
+        }
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::println("PVS: {} Sectors, {} Portals, {} Bytes In {:.3f} ms", numSectors, graph.portals.size(), pvs.Data.size(), elapsed.count());
+
+    return pvs;
+}
+
+void PVS::decompressRow(uint32_t sector, std::vector<uint8_t>& bits) const {
+    const uint32_t rowBytes = (NumSectors + 7) / 8;
+
+    // Unknown row see everything, a cut short row keep what it has
+    if(sector >= RowOffsets.size()){
+        bits.assign(rowBytes, 0xFF);
+        return;
+    }
+
+    bits.assign(rowBytes, 0);
+
+    for(size_t i = RowOffsets[sector], j{}; j < rowBytes && i < Data.size(); ++i){
+        if(Data[i] != 0){
+            bits[j++] = Data[i];
+            continue;
+        }
+
+        if(i + 1 >= Data.size()){
+            break;
+        }
+        j += Data[++i];
+    }
+}
+
+bool PVS::isEmpty() const {
+    return NumSectors == 0;
+}
+
+bool clipToLeftSide(PortalSegment& segment, glm::vec2 lineStart, glm::vec2 lineEnd) {
+    const glm::vec2 direction = lineEnd - lineStart;
+    const float length = glm::length(direction);
+    if(length <= 0.0f){
+        return false;
+    }
+
+    const glm::vec2 normal = glm::vec2{-direction.y, direction.x} / length;     // Point to the left
+    const float startDistance = glm::dot(segment.start - lineStart, normal);
+    const float endDistance = glm::dot(segment.end - lineStart, normal);
+
+    if(startDistance < -ClipEpsilon && endDistance < -ClipEpsilon){
+        return false;
+    }
+
+    if(startDistance < -ClipEpsilon){
+        segment.start += (segment.end - segment.start) * (startDistance / (startDistance - endDistance));
+    }
+    else if(endDistance < -ClipEpsilon){
+        segment.end += (segment.start - segment.end) * (endDistance / (endDistance - startDistance));
+    }
+
+    return glm::distance(segment.start, segment.end) > ClipEpsilon;
+}
+
+bool clipToSeparators(PortalSegment& target, const PortalSegment& source, const PortalSegment& pass) {
+    const glm::vec2 sourcePoints[]{source.start, source.end};
+    const glm::vec2 passPoints[]{pass.start, pass.end};
+
+    // Line through one source and one pass endpoint that keep the source and the pass
+    // on opposite sides bound the region seen through both
+    for(int i{}; i < 2; ++i){
+        for(int j{}; j < 2; ++j){
+            const glm::vec2 lineStart = sourcePoints[i];
+            const glm::vec2 lineEnd = passPoints[j];
+            const glm::vec2 direction = lineEnd - lineStart;
+
+            if(glm::length(direction) <= ClipEpsilon){
+                continue;
+            }
+
+            const glm::vec2 otherSource = sourcePoints[i ^ 1] - lineStart;
+            const glm::vec2 otherPass = passPoints[j ^ 1] - lineStart;
+            const float sourceSide = direction.x * otherSource.y - direction.y * otherSource.x;
+            const float passSide = direction.x * otherPass.y - direction.y * otherPass.x;
+
+            if(sourceSide * passSide >= 0.0f || passSide == 0.0f){
+                continue;
+            }
+
+            // Keep the pass side
+            const bool isPassOnLeft = passSide > 0.0f;
+            if(!(isPassOnLeft ? clipToLeftSide(target, lineStart, lineEnd) : clipToLeftSide(target, lineEnd, lineStart))){
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+uint32_t getLinkIndex(const PortalLink& link) {
+    return link.portal * 2 + (link.isReversed ? 1 : 0);
+}
+
+// Flood from the next sector through portals with some part beyond this one
+// A real sight line through the portal stay on its far side, so this hold all it can see
+void floodMightSee(const PortalGraph& graph, const PortalLink& link, std::vector<uint64_t>& mightSee, std::vector<uint16_t>& queue, std::vector<uint8_t>& visited) {
+    const PortalSegment base = graph.getSegment(link);
+    mightSee.assign((graph.links.size() + 63) / 64, 0);
+    visited.assign(graph.links.size(), 0);
+
+    queue.assign(1, link.nextSector);
+    visited[link.nextSector] = 1;
+
+    while(!queue.empty()){
+        const uint16_t current = queue.back();
+        queue.pop_back();
+        mightSee[current >> 6] |= uint64_t{1} << (current & 63);
+
+        for(auto&& next : graph.links[current]){
+            if(next.portal == link.portal || visited[next.nextSector]){
+                continue;
+            }
+
+            PortalSegment target = graph.getSegment(next);
+            if(!clipToLeftSide(target, base.start, base.end)){
+                continue;
+            }
+
+            visited[next.nextSector] = 1;
+            queue.push_back(next.nextSector);
+        }
+    }
+}
+
+void flowThrough(FlowContext& context, uint16_t sector, const PortalSegment& source, const PortalSegment& pass, uint32_t fromPortal, bool isFirst, const std::vector<uint64_t>& mightSee, uint32_t depth) {
+    if(++context.steps >= MaxFlowSteps){
+        return;
+    }
+
+    markVisible(context.visible, sector);
+    context.onStack[sector] = 1;
+
+    // Depth stay below the sector count, onStack stop a path from coming back
+    auto& nextMightSee = context.pathMightSee[depth + 1];
+
+    for(auto&& link : context.graph->links[sector]){
+        if(link.portal == fromPortal || context.onStack[link.nextSector]){
+            continue;
+        }
+
+        PortalSegment target = context.graph->getSegment(link);
+
+        // Must lie beyond the source and the pass portal
+        if(!clipToLeftSide(target, source.start, source.end)){
+            continue;
+        }
+
+        if(!isFirst && (!clipToLeftSide(target, pass.start, pass.end) || !clipToSeparators(target, source, pass))){
+            continue;
+        }
+
+        // Nothing new down this portal, every sector it might reach is already marked
+        const auto& portalMightSee = (*context.portalMightSee)[getLinkIndex(link)];
+        nextMightSee.resize(mightSee.size());
+        bool hasMore{false};
+        for(size_t i{}; i < mightSee.size(); ++i){
+            uint64_t visible;
+            std::memcpy(&visible, context.visible.data() + i * 8, 8);       // Little endian, bit order match
+            nextMightSee[i] = mightSee[i] & portalMightSee[i];
+            hasMore |= (nextMightSee[i] & ~visible) != 0;
+        }
+
+        if(!hasMore){
+            continue;
+        }
+
+        flowThrough(context, link.nextSector, source, target, link.portal, false, nextMightSee, depth + 1);
+    }
+
+    context.onStack[sector] = 0;
+}
+
+void floodFill(FlowContext& context, uint16_t sector) {
+    std::vector<uint16_t> queue{sector};
+    std::vector<uint8_t> visited(context.graph->links.size(), 0);
+    visited[sector] = 1;
+
+    while(!queue.empty()){
+        const uint16_t current = queue.back();
+        queue.pop_back();
+        markVisible(context.visible, current);
+
+        for(auto&& link : context.graph->links[current]){
+            if(!visited[link.nextSector]){
+                visited[link.nextSector] = 1;
+                queue.push_back(link.nextSector);
+            }
+        }
+    }
+}
+
+void markVisible(std::vector<uint8_t>& bits, uint32_t sector) {
+    bits[sector >> 3] |= static_cast<uint8_t>(1u << (sector & 7));
+}
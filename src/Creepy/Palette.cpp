@@ -0,0 +1,21 @@
+#include <Creepy/Palette.hpp>
+
+Palette Palette::makeFallback() {
+    Palette palette{};
+    for(int i{}; i < 256; ++i){
+        palette.Colors[i] = glm::u8vec3{static_cast<uint8_t>(i)};
+    }
+    return palette;
+}
+
+ColorMap ColorMap::makeFallback() {
+    // Gray palette, index is intensity so darken by scaling the index
+    ColorMap colorMap{};
+    for(int level{}; level < NumColorMaps; ++level){
+        const int brightness = level < NumLightLevels ? NumLightLevels - level : 0;
+        for(int i{}; i < 256; ++i){
+            colorMap.Maps[level][i] = static_cast<uint8_t>(i * brightness / NumLightLevels);
+        }
+    }
+    return colorMap;
+}
@@ -0,0 +1,38 @@
+#include <utility>
+#include <Creepy/Portal.hpp>
+
+PortalGraph PortalGraph::build(const Map& map) {
+    PortalGraph graph{};
+    graph.links.resize(map.sectors.size());
+
+    for(uint32_t lineIndex{}; lineIndex < map.lineDefs.size(); ++lineIndex){
+        auto&& line = map.lineDefs[lineIndex];
+
+        if(!(line.flags & std::to_underlying(LineDefFormat::TWO_SIDE))){
+            continue;
+        }
+
+        const uint16_t frontSector = map.sideDefs.at(line.frontSideDef).sectorIndex;
+        const uint16_t backSector = map.sideDefs.at(line.backSideDef).sectorIndex;
+
+        // Self referencing line is not a way out of the sector
+        if(frontSector == backSector){
+            continue;
+        }
+
+        const uint32_t portalIndex = static_cast<uint32_t>(graph.portals.size());
+        graph.portals.push_back({map.vertices.at(line.startIndex), map.vertices.at(line.endIndex), {frontSector, backSector}});
+        graph.lineDefs.push_back(lineIndex);
+        graph.links.at(frontSector).push_back({portalIndex, backSector, false});
+        graph.links.at(backSector).push_back({portalIndex, frontSector, true});
+    }
+
+    return graph;
+}
+
+PortalSegment PortalGraph::getSegment(const PortalLink& link) const {
+    const auto& portal = portals[link.portal];
+
+    // Line front side is on the right, going front to back the next sector is on the left
+    return link.isReversed ? PortalSegment{portal.end, portal.start} : PortalSegment{portal.start, portal.end};
+}
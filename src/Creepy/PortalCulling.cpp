@@ -0,0 +1,228 @@
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <Creepy/PortalCulling.hpp>
+#include <Creepy/Portal.hpp>
+#include <Creepy/PVS.hpp>
+
+// 2D cone from the view point, Left is counter clockwise of Right and the cone is under 180 degree
+struct ViewCone{
+    glm::vec2 Right{}, Left{};
+    bool IsFull{};
+
+    bool contains(glm::vec2 direction) const;
+    bool contains(const ViewCone& other) const;
+};
+
+struct ConeWork{
+    uint16_t sector;
+    ViewCone cone;
+};
+
+constexpr float ConeEpsilon{1e-5f};
+constexpr float PortalNearDistance{1.0f};   // Map units, view standing in the portal see through it whole
+
+static const Map* s_map{nullptr};
+static PortalGraph s_graph{};
+
+static std::vector<uint8_t> s_visibleSectors;
+static uint32_t s_numVisibleSectors{};
+static std::vector<ViewCone> s_sectorCones;
+static std::vector<uint8_t> s_hasCone;
+static std::vector<ConeWork> s_work;
+
+static float cross(glm::vec2 a, glm::vec2 b);
+static float counterClockwiseAngle(glm::vec2 from, glm::vec2 to);
+static bool intersectCones(const ViewCone& a, const ViewCone& b, ViewCone& result);
+static ViewCone mergeCones(const ViewCone& a, const ViewCone& b);
+static bool isPortalOpen(const Portal& portal);
+
+void PortalCulling::init(const Map& map) {
+    s_map = &map;
+    s_graph = PortalGraph::build(map);
+    s_visibleSectors.assign((map.sectors.size() + 7) / 8, 0);
+    s_sectorCones.resize(map.sectors.size());
+    s_hasCone.assign(map.sectors.size(), 0);
+    s_work.reserve(map.sectors.size());
+}
+
+uint32_t PortalCulling::update(glm::vec2 viewPoint, glm::vec2 forward, float tanHalfAngle, uint16_t viewSector, const std::vector<uint8_t>* pvsRow) {
+    std::ranges::fill(s_visibleSectors, uint8_t{0});
+    std::ranges::fill(s_hasCone, uint8_t{0});
+    s_work.clear();
+
+    ViewCone viewCone{};
+    if(tanHalfAngle > 0.0f && glm::length(forward) > 1e-4f){
+        const glm::vec2 front = glm::normalize(forward);
+        const glm::vec2 right{front.y, -front.x};
+        viewCone.Right = glm::normalize(front + right * tanHalfAngle);
+        viewCone.Left = glm::normalize(front - right * tanHalfAngle);
+    }
+    else {
+        viewCone.IsFull = true;
+    }
+
+    s_sectorCones[viewSector] = viewCone;
+    s_hasCone[viewSector] = 1;
+    s_visibleSectors[viewSector >> 3] |= static_cast<uint8_t>(1u << (viewSector & 7));
+    s_numVisibleSectors = 1;
+    s_work.push_back({viewSector, viewCone});
+
+    // Sector cone only grow, the budget only guard against float creep
+    uint32_t crossedPortals{};
+    const uint32_t maxCrossedPortals = static_cast<uint32_t>(s_graph.portals.size()) * 8 + 64;
+
+    while(!s_work.empty() && crossedPortals < maxCrossedPortals){
+        const ConeWork work = s_work.back();
+        s_work.pop_back();
+
+        for(auto&& link : s_graph.links[work.sector]){
+            const uint16_t nextSector = link.nextSector;
+
+            if(pvsRow != nullptr && !isSectorVisible(*pvsRow, nextSector)){
+                continue;
+            }
+
+            if(!isPortalOpen(s_graph.portals[link.portal])){
+                continue;
+            }
+
+            const PortalSegment segment = s_graph.getSegment(link);
+            const glm::vec2 direction = segment.end - segment.start;
+            const float length = glm::length(direction);
+            if(length <= 0.0f){
+                continue;
+            }
+
+            // View must be on the right, the side we came from
+            const float viewDistance = cross(direction, viewPoint - segment.start) / length;
+
+            ViewCone nextCone{};
+            if(std::abs(viewDistance) < PortalNearDistance){
+                nextCone = work.cone;
+            }
+            else if(viewDistance > 0.0f){
+                continue;
+            }
+            else {
+                const ViewCone portalCone{glm::normalize(segment.end - viewPoint), glm::normalize(segment.start - viewPoint)};
+                if(!intersectCones(work.cone, portalCone, nextCone)){
+                    continue;
+                }
+            }
+
+            ++crossedPortals;
+
+            if(!s_hasCone[nextSector]){
+                s_hasCone[nextSector] = 1;
+                s_sectorCones[nextSector] = nextCone;
+                s_visibleSectors[nextSector >> 3] |= static_cast<uint8_t>(1u << (nextSector & 7));
+                ++s_numVisibleSectors;
+            }
+            else if(s_sectorCones[nextSector].contains(nextCone)){
+                continue;
+            }
+            else {
+                // Conservative hull keep one cone per sector and bound the walk
+                s_sectorCones[nextSector] = mergeCones(s_sectorCones[nextSector], nextCone);
+            }
+
+            s_work.push_back({nextSector, s_sectorCones[nextSector]});
+        }
+    }
+
+    return crossedPortals;
+}
+
+const std::vector<uint8_t>& PortalCulling::getVisibleSectors() {
+    return s_visibleSectors;
+}
+
+uint32_t PortalCulling::getNumVisibleSectors() {
+    return s_numVisibleSectors;
+}
+
+bool ViewCone::contains(glm::vec2 direction) const {
+    return IsFull || (cross(Right, direction) >= -ConeEpsilon && cross(direction, Left) >= -ConeEpsilon);
+}
+
+bool ViewCone::contains(const ViewCone& other) const {
+    if(IsFull){
+        return true;
+    }
+
+    return !other.IsFull && contains(other.Right) && contains(other.Left);
+}
+
+float cross(glm::vec2 a, glm::vec2 b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+float counterClockwiseAngle(glm::vec2 from, glm::vec2 to) {
+    const float angle = std::atan2(cross(from, to), glm::dot(from, to));
+    return angle < -ConeEpsilon ? angle + 2.0f * std::numbers::pi_v<float> : std::max(angle, 0.0f);
+}
+
+bool intersectCones(const ViewCone& a, const ViewCone& b, ViewCone& result) {
+    if(a.IsFull || b.IsFull){
+        result = a.IsFull ? b : a;
+        return true;
+    }
+
+    // Intersection of two convex cones is convex, each edge come from whichever cone it lie inside
+    result.IsFull = false;
+
+    if(a.contains(b.Right)){
+        result.Right = b.Right;
+    }
+    else if(b.contains(a.Right)){
+        result.Right = a.Right;
+    }
+    else {
+        return false;
+    }
+
+    if(a.contains(b.Left)){
+        result.Left = b.Left;
+    }
+    else if(b.contains(a.Left)){
+        result.Left = a.Left;
+    }
+    else {
+        return false;
+    }
+
+    return cross(result.Right, result.Left) > ConeEpsilon;
+}
+
+ViewCone mergeCones(const ViewCone& a, const ViewCone& b) {
+    if(a.IsFull || b.IsFull){
+        return ViewCone{.IsFull = true};
+    }
+
+    // Smallest arc holding both, starting from either right edge
+    const float spanA = counterClockwiseAngle(a.Right, a.Left);
+    const float spanB = counterClockwiseAngle(b.Right, b.Left);
+    const float endB = counterClockwiseAngle(a.Right, b.Right) + spanB;
+    const float endA = counterClockwiseAngle(b.Right, a.Right) + spanA;
+    const float arcFromA = std::max(spanA, endB);
+    const float arcFromB = std::max(spanB, endA);
+
+    if(std::min(arcFromA, arcFromB) >= std::numbers::pi_v<float> - 1e-3f){
+        return ViewCone{.IsFull = true};
+    }
+
+    if(arcFromA <= arcFromB){
+        return ViewCone{a.Right, spanA >= endB ? a.Left : b.Left};
+    }
+
+    return ViewCone{b.Right, spanB >= endA ? b.Left : a.Left};
+}
+
+bool isPortalOpen(const Portal& portal) {
+    auto&& frontSector = s_map->sectors[portal.sectors[0]];
+    auto&& backSector = s_map->sectors[portal.sectors[1]];
+
+    // Closed door or lift
+    return std::max(frontSector.floor, backSector.floor) < std::min(frontSector.ceiling, backSector.ceiling);
+}
@@ -1,22 +1,77 @@
 #include <print>
 #include <cmath>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
 #include <Creepy/Renderer.hpp>
 #include <Creepy/Utils.hpp>
 #include <Creepy/Mesh.hpp>
+#include <Creepy/Texture.hpp>
+#include <Creepy/Palette.hpp>
+#include <Creepy/Sprites.hpp>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 
 float s_width{}, s_height{};
-GLuint s_program{};
-GLuint s_modelMatrixLocation{};
-GLuint s_viewMatrixLocation{};
-GLuint s_projectionMatrixLocation{};
-GLuint s_colorLocation{};
+const ShaderProgram* s_activeProgram{nullptr};
+ShaderFeature s_shaderFeatures{ShaderFeature::NONE};
 Mesh s_quadMesh{};
 
+glm::mat4 s_viewMatrix{1.0f}, s_projectionMatrix{1.0f};
+
+std::vector<GLsizei> s_rangeCounts;
+std::vector<const void*> s_rangeOffsets;
+
+GLuint s_blitProgram{};
+GLuint s_blitTexture{};
+GLuint s_blitVAO{};
+glm::ivec2 s_blitSize{};
+
+// Units match the bindings in fragment.frag, blit own unit 0
+constexpr GLuint IndexTextureUnit{1};
+constexpr GLuint PaletteTextureUnit{2};
+constexpr GLuint ColorMapTextureUnit{3};
+GLuint s_paletteTexture{};
+GLuint s_colorMapTexture{};
+
+// Sprites draw with their own program like blit, palette units are shared with fragment.frag
+constexpr GLuint SpriteAtlasUnit{4};
+constexpr GLuint SpriteImagesBinding{0};
+constexpr GLuint SpriteFramesBinding{1};
+constexpr GLint SpriteEyeLocation{4};
+GLuint s_spriteProgram{};
+GLuint s_spriteVAO{};
+GLuint s_spriteInstanceBuffer{};
+GLuint s_spriteCommandBuffer{};
+GLsizeiptr s_spriteCommandCapacity{};
+std::vector<SpriteRange> s_spriteCommandRanges;        // What the command buffer hold, rewritten only when visibility change
+GLuint s_spriteAtlasTexture{};
+GLuint s_spriteImageBuffer{};
+GLuint s_spriteFrameBuffer{};
+
+// TextureRemap block of fragment.frag, bound once and rewritten when an animation step
+constexpr GLuint TextureRemapBinding{0};
+GLuint s_textureRemapBuffer{};
+
+// Layout glMultiDrawArraysIndirect read
+struct DrawArraysIndirectCommand{
+    uint32_t Count{}, InstanceCount{}, First{}, BaseInstance{};
+};
+
+// std430 layout of SpriteImages in sprite.vert
+struct GPUSpriteImage{
+    glm::ivec4 Rect;            // Atlas x y, width height
+    glm::ivec2 Offset;          // Left, top
+    glm::ivec2 Padding;
+};
+
 static void initShaders();
+static void useProgram(const ShaderProgram& program);
 static void initQuad();
+static void initBlit();
+static void initSprites();
+static void initTextureRemap();
 
 void Renderer::initRenderer(int width, int height) {
     s_width = static_cast<float>(width);
@@ -27,44 +82,99 @@ void Renderer::initRenderer(int width, int height) {
 
     initShaders();
     initQuad();
+    initBlit();
+    initSprites();
+    initTextureRemap();
 }
 
 void Renderer::clearRenderer() {
+    // Swap in the requested variant once the worker finished it
+    if(const auto& program = ShaderPermutations::getProgram(s_shaderFeatures); &program != s_activeProgram){
+        useProgram(program);
+    }
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void Renderer::setViewMatrix(const glm::mat4& viewMatrix) {
-    glUniformMatrix4fv(s_viewMatrixLocation, 1, GL_FALSE, glm::value_ptr(viewMatrix));
+    s_viewMatrix = viewMatrix;
+    glUniformMatrix4fv(ViewMatrixLocation, 1, GL_FALSE, glm::value_ptr(viewMatrix));
 }
 
 void Renderer::setProjectionMatrix(const glm::mat4& projectionMatrix) {
-    glUniformMatrix4fv(s_projectionMatrixLocation, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
+    s_projectionMatrix = projectionMatrix;
+    glUniformMatrix4fv(ProjectionMatrixLocation, 1, GL_FALSE, glm::value_ptr(projectionMatrix));
+}
+
+void Renderer::setShaderFeatures(ShaderFeature features) {
+    s_shaderFeatures = features;
+    ShaderPermutations::request(features);
 }
 
 glm::ivec2 Renderer::getSize() {
     return {s_width, s_height};
 }
 
-void initShaders() {
-    const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, readShaderFile("./res/shader/vertex.vert"));
-    const GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, readShaderFile("./res/shader/fragment.frag"));
+void Renderer::setPalette(const Palette& palette, const ColorMap& colorMap) {
+    if(s_paletteTexture == 0){
+        glCreateTextures(GL_TEXTURE_2D, 1, &s_paletteTexture);
+        glTextureStorage2D(s_paletteTexture, 1, GL_RGBA8, static_cast<GLsizei>(palette.Colors.size()), 1);
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &s_colorMapTexture);
+        glTextureStorage2D(s_colorMapTexture, 1, GL_R8UI, static_cast<GLsizei>(colorMap.Maps.front().size()), NumColorMaps);
+
+        // Integer textures with a linear or mipmap filter are incomplete and fetch 0
+        for(GLuint texture : {s_paletteTexture, s_colorMapTexture}){
+            glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+    }
+
+    std::vector<glm::u8vec4> colors;
+    colors.reserve(palette.Colors.size());
+    for(auto&& color : palette.Colors){
+        colors.emplace_back(color, 255);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(s_paletteTexture, 0, 0, 0, static_cast<GLsizei>(colors.size()), 1, GL_RGBA, GL_UNSIGNED_BYTE, colors.data());
+    glTextureSubImage2D(s_colorMapTexture, 0, 0, 0, static_cast<GLsizei>(colorMap.Maps.front().size()), NumColorMaps, GL_RED_INTEGER, GL_UNSIGNED_BYTE, colorMap.Maps.data());
+
+    glBindTextureUnit(PaletteTextureUnit, s_paletteTexture);
+    glBindTextureUnit(ColorMapTextureUnit, s_colorMapTexture);
+}
 
-    s_program = linkProgram(std::array{vertexShader, fragmentShader});
+void Renderer::bindTexture(const TextureArray& textureArray) {
+    glBindTextureUnit(IndexTextureUnit, textureArray.Id);
+}
 
-    glUseProgram(s_program);
+void Renderer::setTextureRemap(std::span<const uint32_t> slotLayers) {
+    if(slotLayers.size() > MaxTextureSlots){
+        std::println("Texture Slots: {} Over {}, Extra Ones Draw The Placeholder", slotLayers.size(), MaxTextureSlots);
+    }
 
-    s_modelMatrixLocation = glGetUniformLocation(s_program, "modelMatrix");
-    s_viewMatrixLocation = glGetUniformLocation(s_program, "viewMatrix");
-    s_projectionMatrixLocation = glGetUniformLocation(s_program, "projectionMatrix");
-    s_colorLocation = glGetUniformLocation(s_program, "myColor");
+    glNamedBufferSubData(s_textureRemapBuffer, 0, std::min(slotLayers.size(), MaxTextureSlots) * sizeof(uint32_t), slotLayers.data());
+}
+
+void initShaders() {
+    useProgram(ShaderPermutations::getProgram(s_shaderFeatures));
+}
+
+void useProgram(const ShaderProgram& program) {
+    s_activeProgram = &program;
+    glUseProgram(program.Program);
+
+    // Matrices are per program state, restore them after switch
+    glUniformMatrix4fv(ViewMatrixLocation, 1, GL_FALSE, glm::value_ptr(s_viewMatrix));
+    glUniformMatrix4fv(ProjectionMatrixLocation, 1, GL_FALSE, glm::value_ptr(s_projectionMatrix));
 }
 
 void initQuad() {
     constexpr Vertex vertices[]{
-        glm::vec3{1.0f, 1.0f, 0.0f},
-        glm::vec3{0.0f, 1.0f, 0.0f},
-        glm::vec3{0.0f, 0.0f, 0.0f},
-        glm::vec3{1.0f, 0.0f, 0.0f}
+        Vertex{glm::vec3{1.0f, 1.0f, 0.0f}},
+        Vertex{glm::vec3{0.0f, 1.0f, 0.0f}},
+        Vertex{glm::vec3{0.0f, 0.0f, 0.0f}},
+        Vertex{glm::vec3{1.0f, 0.0f, 0.0f}}
     };
 
     constexpr uint32_t indices[]{
@@ -75,6 +185,146 @@ void initQuad() {
     s_quadMesh = Mesh::createMesh(vertices, indices);
 }
 
+void initBlit() {
+    const GLuint shaders[]{
+        compileShader(GL_VERTEX_SHADER, readShaderFile("./res/shader/blit.vert")),
+        compileShader(GL_FRAGMENT_SHADER, readShaderFile("./res/shader/blit.frag"))
+    };
+
+    s_blitProgram = linkProgram(shaders);
+
+    for(auto shader : shaders){
+        glDeleteShader(shader);
+    }
+
+    // Core profile need a bound VAO even without attributes
+    glCreateVertexArrays(1, &s_blitVAO);
+}
+
+void initSprites() {
+    const GLuint shaders[]{
+        compileShader(GL_VERTEX_SHADER, readShaderFile("./res/shader/sprite.vert")),
+        compileShader(GL_FRAGMENT_SHADER, readShaderFile("./res/shader/sprite.frag"))
+    };
+
+    s_spriteProgram = linkProgram(shaders);
+
+    for(auto shader : shaders){
+        glDeleteShader(shader);
+    }
+
+    // Corners come from gl_VertexID, the only buffer is per instance and attached by setSprites
+    glCreateVertexArrays(1, &s_spriteVAO);
+    glVertexArrayBindingDivisor(s_spriteVAO, 0, 1);
+    glCreateBuffers(1, &s_spriteCommandBuffer);
+
+    glVertexArrayAttribFormat(s_spriteVAO, 0, 3, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, Position));
+    glVertexArrayAttribFormat(s_spriteVAO, 1, 1, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, Angle));
+    glVertexArrayAttribIFormat(s_spriteVAO, 2, 1, GL_UNSIGNED_INT, offsetof(SpriteInstance, Frame));
+    glVertexArrayAttribFormat(s_spriteVAO, 3, 1, GL_FLOAT, GL_FALSE, offsetof(SpriteInstance, LightLevel));
+
+    for(GLuint attribute{}; attribute < 4; ++attribute){
+        glVertexArrayAttribBinding(s_spriteVAO, attribute, 0);
+        glEnableVertexArrayAttrib(s_spriteVAO, attribute);
+    }
+}
+
+void initTextureRemap() {
+    // Zeroed so every slot show layer 0 until an atlas is set
+    const std::vector<uint32_t> slotLayers(MaxTextureSlots, 0);
+    glCreateBuffers(1, &s_textureRemapBuffer);
+    glNamedBufferStorage(s_textureRemapBuffer, slotLayers.size() * sizeof(uint32_t), slotLayers.data(), GL_DYNAMIC_STORAGE_BIT);
+    glBindBufferBase(GL_UNIFORM_BUFFER, TextureRemapBinding, s_textureRemapBuffer);
+}
+
+void Renderer::setSprites(const SpriteSet& sprites, std::span<const SpriteInstance> instances) {
+    glDeleteTextures(1, &s_spriteAtlasTexture);
+    glDeleteBuffers(1, &s_spriteImageBuffer);
+    glDeleteBuffers(1, &s_spriteFrameBuffer);
+    glDeleteBuffers(1, &s_spriteInstanceBuffer);
+    s_spriteCommandRanges.clear();
+
+    // Index in red, coverage in green, integer so holes stay sharp
+    glCreateTextures(GL_TEXTURE_2D, 1, &s_spriteAtlasTexture);
+    glTextureStorage2D(s_spriteAtlasTexture, 1, GL_RG8UI, sprites.AtlasSize.x, sprites.AtlasSize.y);
+    glTextureParameteri(s_spriteAtlasTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(s_spriteAtlasTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(s_spriteAtlasTexture, 0, 0, 0, sprites.AtlasSize.x, sprites.AtlasSize.y, GL_RG_INTEGER, GL_UNSIGNED_BYTE, sprites.AtlasTexels.data());
+
+    std::vector<GPUSpriteImage> images;
+    images.reserve(sprites.Images.size());
+    for(auto&& image : sprites.Images){
+        images.push_back(GPUSpriteImage{glm::ivec4{image.AtlasPosition, image.Width, image.Height}, glm::ivec2{image.LeftOffset, image.TopOffset}, glm::ivec2{}});
+    }
+
+    // Image in the low half, mirrored flag above, 8 per frame
+    std::vector<uint32_t> frames;
+    frames.reserve(sprites.Frames.size() * NumRotations);
+    for(auto&& frame : sprites.Frames){
+        for(int rotation{}; rotation < NumRotations; ++rotation){
+            frames.push_back(frame.Images[rotation] | ((frame.FlipMask >> rotation) & 1u) << 16);
+        }
+    }
+
+    // Empty buffers can not be bound, keep one element
+    images.resize(std::max<size_t>(images.size(), 1));
+    frames.resize(std::max<size_t>(frames.size(), NumRotations), NoSpriteImage);
+
+    glCreateBuffers(1, &s_spriteImageBuffer);
+    glNamedBufferStorage(s_spriteImageBuffer, images.size() * sizeof(GPUSpriteImage), images.data(), 0);
+    glCreateBuffers(1, &s_spriteFrameBuffer);
+    glNamedBufferStorage(s_spriteFrameBuffer, frames.size() * sizeof(uint32_t), frames.data(), 0);
+
+    // Things never move, the draw only pick ranges of this buffer
+    const std::vector<SpriteInstance> storedInstances = instances.empty() ? std::vector<SpriteInstance>(1) : std::vector<SpriteInstance>(instances.begin(), instances.end());
+    glCreateBuffers(1, &s_spriteInstanceBuffer);
+    glNamedBufferStorage(s_spriteInstanceBuffer, storedInstances.size() * sizeof(SpriteInstance), storedInstances.data(), 0);
+    glVertexArrayVertexBuffer(s_spriteVAO, 0, s_spriteInstanceBuffer, 0, sizeof(SpriteInstance));
+}
+
+void Renderer::drawSprites(std::span<const SpriteRange> ranges) {
+    if(ranges.empty() || s_spriteAtlasTexture == 0){
+        return;
+    }
+
+    // Base instance offset the divisor attributes, sprite.vert never read gl_InstanceID
+    if(!std::ranges::equal(ranges, s_spriteCommandRanges)){
+        std::vector<DrawArraysIndirectCommand> commands;
+        commands.reserve(ranges.size());
+        for(auto&& range : ranges){
+            commands.push_back(DrawArraysIndirectCommand{4, range.NumInstances, 0, range.FirstInstance});
+        }
+
+        const GLsizeiptr size = static_cast<GLsizeiptr>(commands.size() * sizeof(DrawArraysIndirectCommand));
+        if(size > s_spriteCommandCapacity){
+            s_spriteCommandCapacity = std::max(size, s_spriteCommandCapacity * 2);
+            glNamedBufferData(s_spriteCommandBuffer, s_spriteCommandCapacity, nullptr, GL_DYNAMIC_DRAW);
+        }
+        glNamedBufferSubData(s_spriteCommandBuffer, 0, size, commands.data());
+        s_spriteCommandRanges.assign(ranges.begin(), ranges.end());
+    }
+
+    const glm::vec3 eyePosition{glm::inverse(s_viewMatrix)[3]};
+
+    glUseProgram(s_spriteProgram);
+    glUniformMatrix4fv(1, 1, GL_FALSE, glm::value_ptr(s_viewMatrix));
+    glUniformMatrix4fv(2, 1, GL_FALSE, glm::value_ptr(s_projectionMatrix));
+    glUniform3fv(SpriteEyeLocation, 1, glm::value_ptr(eyePosition));
+
+    glBindTextureUnit(SpriteAtlasUnit, s_spriteAtlasTexture);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SpriteImagesBinding, s_spriteImageBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SpriteFramesBinding, s_spriteFrameBuffer);
+    glBindVertexArray(s_spriteVAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_spriteCommandBuffer);
+    glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr, static_cast<GLsizei>(s_spriteCommandRanges.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    if(s_activeProgram != nullptr){
+        glUseProgram(s_activeProgram->Program);
+    }
+}
+
 void Renderer::drawPoint(glm::vec2 point, float size, const glm::vec4& color) {
     const glm::mat4 translationMatrix = glm::translate(glm::identity<glm::mat4>(), glm::vec3{point.x, point.y, 0.0f});
     const glm::mat4 scaleMatrix = glm::scale(glm::identity<glm::mat4>(), glm::vec3{size, size, 1.0f});
@@ -105,11 +355,63 @@ void Renderer::drawQuad(glm::vec2 center, glm::vec2 size, float angle, const glm
 }
 
 void Renderer::drawMesh(const Mesh& mesh, const glm::mat4& transform, const glm::vec4& color) {
-    glUniform4fv(s_colorLocation, 1, glm::value_ptr(color));
-    glUniformMatrix4fv(s_modelMatrixLocation, 1, GL_FALSE, glm::value_ptr(transform));
+    glUniform4fv(ColorLocation, 1, glm::value_ptr(color));
+    glUniformMatrix4fv(ModelMatrixLocation, 1, GL_FALSE, glm::value_ptr(transform));
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 
     glBindVertexArray(mesh.VAO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
     glDrawElements(GL_TRIANGLES, mesh.NumIndices, GL_UNSIGNED_INT, nullptr);
-}
\ No newline at end of file
+}
+
+void Renderer::drawMeshRanges(const Mesh& mesh, std::span<const MeshRange> ranges, const glm::mat4& transform, const glm::vec4& color) {
+    if(ranges.empty()){
+        return;
+    }
+
+    s_rangeCounts.clear();
+    s_rangeOffsets.clear();
+
+    for(auto&& range : ranges){
+        s_rangeCounts.push_back(static_cast<GLsizei>(range.NumIndices));
+        s_rangeOffsets.push_back(reinterpret_cast<const void*>(range.FirstIndex * sizeof(uint32_t)));
+    }
+
+    glUniform4fv(ColorLocation, 1, glm::value_ptr(color));
+    glUniformMatrix4fv(ModelMatrixLocation, 1, GL_FALSE, glm::value_ptr(transform));
+
+    glBindVertexArray(mesh.VAO);
+    glMultiDrawElements(GL_TRIANGLES, s_rangeCounts.data(), GL_UNSIGNED_INT, s_rangeOffsets.data(), static_cast<GLsizei>(ranges.size()));
+}
+
+void Renderer::blitImage(std::span<const uint8_t> rgba, int width, int height) {
+    if(rgba.size() < static_cast<size_t>(width) * height * 4){
+        return;
+    }
+
+    if(s_blitSize != glm::ivec2{width, height}){
+        glDeleteTextures(1, &s_blitTexture);
+        glCreateTextures(GL_TEXTURE_2D, 1, &s_blitTexture);
+        glTextureStorage2D(s_blitTexture, 1, GL_RGBA8, width, height);
+        glTextureParameteri(s_blitTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(s_blitTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(s_blitTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(s_blitTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        s_blitSize = glm::ivec2{width, height};
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage2D(s_blitTexture, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(s_blitProgram);
+    glBindTextureUnit(0, s_blitTexture);
+    glBindVertexArray(s_blitVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Back to the scene program for the next draws
+    glEnable(GL_DEPTH_TEST);
+    if(s_activeProgram != nullptr){
+        glUseProgram(s_activeProgram->Program);
+    }
+}
@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <Creepy/ScreenClipper.hpp>
+
+void ScreenClipper::reset(int width) {
+    Width = width;
+    Ranges.clear();
+}
+
+bool ScreenClipper::isOccluded(int first, int last) const {
+    first = std::max(first, 0);
+    last = std::min(last, Width - 1);
+
+    // Fully off screen
+    if(first > last){
+        return true;
+    }
+
+    // First range that end at or after first column
+    const auto it = std::lower_bound(Ranges.begin(), Ranges.end(), first, [](const ClipRange& range, int column){
+        return range.last < column;
+    });
+
+    return it != Ranges.end() && it->first <= first && it->last >= last;
+}
+
+void ScreenClipper::addOccluder(int first, int last) {
+    first = std::max(first, 0);
+    last = std::min(last, Width - 1);
+
+    if(first > last){
+        return;
+    }
+
+    // Ranges touching [first - 1, last + 1] merge into one
+    auto begin = std::lower_bound(Ranges.begin(), Ranges.end(), first - 1, [](const ClipRange& range, int column){
+        return range.last < column;
+    });
+
+    auto end = begin;
+    while(end != Ranges.end() && end->first <= last + 1){
+        first = std::min(first, end->first);
+        last = std::max(last, end->last);
+        ++end;
+    }
+
+    if(begin == end){
+        Ranges.insert(begin, ClipRange{first, last});
+        return;
+    }
+
+    *begin = ClipRange{first, last};
+    Ranges.erase(begin + 1, end);
+}
+
+bool ScreenClipper::isFull() const {
+    return Ranges.size() == 1 && Ranges.front().first <= 0 && Ranges.front().last >= Width - 1;
+}
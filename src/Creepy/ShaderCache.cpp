@@ -0,0 +1,152 @@
+#include <print>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <Creepy/ShaderCache.hpp>
+#include <Creepy/Utils.hpp>
+
+static std::filesystem::path s_cacheDirectory{"./res/shader/cache"};
+
+constexpr uint32_t CacheMagic{0x43505343};     // "CPSC"
+constexpr uint32_t CacheVersion{1};
+
+struct CacheHeader{
+    uint32_t magic{CacheMagic};
+    uint32_t version{CacheVersion};
+    uint64_t key{};
+    GLenum binaryFormat{};
+    uint32_t binarySize{};
+};
+
+static uint64_t makeCacheKey(std::span<const ShaderSource> sources);
+static GLuint loadCachedProgram(const std::filesystem::path& filePath, uint64_t key);
+static void storeProgram(const std::filesystem::path& filePath, uint64_t key, GLuint program);
+
+void ShaderCache::setCacheDirectory(const std::filesystem::path& directory) {
+    s_cacheDirectory = directory;
+}
+
+GLuint ShaderCache::loadProgram(std::span<const ShaderSource> sources) {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    GLint numFormats{};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+    const uint64_t key = makeCacheKey(sources);
+    const auto filePath = s_cacheDirectory / std::format("{:016x}.bin", key);
+
+    if(numFormats > 0){
+        if(const GLuint program = loadCachedProgram(filePath, key); program != 0){
+            const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+            std::println("Shader Cache Hit: {:016x} - Warm Start: {:.3f} ms", key, elapsed.count());
+            return program;
+        }
+    }
+
+    std::vector<GLuint> shaders;
+    shaders.reserve(sources.size());
+    for(auto&& source : sources){
+        shaders.push_back(compileShader(source.Type, source.Source));
+    }
+
+    const GLuint program = linkProgram(shaders, numFormats > 0);
+
+    for(auto shader : shaders){
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+
+    if(numFormats > 0){
+        storeProgram(filePath, key, program);
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::println("Shader Cache Miss: {:016x} - Cold Start: {:.3f} ms", key, elapsed.count());
+
+    return program;
+}
+
+uint64_t makeCacheKey(std::span<const ShaderSource> sources) {
+    uint64_t key = hashBytes({});
+
+    for(auto&& source : sources){
+        key = hashBytes(std::as_bytes(std::span{&source.Type, 1}), key);
+        key = hashBytes(std::as_bytes(std::span{source.Source}), key);
+    }
+
+    // Binary only valid for the exact same driver
+    for(GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}){
+        const std::string_view driverString{reinterpret_cast<const char*>(glGetString(name))};
+        key = hashBytes(std::as_bytes(std::span{driverString}), key);
+    }
+
+    return key;
+}
+
+GLuint loadCachedProgram(const std::filesystem::path& filePath, uint64_t key) {
+    std::ifstream fileIn{filePath, std::ios::binary};
+
+    if(!fileIn.good()){
+        return 0;
+    }
+
+    CacheHeader header{};
+    fileIn.read(std::bit_cast<char*>(&header), sizeof(CacheHeader));
+
+    if(!fileIn.good() || header.magic != CacheMagic || header.version != CacheVersion || header.key != key){
+        return 0;
+    }
+
+    std::vector<std::byte> binary(header.binarySize);
+    fileIn.read(std::bit_cast<char*>(binary.data()), binary.size());
+
+    if(!fileIn.good()){
+        return 0;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint success{};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    // Driver update or corrupted file, let caller recompile
+    if(!success){
+        std::println("Shader Cache Rejected: {}", filePath.string());
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void storeProgram(const std::filesystem::path& filePath, uint64_t key, GLuint program) {
+    GLint success{}, binaryLength{};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+
+    if(!success || binaryLength <= 0){
+        return;
+    }
+
+    CacheHeader header{};
+    header.key = key;
+
+    std::vector<std::byte> binary(binaryLength);
+    GLsizei writtenLength{};
+    glGetProgramBinary(program, binaryLength, &writtenLength, &header.binaryFormat, binary.data());
+    header.binarySize = static_cast<uint32_t>(writtenLength);
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(filePath.parent_path(), errorCode);
+
+    std::ofstream fileOut{filePath, std::ios::binary | std::ios::trunc};
+
+    if(!fileOut.good()){
+        std::println("Failed Write Shader Cache: {}", filePath.string());
+        return;
+    }
+
+    fileOut.write(std::bit_cast<const char*>(&header), sizeof(CacheHeader));
+    fileOut.write(std::bit_cast<const char*>(binary.data()), header.binarySize);
+}
@@ -0,0 +1,272 @@
+#include <print>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_set>
+#include <GLFW/glfw3.h>
+#include <Creepy/ShaderPermutations.hpp>
+#include <Creepy/ShaderCache.hpp>
+#include <Creepy/Utils.hpp>
+
+struct FinishedProgram{
+    ShaderProgram Program;
+    GLsync Fence{};
+};
+
+static GLFWwindow* s_workerWindow{nullptr};
+static std::jthread s_worker;
+static std::mutex s_mutex;
+static std::condition_variable_any s_condition;
+static std::deque<ShaderFeature> s_requestQueue;
+static std::vector<FinishedProgram> s_finishedPrograms;
+
+// Main thread only
+static std::unordered_map<uint32_t, ShaderProgram> s_readyPrograms;
+static std::unordered_set<uint32_t> s_requestedPrograms;
+
+// Read only after init
+static std::vector<std::byte> s_vertexSpirv, s_fragmentSpirv;
+static std::string s_vertexSource, s_fragmentSource;
+
+// constant_id in fragment.frag
+constexpr GLuint LightingModelConstant{0};
+constexpr GLuint FogConstant{1};
+constexpr GLuint DebugColorConstant{2};
+constexpr GLuint PaletteConstant{3};
+
+static ShaderProgram buildProgram(ShaderFeature features);
+static void reflectProgram(ShaderProgram& program);
+static void workerLoop(std::stop_token stopToken);
+static void collectFinishedPrograms();
+
+GLint ShaderProgram::getUniform(const std::string& name) const {
+    const auto it = Uniforms.find(name);
+    return it != Uniforms.end() ? it->second : -1;
+}
+
+void ShaderPermutations::init(GLFWwindow* mainWindow) {
+    if(GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_gl_spirv){
+        s_vertexSpirv = readBinaryFile("./res/shader/ve.spv");
+        s_fragmentSpirv = readBinaryFile("./res/shader/fa.spv");
+    }
+
+    if(s_vertexSpirv.empty() || s_fragmentSpirv.empty()){
+        std::println("SPIR-V Not Found, Fallback To GLSL Source");
+        s_vertexSpirv.clear();
+        s_fragmentSpirv.clear();
+        s_vertexSource = readShaderFile("./res/shader/vertex.vert");
+        s_fragmentSource = readShaderFile("./res/shader/fragment.frag");
+    }
+
+    // Generic variant must always exist to fall back on
+    s_readyPrograms.emplace(0u, buildProgram(ShaderFeature::NONE));
+    s_requestedPrograms.insert(0u);
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    s_workerWindow = glfwCreateWindow(1, 1, "Shader Worker", nullptr, mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if(s_workerWindow == nullptr){
+        std::println("Failed Create Shared Context, Compile Variants On Main Thread");
+        return;
+    }
+
+    s_worker = std::jthread{workerLoop};
+}
+
+void ShaderPermutations::shutdown() {
+    if(s_worker.joinable()){
+        s_worker.request_stop();
+        s_worker.join();
+    }
+
+    for(auto&& finished : s_finishedPrograms){
+        glDeleteSync(finished.Fence);
+        glDeleteProgram(finished.Program.Program);
+    }
+    s_finishedPrograms.clear();
+
+    for(auto&& [key, program] : s_readyPrograms){
+        glDeleteProgram(program.Program);
+    }
+    s_readyPrograms.clear();
+    s_requestedPrograms.clear();
+
+    if(s_workerWindow != nullptr){
+        glfwDestroyWindow(s_workerWindow);
+        s_workerWindow = nullptr;
+    }
+}
+
+void ShaderPermutations::request(ShaderFeature features) {
+    const uint32_t key = static_cast<uint32_t>(features);
+
+    if(!s_requestedPrograms.insert(key).second){
+        return;
+    }
+
+    if(s_workerWindow == nullptr){
+        s_readyPrograms.emplace(key, buildProgram(features));
+        return;
+    }
+
+    {
+        std::lock_guard lock{s_mutex};
+        s_requestQueue.push_back(features);
+    }
+    s_condition.notify_one();
+}
+
+const ShaderProgram& ShaderPermutations::getProgram(ShaderFeature features) {
+    collectFinishedPrograms();
+
+    if(const auto it = s_readyPrograms.find(static_cast<uint32_t>(features)); it != s_readyPrograms.end()){
+        return it->second;
+    }
+
+    request(features);
+
+    // Compiled synchronously when there is no worker
+    if(const auto it = s_readyPrograms.find(static_cast<uint32_t>(features)); it != s_readyPrograms.end()){
+        return it->second;
+    }
+
+    return s_readyPrograms.at(0u);
+}
+
+ShaderProgram buildProgram(ShaderFeature features) {
+    ShaderProgram program{};
+    program.Features = features;
+
+    if(!s_vertexSpirv.empty()){
+        constexpr std::array constantIndices{LightingModelConstant, FogConstant, DebugColorConstant, PaletteConstant};
+        const std::array constantValues{
+            static_cast<GLuint>(hasFeature(features, ShaderFeature::LIGHT_DIMINISHING)),
+            static_cast<GLuint>(hasFeature(features, ShaderFeature::FOG)),
+            static_cast<GLuint>(hasFeature(features, ShaderFeature::DEBUG_COLOR)),
+            static_cast<GLuint>(hasFeature(features, ShaderFeature::PALETTE))
+        };
+
+        const GLuint vertexShader = loadSpirvShader(GL_VERTEX_SHADER, s_vertexSpirv, {}, {});
+        const GLuint fragmentShader = loadSpirvShader(GL_FRAGMENT_SHADER, s_fragmentSpirv, constantIndices, constantValues);
+
+        program.Program = linkProgram(std::array{vertexShader, fragmentShader});
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+    else {
+        // GLSL has no specialization constant, feed variant as defines after #version
+        const std::string defines{std::format("#define LIGHTING_MODEL {}\n#define ENABLE_FOG {}\n#define DEBUG_COLOR {}\n#define PALETTE_LOOKUP {}\n",
+            static_cast<int>(hasFeature(features, ShaderFeature::LIGHT_DIMINISHING)),
+            static_cast<int>(hasFeature(features, ShaderFeature::FOG)),
+            static_cast<int>(hasFeature(features, ShaderFeature::DEBUG_COLOR)),
+            static_cast<int>(hasFeature(features, ShaderFeature::PALETTE)))};
+
+        std::string fragmentSource{s_fragmentSource};
+        fragmentSource.insert(fragmentSource.find('\n') + 1, defines);
+
+        const std::array sources{
+            ShaderSource{GL_VERTEX_SHADER, s_vertexSource},
+            ShaderSource{GL_FRAGMENT_SHADER, std::move(fragmentSource)}
+        };
+
+        program.Program = ShaderCache::loadProgram(sources);
+    }
+
+    reflectProgram(program);
+    return program;
+}
+
+void reflectProgram(ShaderProgram& program) {
+    GLint numUniforms{}, numBlocks{};
+    glGetProgramInterfaceiv(program.Program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &numUniforms);
+    glGetProgramInterfaceiv(program.Program, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &numBlocks);
+
+    for(GLint i{}; i < numUniforms; ++i){
+        constexpr std::array<GLenum, 3> properties{GL_NAME_LENGTH, GL_LOCATION, GL_BLOCK_INDEX};
+        std::array<GLint, properties.size()> values{};
+        glGetProgramResourceiv(program.Program, GL_UNIFORM, i, properties.size(), properties.data(), values.size(), nullptr, values.data());
+
+        // Block members are reached through their block binding
+        if(values[2] != -1 || values[0] <= 1){
+            continue;
+        }
+
+        std::string name(values[0] - 1, '\0');
+        glGetProgramResourceName(program.Program, GL_UNIFORM, i, values[0], nullptr, name.data());
+        program.Uniforms.emplace(std::move(name), values[1]);
+    }
+
+    for(GLint i{}; i < numBlocks; ++i){
+        constexpr std::array<GLenum, 2> properties{GL_NAME_LENGTH, GL_BUFFER_BINDING};
+        std::array<GLint, properties.size()> values{};
+        glGetProgramResourceiv(program.Program, GL_UNIFORM_BLOCK, i, properties.size(), properties.data(), values.size(), nullptr, values.data());
+
+        if(values[0] <= 1){
+            continue;
+        }
+
+        std::string name(values[0] - 1, '\0');
+        glGetProgramResourceName(program.Program, GL_UNIFORM_BLOCK, i, values[0], nullptr, name.data());
+        program.UniformBlocks.emplace(std::move(name), values[1]);
+    }
+
+    // A name that reflect must sit at its explicit location, a missing one is fine
+    constexpr std::pair<const char*, GLint> ExplicitLocations[]{
+        {"modelMatrix", ModelMatrixLocation}, {"viewMatrix", ViewMatrixLocation},
+        {"projectionMatrix", ProjectionMatrixLocation}, {"myColor", ColorLocation}
+    };
+
+    for(auto [name, location] : ExplicitLocations){
+        const GLint reflected = program.getUniform(name);
+        if(reflected != -1 && reflected != location){
+            std::println("Uniform {} At Location {}, Expected {}", name, reflected, location);
+        }
+    }
+}
+
+void workerLoop(std::stop_token stopToken) {
+    glfwMakeContextCurrent(s_workerWindow);
+
+    while(true){
+        ShaderFeature features{};
+        {
+            std::unique_lock lock{s_mutex};
+            if(!s_condition.wait(lock, stopToken, []{ return !s_requestQueue.empty(); })){
+                break;
+            }
+
+            features = s_requestQueue.front();
+            s_requestQueue.pop_front();
+        }
+
+        FinishedProgram finished{buildProgram(features)};
+
+        // Main context must not use the program before the driver finished it
+        finished.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        std::lock_guard lock{s_mutex};
+        s_finishedPrograms.push_back(std::move(finished));
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void collectFinishedPrograms() {
+    std::lock_guard lock{s_mutex};
+
+    std::erase_if(s_finishedPrograms, [](FinishedProgram& finished){
+        const GLenum status = glClientWaitSync(finished.Fence, 0, 0);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED){
+            return false;
+        }
+
+        glDeleteSync(finished.Fence);
+        s_readyPrograms.emplace(static_cast<uint32_t>(finished.Program.Features), std::move(finished.Program));
+        return true;
+    });
+}
@@ -0,0 +1,334 @@
+#include <print>
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <Creepy/SoftwareKernels.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define CREEPY_X86_SIMD
+#endif
+
+using ColumnKernel = void(*)(const ColumnJob& job);
+using SpanKernel = void(*)(const SpanJob& job);
+
+struct KernelSet{
+    ColumnKernel Column;
+    SpanKernel Span;
+    const char* Name;
+};
+
+static KernelSet selectKernels();
+static bool matchScalar(const KernelSet& kernels);
+static float timeKernels(const KernelSet& kernels);
+static void drawColumnRange(const ColumnJob& job, int first);
+static void drawSpanRange(const SpanJob& job, int first);
+
+#ifdef CREEPY_X86_SIMD
+__attribute__((target("sse4.1"))) static void drawColumnSSE41(const ColumnJob& job);
+__attribute__((target("sse4.1"))) static void drawSpanSSE41(const SpanJob& job);
+__attribute__((target("avx2"))) static void drawColumnAVX2(const ColumnJob& job);
+__attribute__((target("avx2"))) static void drawSpanAVX2(const SpanJob& job);
+#endif
+
+static KernelSet s_kernels{SoftwareKernels::drawColumnScalar, SoftwareKernels::drawSpanScalar, "Scalar"};
+static std::once_flag s_selectFlag;
+
+void SoftwareKernels::init() {
+    std::call_once(s_selectFlag, []{ s_kernels = selectKernels(); });
+}
+
+void SoftwareKernels::drawColumn(const ColumnJob& job) {
+    s_kernels.Column(job);
+}
+
+void SoftwareKernels::drawSpan(const SpanJob& job) {
+    s_kernels.Span(job);
+}
+
+const char* SoftwareKernels::getKernelName() {
+    return s_kernels.Name;
+}
+
+void SoftwareKernels::drawColumnScalar(const ColumnJob& job) {
+    drawColumnRange(job, 0);
+}
+
+void SoftwareKernels::drawSpanScalar(const SpanJob& job) {
+    drawSpanRange(job, 0);
+}
+
+KernelColorMap KernelColorMap::make(const ColorMap& colorMap) {
+    KernelColorMap kernelColorMap{};
+    kernelColorMap.Colors.reserve(NumColorMaps * 256 + KernelSourcePadding);
+
+    for(auto&& row : colorMap.Maps){
+        kernelColorMap.Colors.insert(kernelColorMap.Colors.end(), row.begin(), row.end());
+    }
+    kernelColorMap.Colors.resize(NumColorMaps * 256 + KernelSourcePadding, 0);
+
+    return kernelColorMap;
+}
+
+const uint8_t* KernelColorMap::getRow(int level) const {
+    return Colors.data() + static_cast<size_t>(level) * 256;
+}
+
+// v is not stepped, SIMD lanes compute the same product and sum so tails and lanes agree
+void drawColumnRange(const ColumnJob& job, int first) {
+    uint8_t* pixel = job.Destination + static_cast<ptrdiff_t>(first) * job.Pitch;
+
+    for(int i = first; i < job.Count; ++i, pixel += job.Pitch){
+        const float v = job.VStart + job.Step * static_cast<float>(i);
+        *pixel = job.ColorMap[job.Source[static_cast<int>(std::floor(v)) & job.SourceMask]];
+    }
+}
+
+void drawSpanRange(const SpanJob& job, int first) {
+    for(int i = first; i < job.Count; ++i){
+        const float x = static_cast<float>(job.FirstX + i);
+        const int u = static_cast<int>(std::floor(job.RowCenter.x + job.Step.x * x)) & 63;
+        const int v = static_cast<int>(std::floor(job.RowCenter.y + job.Step.y * x)) & 63;
+        job.Destination[i] = job.ColorMap[job.Source[(v << 6) | u]];
+    }
+}
+
+KernelSet selectKernels() {
+    constexpr KernelSet scalar{SoftwareKernels::drawColumnScalar, SoftwareKernels::drawSpanScalar, "Scalar"};
+
+#ifdef CREEPY_X86_SIMD
+    __builtin_cpu_init();
+
+    std::vector<KernelSet> candidates;
+    if(__builtin_cpu_supports("avx2")){
+        candidates.push_back({drawColumnAVX2, drawSpanAVX2, "AVX2"});
+    }
+    if(__builtin_cpu_supports("sse4.1")){
+        candidates.push_back({drawColumnSSE41, drawSpanSSE41, "SSE4.1"});
+    }
+
+    // Gathers are microcoded or slowed by mitigations on many CPUs, the widest kernel is not always the fastest
+    KernelSet best{scalar};
+    float bestTime{timeKernels(scalar)};
+
+    for(auto&& kernels : candidates){
+        // Flags like FMA contraction can change scalar rounding, never ship a kernel that disagree
+        if(!matchScalar(kernels)){
+            std::println("Software Kernel {} Mismatch Scalar, Skipped", kernels.Name);
+            continue;
+        }
+
+        if(const float time = timeKernels(kernels); time < bestTime){
+            best = kernels;
+            bestTime = time;
+        }
+    }
+
+    return best;
+#else
+    return scalar;
+#endif
+}
+
+float timeKernels(const KernelSet& kernels) {
+    constexpr int NumRuns{5}, NumJobs{256}, Count{256};
+
+    std::array<uint8_t, 4096 + KernelSourcePadding> source{};
+    const KernelColorMap kernelColorMap = KernelColorMap::make(ColorMap{});
+    const uint8_t* colorMap = kernelColorMap.getRow(0);
+    std::array<uint8_t, Count> destination{};
+
+    float bestTime{std::numeric_limits<float>::max()};
+    for(int run{}; run < NumRuns; ++run){
+        const auto startTime = std::chrono::steady_clock::now();
+
+        for(int job{}; job < NumJobs; ++job){
+            kernels.Column(ColumnJob{destination.data(), 1, Count, source.data(), 127, static_cast<float>(job), 0.61f, colorMap});
+            kernels.Span(SpanJob{destination.data(), job, Count, source.data(), glm::vec2{static_cast<float>(job), 3.0f}, glm::vec2{0.37f, 0.11f}, colorMap});
+        }
+
+        const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+        bestTime = std::min(bestTime, elapsed.count());
+    }
+
+    return bestTime;
+}
+
+bool matchScalar(const KernelSet& kernels) {
+    // Odd counts hit the tails, negative and huge coordinates hit the masking
+    constexpr std::array<float, 6> starts{0.0f, 0.37f, -5.5f, 127.9f, -1000.25f, 65536.5f};
+    constexpr std::array<float, 5> steps{1.0f, 0.173f, 2.71f, 0.0039f, -13.0f};
+    constexpr std::array<int, 6> counts{1, 7, 8, 9, 31, 67};
+    constexpr int MaxCount{67};
+
+    // Real unpadded ColorMap through the same copy the renderer use, the last row end at the padding
+    std::array<uint8_t, 4096 + KernelSourcePadding> source{};
+    ColorMap colorMapRows{};
+    uint32_t seed{0x9E3779B9u};
+    for(auto& texel : source){
+        seed = seed * 1664525u + 1013904223u;
+        texel = static_cast<uint8_t>(seed >> 24);
+    }
+    for(auto& row : colorMapRows.Maps){
+        for(auto& color : row){
+            seed = seed * 1664525u + 1013904223u;
+            color = static_cast<uint8_t>(seed >> 24);
+        }
+    }
+
+    const KernelColorMap kernelColorMap = KernelColorMap::make(colorMapRows);
+    const uint8_t* colorMap = kernelColorMap.getRow(NumColorMaps - 1);
+
+    std::array<uint8_t, MaxCount * 3> expected{}, actual{};
+
+    for(float start : starts){
+        for(float step : steps){
+            for(int count : counts){
+                ColumnJob column{expected.data(), 3, count, source.data(), 127, start, step, colorMap};
+                SoftwareKernels::drawColumnScalar(column);
+                column.Destination = actual.data();
+                kernels.Column(column);
+
+                const int firstX = static_cast<int>(std::abs(start)) % 1024;
+                SpanJob span{expected.data() + 1, firstX, count, source.data(), glm::vec2{start, -start * 0.5f}, glm::vec2{step, step * -0.75f}, colorMap};
+                SoftwareKernels::drawSpanScalar(span);
+                span.Destination = actual.data() + 1;
+                kernels.Span(span);
+
+                if(expected != actual){
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+#ifdef CREEPY_X86_SIMD
+
+// SSE4.1 has no gather, lanes do the coordinate math and the lookups stay scalar, 8 pixels per step
+__attribute__((target("sse4.1")))
+void drawColumnSSE41(const ColumnJob& job) {
+    const __m128 laneLow = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 laneHigh = _mm_setr_ps(4.0f, 5.0f, 6.0f, 7.0f);
+    const __m128 start = _mm_set1_ps(job.VStart);
+    const __m128 step = _mm_set1_ps(job.Step);
+    const __m128i mask = _mm_set1_epi32(job.SourceMask);
+
+    uint8_t* pixel = job.Destination;
+    alignas(16) std::array<int32_t, 8> texels;
+    int i{};
+
+    for(; i + 8 <= job.Count; i += 8){
+        const __m128 base = _mm_set1_ps(static_cast<float>(i));
+        const __m128 vLow = _mm_add_ps(start, _mm_mul_ps(step, _mm_add_ps(base, laneLow)));
+        const __m128 vHigh = _mm_add_ps(start, _mm_mul_ps(step, _mm_add_ps(base, laneHigh)));
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(texels.data()), _mm_and_si128(_mm_cvttps_epi32(_mm_floor_ps(vLow)), mask));
+        _mm_store_si128(reinterpret_cast<__m128i*>(texels.data() + 4), _mm_and_si128(_mm_cvttps_epi32(_mm_floor_ps(vHigh)), mask));
+
+        for(int lane{}; lane < 8; ++lane, pixel += job.Pitch){
+            *pixel = job.ColorMap[job.Source[texels[lane]]];
+        }
+    }
+
+    drawColumnRange(job, i);
+}
+
+__attribute__((target("sse4.1")))
+static __m128i getFlatIndices(__m128 centerX, __m128 centerY, __m128 stepX, __m128 stepY, __m128 x) {
+    const __m128i mask = _mm_set1_epi32(63);
+    const __m128i u = _mm_and_si128(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(centerX, _mm_mul_ps(stepX, x)))), mask);
+    const __m128i v = _mm_and_si128(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(centerY, _mm_mul_ps(stepY, x)))), mask);
+    return _mm_or_si128(_mm_slli_epi32(v, 6), u);
+}
+
+__attribute__((target("sse4.1")))
+void drawSpanSSE41(const SpanJob& job) {
+    const __m128 laneLow = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 laneHigh = _mm_setr_ps(4.0f, 5.0f, 6.0f, 7.0f);
+    const __m128 centerX = _mm_set1_ps(job.RowCenter.x);
+    const __m128 centerY = _mm_set1_ps(job.RowCenter.y);
+    const __m128 stepX = _mm_set1_ps(job.Step.x);
+    const __m128 stepY = _mm_set1_ps(job.Step.y);
+
+    alignas(16) std::array<int32_t, 8> texels;
+    int i{};
+
+    for(; i + 8 <= job.Count; i += 8){
+        const __m128 base = _mm_set1_ps(static_cast<float>(job.FirstX + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(texels.data()), getFlatIndices(centerX, centerY, stepX, stepY, _mm_add_ps(base, laneLow)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(texels.data() + 4), getFlatIndices(centerX, centerY, stepX, stepY, _mm_add_ps(base, laneHigh)));
+
+        for(int lane{}; lane < 8; ++lane){
+            job.Destination[i + lane] = job.ColorMap[job.Source[texels[lane]]];
+        }
+    }
+
+    drawSpanRange(job, i);
+}
+
+// Texel and color fetch are both byte gathers, 32 bit loads masked to the low byte
+__attribute__((target("avx2")))
+static __m256i gatherBytes(const uint8_t* table, __m256i indices) {
+    return _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(table), indices, 1), _mm256_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx2")))
+void drawColumnAVX2(const ColumnJob& job) {
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 start = _mm256_set1_ps(job.VStart);
+    const __m256 step = _mm256_set1_ps(job.Step);
+    const __m256i mask = _mm256_set1_epi32(job.SourceMask);
+
+    uint8_t* pixel = job.Destination;
+    alignas(32) std::array<uint32_t, 8> colors;
+    int i{};
+
+    for(; i + 8 <= job.Count; i += 8){
+        const __m256 v = _mm256_add_ps(start, _mm256_mul_ps(step, _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lane)));
+        const __m256i texels = gatherBytes(job.Source, _mm256_and_si256(_mm256_cvttps_epi32(_mm256_floor_ps(v)), mask));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(colors.data()), gatherBytes(job.ColorMap, texels));
+
+        // Rows are a pitch apart, no byte scatter so store one by one
+        for(int k{}; k < 8; ++k, pixel += job.Pitch){
+            *pixel = static_cast<uint8_t>(colors[k]);
+        }
+    }
+
+    drawColumnRange(job, i);
+}
+
+__attribute__((target("avx2")))
+void drawSpanAVX2(const SpanJob& job) {
+    const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 centerX = _mm256_set1_ps(job.RowCenter.x);
+    const __m256 centerY = _mm256_set1_ps(job.RowCenter.y);
+    const __m256 stepX = _mm256_set1_ps(job.Step.x);
+    const __m256 stepY = _mm256_set1_ps(job.Step.y);
+    const __m256i mask = _mm256_set1_epi32(63);
+
+    int i{};
+
+    for(; i + 8 <= job.Count; i += 8){
+        const __m256 x = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(job.FirstX + i)), lane);
+        const __m256i u = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(centerX, _mm256_mul_ps(stepX, x)))), mask);
+        const __m256i v = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(centerY, _mm256_mul_ps(stepY, x)))), mask);
+
+        const __m256i texels = gatherBytes(job.Source, _mm256_or_si256(_mm256_slli_epi32(v, 6), u));
+        const __m256i colors = gatherBytes(job.ColorMap, texels);
+
+        // 32 -> 16 -> 8 bit pack work per 128 bit half, then join the two halves
+        const __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(colors, colors), _mm256_setzero_si256());
+        const __m128i bytes = _mm_unpacklo_epi32(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(job.Destination + i), bytes);
+    }
+
+    drawSpanRange(job, i);
+}
+
+#endif
@@ -0,0 +1,1117 @@
+#include <print>
+#include <bit>
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <limits>
+#include <fstream>
+#include <condition_variable>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <Creepy/SoftwareRenderer.hpp>
+#include <Creepy/ScreenClipper.hpp>
+#include <Creepy/SoftwareKernels.hpp>
+#include <Creepy/BSP.hpp>
+
+constexpr float NearDistance{1.0f};         // Map units
+constexpr uint16_t EmptyTop{0xFFFF};
+constexpr int MinStripWidth{32};
+constexpr int NoPlane{-1};
+constexpr size_t MinPlaneBuckets{256};
+constexpr uint32_t NoTexture{0xFFFFFFFF};
+
+struct VisPlane{
+    float Height{};
+    uint32_t Texture{};
+    int16_t Light{};
+    int MinX{}, MaxX{};
+
+    // Top then Bottom in the context arena, only as wide as the plane grew, a sentinel at both ends
+    size_t Columns{};
+    int ColumnStart{}, ColumnCapacity{};
+
+    int Next{};             // Hash chain
+};
+
+struct ViewSetup{
+    glm::vec2 Origin, Forward, Right;
+    float EyeHeight{};
+    float CenterX{}, CenterY{}, Focal{};
+    int Width{}, Height{};
+};
+
+// One per screen strip, a worker own it for the whole frame
+struct RenderContext{
+    int StripStart{}, StripEnd{};
+    ScreenClipper SolidColumns;
+    std::vector<int16_t> CeilingClip, FloorClip;
+    std::vector<VisPlane> VisPlanes;        // No limit, capacity is kept between frames
+    std::vector<int> PlaneBuckets;          // Hash of height, texture, light to first plane of chain
+    std::vector<uint16_t> PlaneColumns;     // Frame arena, reset not freed
+    size_t UsedPlaneColumns{};
+    std::vector<int> SpanStart;
+    SoftwareStats Stats;
+};
+
+// Column major like patches so a wall column is contiguous, padded for the kernel gathers
+struct SoftwareTexture{
+    int Width{};
+    int Height{};               // Real height for pegging
+    int ColumnHeight{};         // Power of two, rows past Height repeat the texture
+    std::vector<uint8_t> Texels;
+};
+
+// Wall textures of each SideDef, NoTexture for "-"
+struct SideTextures{
+    uint32_t Upper{NoTexture}, Lower{NoTexture}, Middle{NoTexture};
+};
+
+// Index into s_flatTextures of each Sector
+struct SectorFlats{
+    uint32_t Floor{}, Ceiling{};
+};
+
+// Seg values shared by every column of its visible ranges
+struct WallSetup{
+    float ScreenStart{}, ScreenEnd{};
+    float InverseZStart{}, InverseZEnd{};
+    float UOverZStart{}, UOverZEnd{};
+    float FrontFloor{}, FrontCeiling{}, BackFloor{}, BackCeiling{};
+    uint32_t UpperTexture{NoTexture}, LowerTexture{NoTexture}, MiddleTexture{NoTexture};
+    float UpperTop{}, LowerTop{}, MiddleTop{};      // Texture top in world height, row offset included
+    float TextureOffset{};
+    int LightOffset{};
+    int16_t Light{};
+    bool IsSolid{}, DrawUpper{}, DrawLower{}, MarkFloor{}, MarkCeiling{};
+};
+
+static const Map* s_map{nullptr};
+static const GLMap* s_glMap{nullptr};
+static Palette s_palette{};
+static KernelColorMap s_colorMap{};         // Padded for the gathers
+static SoftwareFrame s_frame{};
+static std::vector<RenderContext> s_contexts;
+static std::vector<uint16_t> s_subSectorSectors;
+static std::vector<SoftwareTexture> s_wallTextures;
+static std::vector<SideTextures> s_sideTextures;
+static std::vector<std::vector<uint8_t>> s_flatTextures;     // 64 x 64 row major, placeholders first
+static std::vector<SectorFlats> s_sectorFlats;
+
+// Animations swap entries here, the texture a SideDef or Sector name stay as loaded
+static std::vector<uint32_t> s_wallCacheIndices, s_flatCacheIndices;    // TextureCache index -> ours, NoTexture when not loaded
+static std::vector<uint32_t> s_wallRemap, s_flatRemap;                  // Ours -> shown
+static SoftwareStats s_stats{};
+
+// Main thread render strips too, workers only help
+static std::vector<std::jthread> s_workers;
+static std::mutex s_mutex;
+static std::condition_variable_any s_jobCondition;
+static std::condition_variable s_doneCondition;
+static uint64_t s_generation{};
+static int s_activeWorkers{};
+static std::atomic<int> s_nextStrip{};
+static ViewSetup s_view{};
+
+static void workerLoop(std::stop_token stopToken);
+static void renderStrips();
+static void renderStrip(RenderContext& context, const ViewSetup& view);
+
+static void renderSubSector(RenderContext& context, const ViewSetup& view, uint16_t subSectorIndex);
+static void renderSegment(RenderContext& context, const ViewSetup& view, const GLSegment& segment, const Sector& frontSector, uint16_t frontSectorIndex, int& floorPlane, int& ceilingPlane);
+static void storeWallRange(RenderContext& context, const ViewSetup& view, const WallSetup& wall, int start, int stop, int& floorPlane, int& ceilingPlane);
+static void drawColumn(const ViewSetup& view, int x, int top, int bottom, uint32_t texture, float u, float textureTop, float scale, const uint8_t* colorMap);
+static int findPlane(RenderContext& context, float height, uint32_t texture, int16_t light);
+static int checkPlane(RenderContext& context, int planeIndex, int start, int stop);
+static int addPlane(RenderContext& context, float height, uint32_t texture, int16_t light, int minX, int maxX);
+static size_t hashPlane(float height, uint32_t texture, int16_t light);
+static void rehashPlanes(RenderContext& context, size_t numBuckets);
+static void reservePlaneColumns(RenderContext& context, VisPlane& plane, int minX, int maxX);
+static int getPlaneColumn(const VisPlane& plane, int x);
+static uint16_t* getPlaneTop(RenderContext& context, const VisPlane& plane);
+static uint16_t* getPlaneBottom(RenderContext& context, const VisPlane& plane);
+static void drawPlanes(RenderContext& context, const ViewSetup& view);
+static void mapPlane(RenderContext& context, const ViewSetup& view, const VisPlane& plane, int y, int x1, int x2);
+static bool isBoxInView(const RenderContext& context, const ViewSetup& view, const BoundingBox& box);
+static void makePlaceholderTextures();
+static void loadWallTextures(const Map& map, const TextureCache& textureCache);
+static void loadFlatTextures(const Map& map, const TextureCache& textureCache);
+
+void SoftwareRenderer::init(const Map& map, const GLMap& glMap, const Palette& palette, const ColorMap& colorMap, const TextureCache& textureCache, int width, int height, int numThreads) {
+    shutdown();
+
+    // Kernels are picked on the first init, GL only runs never pay for the self test
+    SoftwareKernels::init();
+
+    s_map = &map;
+    s_glMap = &glMap;
+    s_palette = palette;
+    s_colorMap = KernelColorMap::make(colorMap);
+
+    makePlaceholderTextures();
+    loadWallTextures(map, textureCache);
+    loadFlatTextures(map, textureCache);
+
+    s_wallRemap.resize(s_wallTextures.size());
+    s_flatRemap.resize(s_flatTextures.size());
+    std::iota(s_wallRemap.begin(), s_wallRemap.end(), 0u);
+    std::iota(s_flatRemap.begin(), s_flatRemap.end(), 0u);
+
+    s_frame.Width = width;
+    s_frame.Height = height;
+    s_frame.Pixels.assign(static_cast<size_t>(width) * height, 0);
+
+    if(numThreads <= 0){
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Twice the strips of threads so a busy strip does not hold the frame, each strip redo the BSP walk
+    const int numStrips = numThreads == 1 ? 1 : std::clamp(numThreads * 2, 1, std::max(1, width / MinStripWidth));
+
+    s_contexts.clear();
+    s_contexts.resize(numStrips);
+    for(int i{}; i < numStrips; ++i){
+        auto& context = s_contexts[i];
+        context.StripStart = width * i / numStrips;
+        context.StripEnd = width * (i + 1) / numStrips - 1;
+        context.CeilingClip.resize(width);
+        context.FloorClip.resize(width);
+        context.SpanStart.resize(height);
+        context.PlaneBuckets.assign(MinPlaneBuckets, NoPlane);
+    }
+
+    // Sector of each subsector from its first real seg
+    s_subSectorSectors.assign(glMap.subSectors.size(), 0);
+    for(size_t i{}; i < glMap.subSectors.size(); ++i){
+        auto&& subSector = glMap.subSectors[i];
+        for(uint16_t j{}; j < subSector.numSegments; ++j){
+            auto&& segment = glMap.segments.at(subSector.firstSegment + j);
+            if(segment.lineDef != NoLineDef){
+                auto&& line = map.lineDefs.at(segment.lineDef);
+                s_subSectorSectors[i] = map.sideDefs.at(segment.side == 0 ? line.frontSideDef : line.backSideDef).sectorIndex;
+                break;
+            }
+        }
+    }
+
+    // New workers see an old generation, nothing must be left to take
+    s_nextStrip = numStrips;
+    for(int i{1}; i < numThreads; ++i){
+        s_workers.emplace_back(workerLoop);
+    }
+}
+
+void SoftwareRenderer::shutdown() {
+    for(auto& worker : s_workers){
+        worker.request_stop();
+    }
+
+    s_workers.clear();
+}
+
+void SoftwareRenderer::render(glm::vec3 position, glm::vec3 forward) {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    ViewSetup view{};
+    view.Width = s_frame.Width;
+    view.Height = s_frame.Height;
+    view.Origin = glm::vec2{position.x, position.z};
+    view.EyeHeight = position.y;
+
+    const glm::vec2 flatForward{forward.x, forward.z};
+    view.Forward = glm::length(flatForward) > 1e-4f ? glm::normalize(flatForward) : glm::vec2{0.0f, 1.0f};
+    view.Right = glm::vec2{view.Forward.y, -view.Forward.x};
+
+    // 90 degree horizontal field of view like vanilla, square pixels
+    view.Focal = static_cast<float>(view.Width) * 0.5f;
+    view.CenterX = static_cast<float>(view.Width) * 0.5f;
+
+    const float pitch = std::asin(std::clamp(forward.y / std::max(glm::length(forward), 1e-4f), -0.99f, 0.99f));
+    view.CenterY = static_cast<float>(view.Height) * 0.5f + std::tan(pitch) * view.Focal;
+
+    {
+        std::lock_guard lock{s_mutex};
+        s_view = view;
+        s_nextStrip = 0;
+        ++s_generation;
+    }
+    s_jobCondition.notify_all();
+
+    renderStrips();
+
+    {
+        std::unique_lock lock{s_mutex};
+        s_doneCondition.wait(lock, []{ return s_nextStrip >= static_cast<int>(s_contexts.size()) && s_activeWorkers == 0; });
+    }
+
+    s_stats = SoftwareStats{};
+    for(auto&& context : s_contexts){
+        s_stats.Segments += context.Stats.Segments;
+        s_stats.Columns += context.Stats.Columns;
+        s_stats.Spans += context.Stats.Spans;
+        s_stats.VisPlanes += context.Stats.VisPlanes;
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    s_stats.Strips = static_cast<uint32_t>(s_contexts.size());
+    s_stats.Threads = static_cast<uint32_t>(s_workers.size() + 1);
+    s_stats.Milliseconds = elapsed.count();
+}
+
+void SoftwareRenderer::setAnimationFrames(std::span<const int> wallFrames, std::span<const int> flatFrames) {
+    auto remap = [](std::span<const int> frames, std::span<const uint32_t> cacheIndices, std::span<uint32_t> textureRemap){
+        for(size_t i{}; i < frames.size() && i < cacheIndices.size(); ++i){
+            const uint32_t texture = cacheIndices[i];
+            const uint32_t shown = cacheIndices[frames[i]];
+            if(texture != NoTexture && shown != NoTexture){
+                textureRemap[texture] = shown;
+            }
+        }
+    };
+
+    remap(wallFrames, s_wallCacheIndices, s_wallRemap);
+    remap(flatFrames, s_flatCacheIndices, s_flatRemap);
+}
+
+const SoftwareFrame& SoftwareRenderer::getFrame() {
+    return s_frame;
+}
+
+const Palette& SoftwareRenderer::getPalette() {
+    return s_palette;
+}
+
+const SoftwareStats& SoftwareRenderer::getStats() {
+    return s_stats;
+}
+
+void workerLoop(std::stop_token stopToken) {
+    uint64_t generation{};
+
+    while(true){
+        {
+            std::unique_lock lock{s_mutex};
+            if(!s_jobCondition.wait(lock, stopToken, [&]{ return s_generation != generation; })){
+                return;
+            }
+
+            // Counted under the lock, main thread wait for it before the next frame touch the view
+            generation = s_generation;
+            ++s_activeWorkers;
+        }
+
+        renderStrips();
+
+        {
+            std::lock_guard lock{s_mutex};
+            --s_activeWorkers;
+        }
+        s_doneCondition.notify_one();
+    }
+}
+
+void renderStrips() {
+    const int numStrips = static_cast<int>(s_contexts.size());
+
+    for(int strip = s_nextStrip.fetch_add(1); strip < numStrips; strip = s_nextStrip.fetch_add(1)){
+        renderStrip(s_contexts[strip], s_view);
+    }
+}
+
+void renderStrip(RenderContext& context, const ViewSetup& view) {
+    context.Stats = SoftwareStats{};
+    context.VisPlanes.clear();
+    context.UsedPlaneColumns = 0;
+    std::ranges::fill(context.PlaneBuckets, NoPlane);
+
+    // Columns of other strips start occluded, the BSP walk then skip whatever project outside
+    context.SolidColumns.reset(view.Width);
+    if(context.StripStart > 0){
+        context.SolidColumns.addOccluder(0, context.StripStart - 1);
+    }
+    if(context.StripEnd < view.Width - 1){
+        context.SolidColumns.addOccluder(context.StripEnd + 1, view.Width - 1);
+    }
+
+    const int stripWidth = context.StripEnd - context.StripStart + 1;
+    std::fill_n(context.CeilingClip.begin() + context.StripStart, stripWidth, int16_t{-1});
+    std::fill_n(context.FloorClip.begin() + context.StripStart, stripWidth, static_cast<int16_t>(view.Height));
+    for(int y{}; y < view.Height; ++y){
+        std::fill_n(s_frame.Pixels.begin() + static_cast<size_t>(y) * view.Width + context.StripStart, stripWidth, uint8_t{0});
+    }
+
+    BSP::traverse(*s_glMap, view.Origin, 
+        [&](const BoundingBox& box, uint32_t){
+            return isBoxInView(context, view, box);
+        },
+        [&](uint16_t subSectorIndex){
+            if(context.SolidColumns.isFull()){
+                return false;
+            }
+
+            renderSubSector(context, view, subSectorIndex);
+            return true;
+        });
+
+    drawPlanes(context, view);
+    context.Stats.VisPlanes = static_cast<uint32_t>(context.VisPlanes.size());
+}
+
+void SoftwareFrame::toRGBA(const Palette& palette, std::vector<uint8_t>& rgba) const {
+    rgba.resize(Pixels.size() * 4);
+
+    for(size_t i{}; i < Pixels.size(); ++i){
+        const auto color = palette.Colors[Pixels[i]];
+        rgba[i * 4] = color.r;
+        rgba[i * 4 + 1] = color.g;
+        rgba[i * 4 + 2] = color.b;
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+bool SoftwareFrame::writePPM(const std::filesystem::path& filePath, const Palette& palette) const {
+    std::ofstream fileOut{filePath, std::ios::binary | std::ios::trunc};
+
+    if(!fileOut.good()){
+        std::println("Failed Write Frame: {}", filePath.string());
+        return false;
+    }
+
+    const std::string header = std::format("P6\n{} {}\n255\n", Width, Height);
+    fileOut.write(header.data(), header.size());
+
+    std::vector<uint8_t> rgb(Pixels.size() * 3);
+    for(size_t i{}; i < Pixels.size(); ++i){
+        const auto color = palette.Colors[Pixels[i]];
+        rgb[i * 3] = color.r;
+        rgb[i * 3 + 1] = color.g;
+        rgb[i * 3 + 2] = color.b;
+    }
+
+    fileOut.write(std::bit_cast<const char*>(rgb.data()), rgb.size());
+    return fileOut.good();
+}
+
+void renderSubSector(RenderContext& context, const ViewSetup& view, uint16_t subSectorIndex) {
+    const uint16_t sectorIndex = s_subSectorSectors[subSectorIndex];
+    auto&& sector = s_map->sectors[sectorIndex];
+
+    auto&& flats = s_sectorFlats[sectorIndex];
+    int floorPlane = sector.floor < view.EyeHeight ? findPlane(context, sector.floor, s_flatRemap[flats.Floor], sector.lightLevel) : NoPlane;
+    int ceilingPlane = sector.ceiling > view.EyeHeight ? findPlane(context, sector.ceiling, s_flatRemap[flats.Ceiling], sector.lightLevel) : NoPlane;
+
+    auto&& subSector = s_glMap->subSectors[subSectorIndex];
+    for(uint16_t i{}; i < subSector.numSegments; ++i){
+        auto&& segment = s_glMap->segments[subSector.firstSegment + i];
+
+        // Minisegs only close the subsector, nothing to draw
+        if(segment.lineDef == NoLineDef){
+            continue;
+        }
+
+        renderSegment(context, view, segment, sector, sectorIndex, floorPlane, ceilingPlane);
+    }
+}
+
+void renderSegment(RenderContext& context, const ViewSetup& view, const GLSegment& segment, const Sector& frontSector, uint16_t frontSectorIndex, int& floorPlane, int& ceilingPlane) {
+    const glm::vec2 start = BSP::getSegmentVertex(*s_map, *s_glMap, segment.startVertex);
+    const glm::vec2 end = BSP::getSegmentVertex(*s_map, *s_glMap, segment.endVertex);
+
+    // Front side is on the right, back face when the view is on the left
+    const glm::vec2 direction = end - start;
+    const glm::vec2 toView = view.Origin - start;
+    if(direction.x * toView.y - direction.y * toView.x >= 0.0f){
+        return;
+    }
+
+    auto&& line = s_map->lineDefs[segment.lineDef];
+    const glm::vec2 lineOrigin = s_map->vertices[segment.side == 0 ? line.startIndex : line.endIndex];
+
+    auto toViewSpace = [&view](glm::vec2 point){
+        const glm::vec2 delta = point - view.Origin;
+        return glm::vec2{glm::dot(delta, view.Right), glm::dot(delta, view.Forward)};
+    };
+
+    glm::vec2 viewStart = toViewSpace(start);
+    glm::vec2 viewEnd = toViewSpace(end);
+    float uStart = glm::distance(lineOrigin, start);
+    float uEnd = uStart + glm::length(direction);
+
+    if(viewStart.y < NearDistance && viewEnd.y < NearDistance){
+        return;
+    }
+
+    if(viewStart.y < NearDistance){
+        const float t = (NearDistance - viewStart.y) / (viewEnd.y - viewStart.y);
+        viewStart += (viewEnd - viewStart) * t;
+        uStart += (uEnd - uStart) * t;
+    }
+    else if(viewEnd.y < NearDistance){
+        const float t = (NearDistance - viewEnd.y) / (viewStart.y - viewEnd.y);
+        viewEnd += (viewStart - viewEnd) * t;
+        uEnd += (uStart - uEnd) * t;
+    }
+
+    WallSetup wall{};
+    wall.ScreenStart = view.CenterX + viewStart.x * view.Focal / viewStart.y;
+    wall.ScreenEnd = view.CenterX + viewEnd.x * view.Focal / viewEnd.y;
+
+    // Pixel column is covered when its center is inside
+    const int firstColumn = std::max(0, static_cast<int>(std::ceil(wall.ScreenStart - 0.5f)));
+    const int lastColumn = std::min(view.Width - 1, static_cast<int>(std::ceil(wall.ScreenEnd - 0.5f)) - 1);
+    if(firstColumn > lastColumn){
+        return;
+    }
+
+    wall.InverseZStart = 1.0f / viewStart.y;
+    wall.InverseZEnd = 1.0f / viewEnd.y;
+    wall.UOverZStart = uStart * wall.InverseZStart;
+    wall.UOverZEnd = uEnd * wall.InverseZEnd;
+    wall.FrontFloor = frontSector.floor;
+    wall.FrontCeiling = frontSector.ceiling;
+    wall.Light = frontSector.lightLevel;
+
+    const uint16_t sideDefIndex = segment.side == 0 ? line.frontSideDef : line.backSideDef;
+    auto&& sideDef = s_map->sideDefs[sideDefIndex];
+    auto&& sideTextures = s_sideTextures[sideDefIndex];
+    auto remapWall = [](uint32_t texture){
+        return texture != NoTexture ? s_wallRemap[texture] : NoTexture;
+    };
+
+    wall.UpperTexture = remapWall(sideTextures.Upper);
+    wall.LowerTexture = remapWall(sideTextures.Lower);
+    wall.MiddleTexture = remapWall(sideTextures.Middle);
+    wall.TextureOffset = sideDef.xOffset;
+
+    auto getTextureHeight = [](uint32_t texture){
+        return texture != NoTexture ? static_cast<float>(s_wallTextures[texture].Height) : 0.0f;
+    };
+
+    const bool isUpperUnpegged = line.flags & std::to_underlying(LineDefFormat::UPPER_UNPEGGED);
+    const bool isLowerUnpegged = line.flags & std::to_underlying(LineDefFormat::LOWER_UNPEGGED);
+
+    // Fake contrast, vanilla light axis aligned walls differently
+    wall.LightOffset = direction.y == 0.0f ? -1 : (direction.x == 0.0f ? 1 : 0);
+
+    const bool isTwoSided = line.flags & std::to_underlying(LineDefFormat::TWO_SIDE);
+    if(!isTwoSided){
+        wall.IsSolid = true;
+        wall.MarkFloor = true;
+        wall.MarkCeiling = true;
+
+        // Pegged to the ceiling, lower unpegged sit on the floor like door tracks
+        wall.MiddleTop = (isLowerUnpegged ? wall.FrontFloor + getTextureHeight(wall.MiddleTexture) : wall.FrontCeiling) + sideDef.yOffset;
+    }
+    else {
+        const uint16_t backSectorIndex = s_map->sideDefs[segment.side == 0 ? line.backSideDef : line.frontSideDef].sectorIndex;
+        auto&& backSector = s_map->sectors[backSectorIndex];
+        wall.BackFloor = backSector.floor;
+        wall.BackCeiling = backSector.ceiling;
+
+        // Vanilla pegging, upper hang from the back ceiling and lower start at the back floor unless unpegged
+        wall.UpperTop = (isUpperUnpegged ? wall.FrontCeiling : wall.BackCeiling + getTextureHeight(wall.UpperTexture)) + sideDef.yOffset;
+        wall.LowerTop = (isLowerUnpegged ? wall.FrontCeiling : wall.BackFloor) + sideDef.yOffset;
+
+        // Closed door block the view like a one sided wall
+        wall.IsSolid = backSector.ceiling <= frontSector.floor || backSector.floor >= frontSector.ceiling;
+        wall.DrawUpper = backSector.ceiling < frontSector.ceiling;
+        wall.DrawLower = backSector.floor > frontSector.floor;
+
+        // Like R_StoreWallRange a plane only start where height, flat or light change, flats as findPlane see them
+        auto&& frontFlats = s_sectorFlats[frontSectorIndex];
+        auto&& backFlats = s_sectorFlats[backSectorIndex];
+        const bool isSameLight = backSector.lightLevel == frontSector.lightLevel;
+        wall.MarkFloor = wall.IsSolid || backSector.floor != frontSector.floor || s_flatRemap[backFlats.Floor] != s_flatRemap[frontFlats.Floor] || !isSameLight;
+        wall.MarkCeiling = wall.IsSolid || backSector.ceiling != frontSector.ceiling || s_flatRemap[backFlats.Ceiling] != s_flatRemap[frontFlats.Ceiling] || !isSameLight;
+
+        // Trigger line inside one sector, nothing to draw
+        if(!wall.IsSolid && !wall.DrawUpper && !wall.DrawLower && !wall.MarkFloor && !wall.MarkCeiling){
+            return;
+        }
+    }
+
+    if(frontSector.floor >= view.EyeHeight){
+        wall.MarkFloor = false;
+    }
+
+    if(frontSector.ceiling <= view.EyeHeight){
+        wall.MarkCeiling = false;
+    }
+
+    ++context.Stats.Segments;
+
+    context.SolidColumns.forEachVisibleRange(firstColumn, lastColumn, [&](int rangeStart, int rangeStop){
+        storeWallRange(context, view, wall, rangeStart, rangeStop, floorPlane, ceilingPlane);
+    });
+
+    if(wall.IsSolid){
+        context.SolidColumns.addOccluder(firstColumn, lastColumn);
+    }
+}
+
+void storeWallRange(RenderContext& context, const ViewSetup& view, const WallSetup& wall, int start, int stop, int& floorPlane, int& ceilingPlane) {
+    const bool isMarkCeiling = wall.MarkCeiling && ceilingPlane != NoPlane;
+    const bool isMarkFloor = wall.MarkFloor && floorPlane != NoPlane;
+
+    if(isMarkCeiling){
+        ceilingPlane = checkPlane(context, ceilingPlane, start, stop);
+    }
+
+    if(isMarkFloor){
+        floorPlane = checkPlane(context, floorPlane, start, stop);
+    }
+
+    // Arena and plane list only grow in checkPlane, pointers hold for the columns below
+    const VisPlane* ceiling = isMarkCeiling ? &context.VisPlanes[ceilingPlane] : nullptr;
+    const VisPlane* floor = isMarkFloor ? &context.VisPlanes[floorPlane] : nullptr;
+    uint16_t* ceilingTop = isMarkCeiling ? getPlaneTop(context, *ceiling) : nullptr;
+    uint16_t* ceilingBottom = isMarkCeiling ? getPlaneBottom(context, *ceiling) : nullptr;
+    uint16_t* floorTop = isMarkFloor ? getPlaneTop(context, *floor) : nullptr;
+    uint16_t* floorBottom = isMarkFloor ? getPlaneBottom(context, *floor) : nullptr;
+
+    const float screenSpan = wall.ScreenEnd - wall.ScreenStart;
+
+    for(int x = start; x <= stop; ++x){
+        // 1 / z and u / z are linear in screen space
+        const float t = std::clamp((static_cast<float>(x) + 0.5f - wall.ScreenStart) / screenSpan, 0.0f, 1.0f);
+        const float inverseZ = wall.InverseZStart + (wall.InverseZEnd - wall.InverseZStart) * t;
+        const float z = 1.0f / inverseZ;
+        const float u = (wall.UOverZStart + (wall.UOverZEnd - wall.UOverZStart) * t) * z + wall.TextureOffset;
+        const float scale = view.Focal * inverseZ;
+
+        auto toScreenY = [&](float height){
+            return view.CenterY - (height - view.EyeHeight) * scale;
+        };
+
+        const uint8_t* colorMap = s_colorMap.getRow(getColorMapLevel(wall.Light, z, wall.LightOffset));
+        const int ceilingClip = context.CeilingClip[x];
+        const int floorClip = context.FloorClip[x];
+
+        const int top = std::max(static_cast<int>(std::ceil(toScreenY(wall.FrontCeiling) - 0.5f)), ceilingClip + 1);
+        const int bottom = std::min(static_cast<int>(std::floor(toScreenY(wall.FrontFloor) - 0.5f)), floorClip - 1);
+
+        if(isMarkCeiling){
+            const int planeTop = ceilingClip + 1;
+            const int planeBottom = std::min(top - 1, floorClip - 1);
+            if(planeTop <= planeBottom){
+                ceilingTop[getPlaneColumn(*ceiling, x)] = static_cast<uint16_t>(planeTop);
+                ceilingBottom[getPlaneColumn(*ceiling, x)] = static_cast<uint16_t>(planeBottom);
+            }
+        }
+
+        if(isMarkFloor){
+            const int planeTop = std::max(bottom + 1, ceilingClip + 1);
+            const int planeBottom = floorClip - 1;
+            if(planeTop <= planeBottom){
+                floorTop[getPlaneColumn(*floor, x)] = static_cast<uint16_t>(planeTop);
+                floorBottom[getPlaneColumn(*floor, x)] = static_cast<uint16_t>(planeBottom);
+            }
+        }
+
+        if(wall.IsSolid){
+            drawColumn(view, x, top, bottom, wall.MiddleTexture, u, wall.MiddleTop, scale, colorMap);
+            context.CeilingClip[x] = static_cast<int16_t>(view.Height);
+            context.FloorClip[x] = -1;
+            ++context.Stats.Columns;
+            continue;
+        }
+
+        if(wall.DrawUpper){
+            const int middle = std::min(static_cast<int>(std::floor(toScreenY(wall.BackCeiling) - 0.5f)), floorClip - 1);
+            if(middle >= top){
+                drawColumn(view, x, top, middle, wall.UpperTexture, u, wall.UpperTop, scale, colorMap);
+                context.CeilingClip[x] = static_cast<int16_t>(middle);
+                ++context.Stats.Columns;
+            }
+            else {
+                context.CeilingClip[x] = static_cast<int16_t>(top - 1);
+            }
+        }
+        else if(wall.MarkCeiling){
+            context.CeilingClip[x] = static_cast<int16_t>(top - 1);
+        }
+
+        if(wall.DrawLower){
+            const int middle = std::max(static_cast<int>(std::ceil(toScreenY(wall.BackFloor) - 0.5f)), context.CeilingClip[x] + 1);
+            if(middle <= bottom){
+                drawColumn(view, x, middle, bottom, wall.LowerTexture, u, wall.LowerTop, scale, colorMap);
+                context.FloorClip[x] = static_cast<int16_t>(middle);
+                ++context.Stats.Columns;
+            }
+            else {
+                context.FloorClip[x] = static_cast<int16_t>(bottom + 1);
+            }
+        }
+        else if(wall.MarkFloor){
+            context.FloorClip[x] = static_cast<int16_t>(bottom + 1);
+        }
+    }
+}
+
+void drawColumn(const ViewSetup& view, int x, int top, int bottom, uint32_t texture, float u, float textureTop, float scale, const uint8_t* colorMap) {
+    if(top > bottom || texture == NoTexture){
+        return;
+    }
+
+    auto&& wallTexture = s_wallTextures[texture];
+    const int column = ((static_cast<int>(std::floor(u)) % wallTexture.Width) + wallTexture.Width) % wallTexture.Width;
+
+    // v is world height down from the texture top
+    const float step = 1.0f / scale;
+
+    ColumnJob job{};
+    job.Destination = s_frame.Pixels.data() + static_cast<size_t>(top) * view.Width + x;
+    job.Pitch = view.Width;
+    job.Count = bottom - top + 1;
+    job.Source = wallTexture.Texels.data() + static_cast<size_t>(column) * wallTexture.ColumnHeight;
+    job.SourceMask = wallTexture.ColumnHeight - 1;
+    job.VStart = textureTop - view.EyeHeight + (static_cast<float>(top) + 0.5f - view.CenterY) * step;
+    job.Step = step;
+    job.ColorMap = colorMap;
+    SoftwareKernels::drawColumn(job);
+}
+
+int findPlane(RenderContext& context, float height, uint32_t texture, int16_t light) {
+    const size_t bucket = hashPlane(height, texture, light) & (context.PlaneBuckets.size() - 1);
+
+    for(int index = context.PlaneBuckets[bucket]; index != NoPlane; index = context.VisPlanes[index].Next){
+        auto&& plane = context.VisPlanes[index];
+        if(plane.Height == height && plane.Texture == texture && plane.Light == light){
+            return index;
+        }
+    }
+
+    return addPlane(context, height, texture, light, std::numeric_limits<int>::max(), -1);
+}
+
+int checkPlane(RenderContext& context, int planeIndex, int start, int stop) {
+    {
+        auto& plane = context.VisPlanes[planeIndex];
+        const uint16_t* top = getPlaneTop(context, plane);
+        const int intersectStart = std::max(start, plane.MinX);
+        const int intersectStop = std::min(stop, plane.MaxX);
+
+        int x = intersectStart;
+        while(x <= intersectStop && top[getPlaneColumn(plane, x)] == EmptyTop){
+            ++x;
+        }
+
+        // Columns are free, grow the plane
+        if(x > intersectStop){
+            reservePlaneColumns(context, plane, start, stop);
+            return planeIndex;
+        }
+    }
+
+    const auto& plane = context.VisPlanes[planeIndex];
+    const float height = plane.Height;
+    const uint32_t texture = plane.Texture;
+    const int16_t light = plane.Light;
+
+    // Merge into an earlier split of the same surface that does not touch these columns, vanilla always split
+    const size_t bucket = hashPlane(height, texture, light) & (context.PlaneBuckets.size() - 1);
+    for(int index = context.PlaneBuckets[bucket]; index != NoPlane; index = context.VisPlanes[index].Next){
+        auto& other = context.VisPlanes[index];
+        if(other.Height == height && other.Texture == texture && other.Light == light && (stop < other.MinX || start > other.MaxX)){
+            reservePlaneColumns(context, other, start, stop);
+            return index;
+        }
+    }
+
+    return addPlane(context, height, texture, light, start, stop);
+}
+
+int addPlane(RenderContext& context, float height, uint32_t texture, int16_t light, int minX, int maxX) {
+    // Keep chains short on maps with thousands of visible flats
+    if(context.VisPlanes.size() >= context.PlaneBuckets.size() * 2){
+        rehashPlanes(context, context.PlaneBuckets.size() * 2);
+    }
+
+    const size_t bucket = hashPlane(height, texture, light) & (context.PlaneBuckets.size() - 1);
+    const int index = static_cast<int>(context.VisPlanes.size());
+
+    auto& plane = context.VisPlanes.emplace_back();
+    plane.Height = height;
+    plane.Texture = texture;
+    plane.Light = light;
+    plane.MinX = std::numeric_limits<int>::max();
+    plane.MaxX = -1;
+    plane.Next = context.PlaneBuckets[bucket];
+    context.PlaneBuckets[bucket] = index;
+
+    if(minX <= maxX){
+        reservePlaneColumns(context, plane, minX, maxX);
+    }
+
+    return index;
+}
+
+void reservePlaneColumns(RenderContext& context, VisPlane& plane, int minX, int maxX) {
+    const int newMinX = std::min(plane.MinX, minX);
+    const int newMaxX = std::max(plane.MaxX, maxX);
+
+    if(newMinX >= plane.ColumnStart && newMaxX < plane.ColumnStart + plane.ColumnCapacity){
+        plane.MinX = newMinX;
+        plane.MaxX = newMaxX;
+        return;
+    }
+
+    // Double like a vector toward the side that grew, a fresh plane is created for most spans so this stay rare
+    const int stripWidth = context.StripEnd - context.StripStart + 1;
+    const int capacity = std::min(std::max(newMaxX - newMinX + 1, plane.ColumnCapacity * 2), stripWidth);
+    const int slack = capacity - (newMaxX - newMinX + 1);
+    const bool isGrowLeft = plane.MinX <= plane.MaxX && newMinX < plane.MinX;
+    const int columnStart = std::clamp(isGrowLeft ? newMinX - slack : newMinX, context.StripStart, context.StripEnd + 1 - capacity);
+
+    const size_t columns = context.UsedPlaneColumns;
+    context.UsedPlaneColumns += static_cast<size_t>(capacity + 2) * 2;
+    if(context.PlaneColumns.size() < context.UsedPlaneColumns){
+        context.PlaneColumns.resize(context.UsedPlaneColumns * 2);
+    }
+
+    // Only Top say if a column is used, Bottom is written with it
+    std::fill_n(context.PlaneColumns.begin() + columns, capacity + 2, EmptyTop);
+
+    VisPlane moved{plane};
+    moved.Columns = columns;
+    moved.ColumnStart = columnStart;
+    moved.ColumnCapacity = capacity;
+
+    // Old slice is left behind in the arena until the frame end
+    if(plane.MinX <= plane.MaxX){
+        const int count = plane.MaxX - plane.MinX + 1;
+        std::copy_n(getPlaneTop(context, plane) + getPlaneColumn(plane, plane.MinX), count, getPlaneTop(context, moved) + getPlaneColumn(moved, plane.MinX));
+        std::copy_n(getPlaneBottom(context, plane) + getPlaneColumn(plane, plane.MinX), count, getPlaneBottom(context, moved) + getPlaneColumn(moved, plane.MinX));
+    }
+
+    plane = moved;
+    plane.MinX = newMinX;
+    plane.MaxX = newMaxX;
+}
+
+size_t hashPlane(float height, uint32_t texture, int16_t light) {
+    uint32_t hash = std::bit_cast<uint32_t>(height) * 0x9E3779B1u;
+    hash ^= texture * 0x85EBCA77u;
+    hash ^= static_cast<uint32_t>(static_cast<uint16_t>(light)) * 0xC2B2AE3Du;
+    return hash ^ (hash >> 15);
+}
+
+void rehashPlanes(RenderContext& context, size_t numBuckets) {
+    context.PlaneBuckets.assign(numBuckets, NoPlane);
+
+    // Oldest first so every chain keep newest at the head like before
+    for(int index{}; index < static_cast<int>(context.VisPlanes.size()); ++index){
+        auto& plane = context.VisPlanes[index];
+        const size_t bucket = hashPlane(plane.Height, plane.Texture, plane.Light) & (numBuckets - 1);
+        plane.Next = context.PlaneBuckets[bucket];
+        context.PlaneBuckets[bucket] = index;
+    }
+}
+
+int getPlaneColumn(const VisPlane& plane, int x) {
+    return x + 1 - plane.ColumnStart;
+}
+
+uint16_t* getPlaneTop(RenderContext& context, const VisPlane& plane) {
+    return context.PlaneColumns.data() + plane.Columns;
+}
+
+uint16_t* getPlaneBottom(RenderContext& context, const VisPlane& plane) {
+    return context.PlaneColumns.data() + plane.Columns + plane.ColumnCapacity + 2;
+}
+
+void drawPlanes(RenderContext& context, const ViewSetup& view) {
+    for(auto&& plane : context.VisPlanes){
+        if(plane.MinX > plane.MaxX){
+            continue;
+        }
+
+        uint16_t* top = getPlaneTop(context, plane);
+        const uint16_t* bottom = getPlaneBottom(context, plane);
+        top[getPlaneColumn(plane, plane.MinX - 1)] = EmptyTop;
+        top[getPlaneColumn(plane, plane.MaxX + 1)] = EmptyTop;
+
+        // Vanilla R_MakeSpans, turn column extents into row spans
+        for(int x = plane.MinX; x <= plane.MaxX + 1; ++x){
+            const int column = getPlaneColumn(plane, x);
+            int top1 = top[column - 1], bottom1 = bottom[column - 1];
+            int top2 = top[column], bottom2 = bottom[column];
+            if(top1 == EmptyTop){
+                bottom1 = -1;
+            }
+            if(top2 == EmptyTop){
+                bottom2 = -1;
+            }
+
+            while(top1 < top2 && top1 <= bottom1){
+                mapPlane(context, view, plane, top1, context.SpanStart[top1], x - 1);
+                ++top1;
+            }
+
+            while(bottom1 > bottom2 && bottom1 >= top1){
+                mapPlane(context, view, plane, bottom1, context.SpanStart[bottom1], x - 1);
+                --bottom1;
+            }
+
+            while(top2 < top1 && top2 <= bottom2){
+                context.SpanStart[top2] = x;
+                ++top2;
+            }
+
+            while(bottom2 > bottom1 && bottom2 >= top2){
+                context.SpanStart[bottom2] = x;
+                --bottom2;
+            }
+        }
+    }
+}
+
+void mapPlane(RenderContext& context, const ViewSetup& view, const VisPlane& plane, int y, int x1, int x2) {
+    const float rowOffset = std::abs(static_cast<float>(y) + 0.5f - view.CenterY);
+    if(rowOffset < 1e-3f || x1 > x2){
+        return;
+    }
+
+    // Distance of the row along the view direction, then walk the world point across the row
+    const float z = std::abs(plane.Height - view.EyeHeight) * view.Focal / rowOffset;
+    // Point from x every pixel, not stepped, so strips split anywhere give the same image
+    const glm::vec2 step = view.Right * (z / view.Focal);
+
+    SpanJob job{};
+    job.Destination = s_frame.Pixels.data() + static_cast<size_t>(y) * view.Width + x1;
+    job.FirstX = x1;
+    job.Count = x2 - x1 + 1;
+    job.Source = s_flatTextures[plane.Texture % s_flatTextures.size()].data();
+    // Flat v run down the map like vanilla ds_yfrac = -viewy, +y would mirror every flat
+    const glm::vec2 rowCenter = view.Origin + view.Forward * z + step * (0.5f - view.CenterX);
+    job.RowCenter = glm::vec2{rowCenter.x, -rowCenter.y};
+    job.Step = glm::vec2{step.x, -step.y};
+    job.ColorMap = s_colorMap.getRow(getColorMapLevel(plane.Light, z));
+    SoftwareKernels::drawSpan(job);
+
+    ++context.Stats.Spans;
+}
+
+bool isBoxInView(const RenderContext& context, const ViewSetup& view, const BoundingBox& box) {
+    // Inside the box, always visible
+    if(view.Origin.x >= box.min.x && view.Origin.x <= box.max.x && view.Origin.y >= box.min.y && view.Origin.y <= box.max.y){
+        return true;
+    }
+
+    const std::array corners{box.min, glm::vec2{box.max.x, box.min.y}, box.max, glm::vec2{box.min.x, box.max.y}};
+    float minColumn{std::numeric_limits<float>::max()}, maxColumn{-std::numeric_limits<float>::max()};
+
+    auto addPoint = [&](glm::vec2 viewPoint){
+        const float column = view.CenterX + viewPoint.x * view.Focal / viewPoint.y;
+        minColumn = std::min(minColumn, column);
+        maxColumn = std::max(maxColumn, column);
+    };
+
+    for(size_t i{}; i < corners.size(); ++i){
+        auto toViewSpace = [&view](glm::vec2 point){
+            const glm::vec2 delta = point - view.Origin;
+            return glm::vec2{glm::dot(delta, view.Right), glm::dot(delta, view.Forward)};
+        };
+
+        const glm::vec2 current = toViewSpace(corners[i]);
+        const glm::vec2 next = toViewSpace(corners[(i + 1) % corners.size()]);
+
+        if(current.y >= NearDistance){
+            addPoint(current);
+        }
+
+        if((current.y >= NearDistance) != (next.y >= NearDistance)){
+            addPoint(current + (next - current) * ((NearDistance - current.y) / (next.y - current.y)));
+        }
+    }
+
+    if(minColumn > maxColumn){
+        return false;
+    }
+
+    return !context.SolidColumns.isOccluded(static_cast<int>(std::floor(minColumn)), static_cast<int>(std::ceil(maxColumn)));
+}
+
+// Placeholder textures until the real ones load, ramps of the Doom palette picked by id
+void makePlaceholderTextures() {
+    constexpr std::array<uint8_t, 4> WallRamps{80, 48, 128, 112};
+    constexpr std::array<uint8_t, 4> FlatRamps{96, 64, 136, 120};
+
+    s_wallTextures.resize(WallRamps.size());
+    s_flatTextures.resize(FlatRamps.size());
+
+    for(size_t texture{}; texture < WallRamps.size(); ++texture){
+        auto& wallTexture = s_wallTextures[texture];
+        wallTexture.Width = 64;
+        wallTexture.Height = 128;
+        wallTexture.ColumnHeight = 128;
+        wallTexture.Texels.assign(wallTexture.Width * wallTexture.Height + KernelSourcePadding, 0);
+
+        // Bricks 32 x 16 with every other row shifted
+        for(int u{}; u < wallTexture.Width; ++u){
+            for(int v{}; v < wallTexture.Height; ++v){
+                const bool isMortar = (v & 15) == 0 || ((u + ((v >> 4) & 1) * 16) & 31) == 0;
+                wallTexture.Texels[u * wallTexture.Height + v] = static_cast<uint8_t>(WallRamps[texture] + (isMortar ? 12 : ((u * 7 + v * 13 + static_cast<int>(texture)) & 3)));
+            }
+        }
+
+        // 64 x 64 tiles with 32 x 32 checker
+        auto& flat = s_flatTextures[texture];
+        flat.assign(64 * 64 + KernelSourcePadding, 0);
+        for(int v{}; v < 64; ++v){
+            for(int u{}; u < 64; ++u){
+                const bool isEdge = u == 0 || v == 0;
+                flat[v * 64 + u] = static_cast<uint8_t>(FlatRamps[texture] + (isEdge ? 6 : (((u >> 5) ^ (v >> 5)) & 1) * 2));
+            }
+        }
+    }
+}
+
+// Composite textures get power of two columns for the kernel mask, without them SideDefs spread over the placeholders
+// Only the current level is converted, the cache may still hold textures of older ones
+void loadWallTextures(const Map& map, const TextureCache& textureCache) {
+    s_sideTextures.assign(map.sideDefs.size(), SideTextures{});
+    s_wallCacheIndices.assign(textureCache.Textures.size(), NoTexture);
+
+    if(std::ranges::none_of(textureCache.Textures, [&textureCache](const CompositeTexture& texture){ return textureCache.isInLevel(texture); })){
+        for(size_t i{}; i < map.sideDefs.size(); ++i){
+            const uint32_t texture = static_cast<uint32_t>(i % s_wallTextures.size());
+            s_sideTextures[i] = SideTextures{texture, texture, texture};
+        }
+        return;
+    }
+
+    s_wallTextures.clear();
+    for(size_t i{}; i < textureCache.Textures.size(); ++i){
+        auto&& composite = textureCache.Textures[i];
+        if(!textureCache.isInLevel(composite)){
+            continue;
+        }
+
+        s_wallCacheIndices[i] = static_cast<uint32_t>(s_wallTextures.size());
+        auto& wallTexture = s_wallTextures.emplace_back();
+        wallTexture.Width = composite.Width;
+        wallTexture.Height = composite.Height;
+        wallTexture.ColumnHeight = static_cast<int>(std::bit_ceil(static_cast<uint32_t>(composite.Height)));
+        wallTexture.Texels.assign(static_cast<size_t>(wallTexture.Width) * wallTexture.ColumnHeight + KernelSourcePadding, 0);
+
+        for(int u{}; u < wallTexture.Width; ++u){
+            for(int v{}; v < wallTexture.ColumnHeight; ++v){
+                wallTexture.Texels[u * wallTexture.ColumnHeight + v] = composite.Texels[u * composite.Height + v % composite.Height];
+            }
+        }
+    }
+
+    auto findTexture = [&textureCache](Name8 name){
+        const int index = textureCache.find(name);
+        return index >= 0 ? s_wallCacheIndices[index] : NoTexture;
+    };
+
+    for(size_t i{}; i < map.sideDefs.size(); ++i){
+        auto&& sideDef = map.sideDefs[i];
+        s_sideTextures[i] = SideTextures{findTexture(sideDef.upperTexture), findTexture(sideDef.lowerTexture), findTexture(sideDef.middleTexture)};
+    }
+}
+
+// Flats of the level go after the placeholders, sectors naming a missing one keep a placeholder of their own
+void loadFlatTextures(const Map& map, const TextureCache& textureCache) {
+    const uint32_t numPlaceholders = static_cast<uint32_t>(s_flatTextures.size());
+    s_flatCacheIndices.assign(textureCache.Flats.size(), NoTexture);
+
+    for(size_t i{}; i < textureCache.Flats.size(); ++i){
+        auto&& flat = textureCache.Flats[i];
+        if(!textureCache.isInLevel(flat)){
+            continue;
+        }
+
+        s_flatCacheIndices[i] = static_cast<uint32_t>(s_flatTextures.size());
+        auto& texels = s_flatTextures.emplace_back(flat.Texels);
+        texels.resize(FlatSize * FlatSize + KernelSourcePadding, 0);
+    }
+
+    auto findFlat = [&textureCache](Name8 name, uint32_t placeholder){
+        const int index = textureCache.findFlat(name);
+        return index >= 0 && s_flatCacheIndices[index] != NoTexture ? s_flatCacheIndices[index] : placeholder;
+    };
+
+    s_sectorFlats.resize(map.sectors.size());
+    for(uint32_t i{}; i < map.sectors.size(); ++i){
+        auto&& sector = map.sectors[i];
+        s_sectorFlats[i] = SectorFlats{findFlat(sector.floorTexture, i * 2u % numPlaceholders), findFlat(sector.ceilingTexture, (i * 2u + 1u) % numPlaceholders)};
+    }
+}
+
+void SoftwareRenderer::benchmarkScaling(const Map& map, const GLMap& glMap, const Palette& palette, const ColorMap& colorMap, const TextureCache& textureCache, int numFrames) {
+    if(glMap.subSectors.empty()){
+        return;
+    }
+
+    constexpr std::array<glm::ivec2, 3> resolutions{glm::ivec2{640, 400}, glm::ivec2{1920, 1080}, glm::ivec2{3840, 2160}};
+    constexpr int NumViewPoints{8};
+    constexpr std::array<glm::vec3, 4> directions{glm::vec3{0.0f, 0.0f, 1.0f}, glm::vec3{1.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, -1.0f}, glm::vec3{-1.0f, 0.0f, 0.0f}};
+
+    const int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> threadCounts;
+    for(int count{1}; count < maxThreads; count *= 2){
+        threadCounts.push_back(count);
+    }
+    threadCounts.push_back(maxThreads);
+
+    // Center of subsectors spread over the map, eye at player height
+    std::vector<glm::vec3> viewPoints;
+    s_map = &map;
+    s_glMap = &glMap;
+    for(int i{}; i < NumViewPoints; ++i){
+        auto&& subSector = glMap.subSectors[glMap.subSectors.size() * i / NumViewPoints];
+        glm::vec2 center{};
+        float floorHeight{};
+        for(uint16_t j{}; j < subSector.numSegments; ++j){
+            auto&& segment = glMap.segments.at(subSector.firstSegment + j);
+            center += BSP::getSegmentVertex(map, glMap, segment.startVertex);
+
+            if(segment.lineDef != NoLineDef){
+                auto&& line = map.lineDefs.at(segment.lineDef);
+                floorHeight = map.sectors.at(map.sideDefs.at(segment.side == 0 ? line.frontSideDef : line.backSideDef).sectorIndex).floor;
+            }
+        }
+        center /= static_cast<float>(std::max<uint16_t>(subSector.numSegments, 1));
+        viewPoints.push_back(glm::vec3{center.x, floorHeight + 41.0f, center.y});
+    }
+
+    for(auto resolution : resolutions){
+        float singleThreadMilliseconds{};
+
+        for(int numThreads : threadCounts){
+            init(map, glMap, palette, colorMap, textureCache, resolution.x, resolution.y, numThreads);
+
+            // Warm up caches and wake the workers once
+            render(viewPoints.front(), directions.front());
+
+            // Worst frame is what a player notice, the average hide a view that open thousands of visplanes
+            float totalMilliseconds{}, maxMilliseconds{};
+            uint32_t maxVisPlanes{};
+            for(int frame{}; frame < numFrames; ++frame){
+                const auto startTime = std::chrono::steady_clock::now();
+                render(viewPoints[frame % viewPoints.size()], directions[(frame / viewPoints.size()) % directions.size()]);
+                const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+                totalMilliseconds += elapsed.count();
+                maxMilliseconds = std::max(maxMilliseconds, elapsed.count());
+                maxVisPlanes = std::max(maxVisPlanes, s_stats.VisPlanes);
+            }
+
+            const float frameMilliseconds = totalMilliseconds / static_cast<float>(std::max(numFrames, 1));
+            if(numThreads == 1){
+                singleThreadMilliseconds = frameMilliseconds;
+            }
+
+            std::println("{}x{} Threads: {} Strips: {} Max VisPlanes: {} Kernel: {} | Average: {:.2f} ms Max: {:.2f} ms | Speedup: {:.2f}x", 
+                resolution.x, resolution.y, numThreads, s_stats.Strips, maxVisPlanes, SoftwareKernels::getKernelName(), frameMilliseconds, maxMilliseconds, singleThreadMilliseconds / frameMilliseconds);
+        }
+    }
+
+    shutdown();
+}
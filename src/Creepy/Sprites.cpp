@@ -0,0 +1,284 @@
+#include <print>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <Creepy/Sprites.hpp>
+#include <Creepy/WAD.hpp>
+#include <Creepy/BSP.hpp>
+
+// Spawn frame of each thing type, from the vanilla mobj and state tables
+struct ThingSprite{
+    uint16_t Type;
+    Name8 Sprite;
+    char Frame;
+    bool IsHanging;         // Spawn on the ceiling
+};
+
+constexpr ThingSprite ThingSprites[]{
+    // Monsters
+    {3004, "POSS", 'A', false}, {9, "SPOS", 'A', false}, {65, "CPOS", 'A', false}, {3001, "TROO", 'A', false}, 
+    {3002, "SARG", 'A', false}, {58, "SARG", 'A', false}, {3006, "SKUL", 'A', false}, {3005, "HEAD", 'A', false}, 
+    {69, "BOS2", 'A', false}, {3003, "BOSS", 'A', false}, {68, "BSPI", 'A', false}, {71, "PAIN", 'A', false}, 
+    {66, "SKEL", 'A', false}, {67, "FATT", 'A', false}, {64, "VILE", 'A', false}, {16, "CYBR", 'A', false}, 
+    {7, "SPID", 'A', false}, {84, "SSWV", 'A', false}, {72, "KEEN", 'A', true}, 
+    // Weapons and ammo
+    {2005, "CSAW", 'A', false}, {2001, "SHOT", 'A', false}, {82, "SGN2", 'A', false}, {2002, "MGUN", 'A', false}, 
+    {2003, "LAUN", 'A', false}, {2004, "PLAS", 'A', false}, {2006, "BFUG", 'A', false}, 
+    {2007, "CLIP", 'A', false}, {2048, "AMMO", 'A', false}, {2008, "SHEL", 'A', false}, {2049, "SBOX", 'A', false}, 
+    {2010, "ROCK", 'A', false}, {2046, "BROK", 'A', false}, {2047, "CELL", 'A', false}, {17, "CELP", 'A', false}, 
+    {8, "BPAK", 'A', false}, 
+    // Health, armor, powerups and keys
+    {2011, "STIM", 'A', false}, {2012, "MEDI", 'A', false}, {2014, "BON1", 'A', false}, {2015, "BON2", 'A', false}, 
+    {2018, "ARM1", 'A', false}, {2019, "ARM2", 'A', false}, {83, "MEGA", 'A', false}, {2013, "SOUL", 'A', false}, 
+    {2022, "PINV", 'A', false}, {2023, "PSTR", 'A', false}, {2024, "PINS", 'A', false}, {2025, "SUIT", 'A', false}, 
+    {2026, "PMAP", 'A', false}, {2045, "PVIS", 'A', false}, 
+    {5, "BKEY", 'A', false}, {40, "BSKU", 'A', false}, {13, "RKEY", 'A', false}, {38, "RSKU", 'A', false}, 
+    {6, "YKEY", 'A', false}, {39, "YSKU", 'A', false}, 
+    // Decorations
+    {2035, "BAR1", 'A', false}, {70, "FCAN", 'A', false}, {43, "TRE1", 'A', false}, {54, "TRE2", 'A', false}, 
+    {47, "SMIT", 'A', false}, {48, "ELEC", 'A', false}, {30, "COL1", 'A', false}, {31, "COL2", 'A', false}, 
+    {32, "COL3", 'A', false}, {33, "COL4", 'A', false}, {36, "COL5", 'A', false}, {37, "COL6", 'A', false}, 
+    {41, "CEYE", 'A', false}, {42, "FSKU", 'A', false}, {2028, "COLU", 'A', false}, {85, "TLMP", 'A', false}, 
+    {86, "TLP2", 'A', false}, {34, "CAND", 'A', false}, {35, "CBRA", 'A', false}, {44, "TBLU", 'A', false}, 
+    {45, "TGRN", 'A', false}, {46, "TRED", 'A', false}, {55, "SMBT", 'A', false}, {56, "SMGT", 'A', false}, 
+    {57, "SMRT", 'A', false}, {25, "POL1", 'A', false}, {26, "POL6", 'A', false}, {27, "POL4", 'A', false}, 
+    {28, "POL2", 'A', false}, {29, "POL3", 'A', false}, 
+    {49, "GOR1", 'A', true}, {50, "GOR2", 'A', true}, {51, "GOR3", 'A', true}, {52, "GOR4", 'A', true}, 
+    {53, "GOR5", 'A', true}, {59, "GOR2", 'A', true}, {60, "GOR4", 'A', true}, {61, "GOR3", 'A', true}, 
+    {62, "GOR5", 'A', true}, {63, "GOR1", 'A', true}, {73, "HDB1", 'A', true}, {74, "HDB2", 'A', true}, 
+    {75, "HDB3", 'A', true}, {76, "HDB4", 'A', true}, {77, "HDB5", 'A', true}, {78, "HDB6", 'A', true}, 
+    // Corpses
+    {10, "PLAY", 'W', false}, {12, "PLAY", 'W', false}, {15, "PLAY", 'N', false}, {18, "POSS", 'L', false}, 
+    {19, "SPOS", 'L', false}, {20, "TROO", 'M', false}, {21, "SARG", 'N', false}, {22, "HEAD", 'L', false}, 
+    {24, "POL5", 'A', false}, {79, "POB1", 'A', false}, {80, "POB2", 'A', false}, {81, "BRS1", 'A', false}
+};
+
+static std::vector<const Lump*> findSpriteLumps(const WAD& wadFile);
+static void packImages(SpriteSet& sprites);
+static void decodePatch(const Lump& patch, const SpriteImage& image, SpriteSet& sprites);
+
+SpriteSet SpriteSet::load(const WAD& wadFile) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto lumps = findSpriteLumps(wadFile);
+
+    SpriteSet sprites{};
+    std::vector<const Lump*> imageLumps;
+    imageLumps.reserve(lumps.size());
+
+    // Name: sprite, frame letter, rotation digit, then maybe a mirrored frame and rotation
+    struct FrameEntry{
+        uint16_t Image;
+        uint8_t Rotation;
+        bool IsFlipped;
+    };
+    std::unordered_map<Name8, std::vector<std::vector<FrameEntry>>> entries;
+
+    for(auto* lump : lumps){
+        const Name8 name = lump->name;
+        if(name.size() < 6 || lump->size < 8){
+            continue;
+        }
+
+        auto readShort = [lump](size_t index){
+            return static_cast<int16_t>(static_cast<uint8_t>(lump->data[index]) | static_cast<uint8_t>(lump->data[index + 1]) << 8);
+        };
+
+        const uint16_t imageIndex = static_cast<uint16_t>(sprites.Images.size());
+        sprites.Images.push_back(SpriteImage{name, readShort(0), readShort(2), readShort(4), readShort(6)});
+        imageLumps.push_back(lump);
+
+        auto& frames = entries[name.prefix(4)];
+        for(size_t i{4}; i + 1 < name.size(); i += 2){
+            const int frame = name.at(i) - 'A';
+            const int rotation = name.at(i + 1) - '0';
+            if(frame < 0 || frame >= 29 || rotation < 0 || rotation > NumRotations){
+                break;
+            }
+
+            if(static_cast<int>(frames.size()) <= frame){
+                frames.resize(frame + 1);
+            }
+
+            frames[frame].push_back(FrameEntry{imageIndex, static_cast<uint8_t>(rotation), i > 4});
+        }
+    }
+
+    // Resolved once, drawing only index Frames by rotation
+    for(auto&& [name, frames] : entries){
+        sprites.Definitions[name] = SpriteDefinition{static_cast<int>(sprites.Frames.size()), static_cast<int>(frames.size())};
+
+        for(auto&& frameEntries : frames){
+            SpriteFrame frame{};
+            frame.Images.fill(NoSpriteImage);
+
+            for(auto&& entry : frameEntries){
+                const int first = entry.Rotation == 0 ? 0 : entry.Rotation - 1;
+                const int last = entry.Rotation == 0 ? NumRotations : entry.Rotation;
+                for(int rotation = first; rotation < last; ++rotation){
+                    frame.Images[rotation] = entry.Image;
+                    frame.FlipMask = entry.IsFlipped ? frame.FlipMask | (1 << rotation) : frame.FlipMask & ~(1 << rotation);
+                }
+            }
+
+            // Missing sides show the nearest one given, better than a hole
+            for(int rotation{}; rotation < NumRotations; ++rotation){
+                if(frame.Images[rotation] != NoSpriteImage){
+                    continue;
+                }
+
+                for(int step{1}; step < NumRotations; ++step){
+                    const int other = (rotation + step) % NumRotations;
+                    if(frame.Images[other] != NoSpriteImage){
+                        frame.Images[rotation] = frame.Images[other];
+                        frame.FlipMask |= (frame.FlipMask & (1 << other)) ? (1 << rotation) : 0;
+                        break;
+                    }
+                }
+            }
+
+            sprites.Frames.push_back(frame);
+        }
+    }
+
+    packImages(sprites);
+    for(size_t i{}; i < sprites.Images.size(); ++i){
+        decodePatch(*imageLumps[i], sprites.Images[i], sprites);
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::println("Sprites: {} Frames: {} Images: {} | Atlas: {} x {} | {:.3f} ms", 
+        sprites.Definitions.size(), sprites.Frames.size(), sprites.Images.size(), sprites.AtlasSize.x, sprites.AtlasSize.y, elapsed.count());
+
+    return sprites;
+}
+
+int SpriteSet::findFrame(Name8 sprite, char frame) const {
+    const auto it = Definitions.find(sprite);
+    if(it == Definitions.end() || frame - 'A' < 0 || frame - 'A' >= it->second.NumFrames){
+        return -1;
+    }
+
+    const int frameIndex = it->second.FirstFrame + (frame - 'A');
+    return Frames[frameIndex].Images[0] != NoSpriteImage ? frameIndex : -1;
+}
+
+std::vector<SpriteInstance> SpriteSet::placeThings(const Map& map, const GLMap& glMap) const {
+    std::unordered_map<uint16_t, const ThingSprite*> thingSprites;
+    for(auto&& thingSprite : ThingSprites){
+        thingSprites.emplace(thingSprite.Type, &thingSprite);
+    }
+
+    std::vector<SpriteInstance> instances;
+    instances.reserve(map.things.size());
+
+    for(auto&& thing : map.things){
+        if(!(thing.flags & std::to_underlying(ThingFlag::HARD)) || thing.flags & std::to_underlying(ThingFlag::MULTIPLAYER)){
+            continue;
+        }
+
+        const auto it = thingSprites.find(thing.type);
+        const int frame = it != thingSprites.end() ? findFrame(it->second->Sprite, it->second->Frame) : -1;
+        if(frame < 0){
+            continue;
+        }
+
+        const glm::vec2 position{static_cast<float>(thing.x), static_cast<float>(thing.y)};
+        auto&& sector = map.sectors.at(BSP::findSector(map, glMap, position));
+        const float height = it->second->IsHanging ? sector.ceiling - Images[Frames[frame].Images[0]].Height : sector.floor;
+
+        SpriteInstance instance{};
+        instance.Position = glm::vec3{position.x, height, position.y} / MapScaleFactor;
+        instance.Angle = glm::radians(static_cast<float>(thing.angle));
+        instance.Frame = static_cast<uint32_t>(frame);
+        instance.LightLevel = sector.lightLevel;
+        instances.push_back(instance);
+    }
+
+    std::println("Things: {} Placed: {}", map.things.size(), instances.size());
+
+    return instances;
+}
+
+// Directory order, later lumps replace earlier ones of the same name like PWADs do
+std::vector<const Lump*> findSpriteLumps(const WAD& wadFile) {
+    std::vector<const Lump*> lumps;
+    std::unordered_map<Name8, size_t> indices;
+    bool isInSprites{false};
+
+    for(auto&& lump : wadFile.lumps){
+        if(lump.name == "S_START" || lump.name == "SS_START"){
+            isInSprites = true;
+        }
+        else if(lump.name == "S_END" || lump.name == "SS_END"){
+            isInSprites = false;
+        }
+        else if(isInSprites && lump.size > 0){
+            if(const auto [it, isNew] = indices.emplace(lump.name, lumps.size()); isNew){
+                lumps.push_back(&lump);
+            }
+            else {
+                lumps[it->second] = &lump;
+            }
+        }
+    }
+
+    return lumps;
+}
+
+// Shelves, tallest first, rows grow down and the atlas is as tall as the last shelf
+void packImages(SpriteSet& sprites) {
+    std::vector<size_t> order(sprites.Images.size());
+    for(size_t i{}; i < order.size(); ++i){
+        order[i] = i;
+    }
+
+    std::ranges::sort(order, [&sprites](size_t left, size_t right){ return sprites.Images[left].Height > sprites.Images[right].Height; });
+
+    glm::ivec2 cursor{};
+    int shelfHeight{};
+    for(size_t index : order){
+        auto& image = sprites.Images[index];
+        image.Width = std::clamp(image.Width, 0, SpriteAtlasWidth);
+        image.Height = std::max(image.Height, 0);
+
+        if(cursor.x + image.Width > SpriteAtlasWidth){
+            cursor = glm::ivec2{0, cursor.y + shelfHeight};
+            shelfHeight = 0;
+        }
+
+        image.AtlasPosition = cursor;
+        cursor.x += image.Width;
+        shelfHeight = std::max(shelfHeight, image.Height);
+    }
+
+    sprites.AtlasSize = glm::ivec2{SpriteAtlasWidth, std::max(cursor.y + shelfHeight, 1)};
+    sprites.AtlasTexels.assign(static_cast<size_t>(sprites.AtlasSize.x) * sprites.AtlasSize.y, glm::u8vec2{0});
+}
+
+// Same post format as wall patches, holes stay transparent
+void decodePatch(const Lump& patch, const SpriteImage& image, SpriteSet& sprites) {
+    auto readByte = [&patch](size_t index){
+        return static_cast<uint8_t>(patch.data[index]);
+    };
+
+    for(int column{}; column < image.Width && 8 + static_cast<size_t>(column) * 4 + 4 <= patch.size; ++column){
+        size_t offset = readByte(8 + column * 4) | readByte(9 + column * 4) << 8 | readByte(10 + column * 4) << 16 | static_cast<size_t>(readByte(11 + column * 4)) << 24;
+        int top{-1};
+
+        while(offset + 3 <= patch.size && readByte(offset) != 0xFF){
+            const int delta = readByte(offset);
+            top = delta <= top ? top + delta : delta;
+
+            const int length = readByte(offset + 1);
+            const size_t source = offset + 3;
+
+            const int last = std::min({length, image.Height - top, static_cast<int>(patch.size) - static_cast<int>(source)});
+            for(int i{}; i < last; ++i){
+                const glm::ivec2 texel = image.AtlasPosition + glm::ivec2{column, top + i};
+                sprites.AtlasTexels[static_cast<size_t>(texel.y) * sprites.AtlasSize.x + texel.x] = glm::u8vec2{readByte(source + i), 255};
+            }
+
+            offset += length + 4;
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include <map>
+#include <print>
+#include <algorithm>
+#include <Creepy/Texture.hpp>
+#include <Creepy/TextureCache.hpp>
+#include <Creepy/MipChain.hpp>
+
+static size_t getLayerOffset(const TextureArray& textureArray, int layer, int level);
+
+TextureArray TextureArray::createIndexed(int width, int height, int layers, int levels) {
+    TextureArray textureArray{};
+    textureArray.Width = width;
+    textureArray.Height = height;
+    textureArray.Layers = layers;
+    textureArray.Levels = levels;
+
+    // Integer format, filtering would blend indices not colors, the shader pick the level itself
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &textureArray.Id);
+    glTextureStorage3D(textureArray.Id, levels, GL_R8UI, width, height, layers);
+    glTextureParameteri(textureArray.Id, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(textureArray.Id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    size_t numTexels{};
+    for(int level{}; level < levels; ++level){
+        numTexels += static_cast<size_t>(std::max(width >> level, 1)) * std::max(height >> level, 1) * layers;
+    }
+    textureArray.Texels.assign(numTexels, 0);
+    return textureArray;
+}
+
+void TextureArray::uploadLayer(int layer, std::span<const uint8_t> indices, int level) {
+    const int width = std::max(Width >> level, 1);
+    const int height = std::max(Height >> level, 1);
+    if(layer < 0 || layer >= Layers || level < 0 || level >= Levels || indices.size() < static_cast<size_t>(width) * height){
+        return;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage3D(Id, level, 0, 0, layer, width, height, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, indices.data());
+
+    std::copy_n(indices.begin(), static_cast<size_t>(width) * height, Texels.begin() + getLayerOffset(*this, layer, level));
+}
+
+std::span<const uint8_t> TextureArray::getLayer(int layer, int level) const {
+    if(layer < 0 || layer >= Layers || level < 0 || level >= Levels){
+        return {};
+    }
+
+    const size_t layerSize = static_cast<size_t>(std::max(Width >> level, 1)) * std::max(Height >> level, 1);
+    return std::span{Texels}.subspan(getLayerOffset(*this, layer, level), layerSize);
+}
+
+TextureAtlas TextureAtlas::build(const TextureCache& textureCache, size_t budgetBytes) {
+    TextureAtlas atlas{};
+    atlas.Locations.resize(textureCache.Textures.size(), glm::ivec2{-1});
+    atlas.Slots.resize(textureCache.Textures.size(), -1);
+    atlas.SlotLayers.assign(1, 0);
+
+    // Size -> textures, map keep the class order stable between runs
+    // Textures kept from older levels stay in RAM only, VRAM hold just the current level
+    std::map<std::pair<int, int>, std::vector<size_t>> sizeClasses;
+    for(size_t i{}; i < textureCache.Textures.size(); ++i){
+        auto&& texture = textureCache.Textures[i];
+        if(!textureCache.isInLevel(texture)){
+            continue;
+        }
+
+        sizeClasses[{texture.Width, texture.Height}].push_back(i);
+    }
+
+    auto getArrayBytes = [](std::pair<int, int> size, size_t layers, int levels){
+        size_t bytes{};
+        for(int level{}; level < levels; ++level){
+            bytes += static_cast<size_t>(std::max(size.first >> level, 1)) * static_cast<size_t>(std::max(size.second >> level, 1)) * layers;
+        }
+        return bytes;
+    };
+
+    std::vector<uint8_t> rows;
+    size_t usedBytes{}, numSkipped{};
+    for(auto&& [size, textures] : sizeClasses){
+        // Mips only when every layer has them, a missing level would sample as 0
+        const bool hasMips = std::ranges::all_of(textures, [&textureCache](size_t index){ return !textureCache.Textures[index].Mips.empty(); });
+        int levels = hasMips ? MipChain::getLevelCount(size.first, size.second) : 1;
+
+        if(usedBytes + getArrayBytes(size, textures.size(), levels) > budgetBytes){
+            levels = 1;
+        }
+        if(usedBytes + getArrayBytes(size, textures.size(), levels) > budgetBytes){
+            numSkipped += textures.size();
+            continue;
+        }
+        usedBytes += getArrayBytes(size, textures.size(), levels);
+
+        auto& textureArray = atlas.Arrays.emplace_back(TextureArray::createIndexed(size.first, size.second, static_cast<int>(textures.size()), levels));
+
+        for(int layer{}; auto index : textures){
+            auto&& texture = textureCache.Textures[index];
+            const uint8_t* columns = texture.Texels.data();
+
+            for(int level{}; level < levels; ++level){
+                // Cache is column major like patches, GL want rows
+                const int width = std::max(texture.Width >> level, 1);
+                const int height = std::max(texture.Height >> level, 1);
+                rows.resize(static_cast<size_t>(width) * height);
+                for(int u{}; u < width; ++u){
+                    for(int v{}; v < height; ++v){
+                        rows[v * width + u] = columns[u * height + v];
+                    }
+                }
+
+                textureArray.uploadLayer(layer, rows, level);
+                columns = level == 0 ? texture.Mips.data() : columns + rows.size();
+            }
+
+            atlas.Slots[index] = static_cast<int>(atlas.SlotLayers.size());
+            atlas.SlotLayers.push_back(static_cast<uint32_t>(layer));
+            atlas.Locations[index] = glm::ivec2{static_cast<int>(atlas.Arrays.size() - 1), layer++};
+        }
+    }
+
+    if(numSkipped > 0){
+        std::println("Texture Atlas: {} KiB Of {} KiB, {} Textures Over Budget Use The Placeholder", usedBytes >> 10, budgetBytes >> 10, numSkipped);
+    }
+
+    return atlas;
+}
+
+void TextureAtlas::release() {
+    for(auto&& textureArray : Arrays){
+        glDeleteTextures(1, &textureArray.Id);
+    }
+
+    *this = TextureAtlas{};
+}
+
+bool TextureAtlas::animate(std::span<const int> wallFrames) {
+    bool hasChanged{false};
+    for(size_t i{}; i < Slots.size() && i < wallFrames.size(); ++i){
+        // Frames come from another table, one past our textures is skipped not read
+        const int frame = wallFrames[i];
+        if(Slots[i] < 0 || frame < 0 || static_cast<size_t>(frame) >= Locations.size() || Locations[frame].x != Locations[i].x){
+            continue;
+        }
+
+        auto& layer = SlotLayers[Slots[i]];
+        hasChanged |= layer != static_cast<uint32_t>(Locations[frame].y);
+        layer = static_cast<uint32_t>(Locations[frame].y);
+    }
+
+    return hasChanged;
+}
+
+size_t getLayerOffset(const TextureArray& textureArray, int layer, int level) {
+    size_t offset{};
+    for(int i{}; i < level; ++i){
+        offset += static_cast<size_t>(std::max(textureArray.Width >> i, 1)) * std::max(textureArray.Height >> i, 1) * textureArray.Layers;
+    }
+
+    return offset + static_cast<size_t>(std::max(textureArray.Width >> level, 1)) * std::max(textureArray.Height >> level, 1) * layer;
+}
@@ -0,0 +1,365 @@
+#include <print>
+#include <span>
+#include <limits>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <unordered_set>
+#include <Creepy/TextureCache.hpp>
+#include <Creepy/WAD.hpp>
+
+static std::vector<CompositeTexture> compose(const WAD& wadFile, std::span<const TextureDefinition> definitions, int numThreads);
+static std::vector<const Lump*> findPatches(const WAD& wadFile);
+static std::unordered_map<Name8, const Lump*> findFlats(const WAD& wadFile);
+static void composeTexture(const TextureDefinition& definition, std::span<const Lump* const> patches, CompositeTexture& texture);
+static void drawPatch(const Lump& patch, int originX, int originY, CompositeTexture& texture);
+static void evictTextures(TextureCache& cache);
+static void rebuildIndices(TextureCache& cache);
+
+TextureCache TextureCache::build(const WAD& wadFile, const Map& map, int numThreads) {
+    TextureCache cache{};
+    cache.loadLevel(wadFile, map, numThreads);
+    return cache;
+}
+
+TextureCache TextureCache::buildAll(const WAD& wadFile, int numThreads) {
+    const auto definitions = WAD::readTextureDefinitions(wadFile);
+    if(!definitions){
+        return {};
+    }
+
+    TextureCache cache{};
+    cache.Textures = compose(wadFile, definitions.value(), numThreads);
+    rebuildIndices(cache);
+    return cache;
+}
+
+void TextureCache::loadLevel(const WAD& wadFile, const Map& map, int numThreads) {
+    const auto startTime = std::chrono::steady_clock::now();
+    ++Level;
+    Stats = ResidencyStats{};
+
+    std::unordered_set<Name8> wallNames, flatNames;
+    for(auto&& sideDef : map.sideDefs){
+        wallNames.insert(sideDef.upperTexture);
+        wallNames.insert(sideDef.lowerTexture);
+        wallNames.insert(sideDef.middleTexture);
+    }
+
+    for(auto&& sector : map.sectors){
+        flatNames.insert(sector.floorTexture);
+        flatNames.insert(sector.ceilingTexture);
+    }
+
+    // Animation frames and switch sides come in with the one the map name
+    auto definitions = WAD::readTextureDefinitions(wadFile);
+    Animations = TextureAnimations::load(wadFile, definitions ? std::span<const TextureDefinition>{definitions.value()} : std::span<const TextureDefinition>{});
+    Animations.addFrames(wallNames, flatNames);
+
+    // Resident ones only get touched
+    for(auto& texture : Textures){
+        if(wallNames.contains(texture.Name)){
+            texture.LastUsedLevel = Level;
+            ++Stats.Reused;
+        }
+    }
+
+    for(auto& flat : Flats){
+        if(flatNames.contains(flat.Name)){
+            flat.LastUsedLevel = Level;
+            ++Stats.Reused;
+        }
+    }
+
+    if(definitions){
+        // First definition of a name win like vanilla, TEXTURE2 come after TEXTURE1
+        std::unordered_set<Name8> seen;
+        std::erase_if(definitions.value(), [&](const TextureDefinition& definition){
+            return !wallNames.contains(definition.Name) || Indices.contains(definition.Name) || !seen.insert(definition.Name).second;
+        });
+
+        for(auto& texture : compose(wadFile, definitions.value(), numThreads)){
+            texture.LastUsedLevel = Level;
+            Textures.push_back(std::move(texture));
+            ++Stats.Composed;
+        }
+    }
+    else {
+        std::println("No TEXTURE1, Walls Keep Placeholder Textures");
+    }
+
+    // Flats are raw 64 x 64 lumps, copying them is cheap enough to stay on this thread
+    const auto flatLumps = findFlats(wadFile);
+    for(auto&& name : flatNames){
+        const auto it = flatLumps.find(name);
+        if(FlatIndices.contains(name) || it == flatLumps.end()){
+            continue;
+        }
+
+        auto& flat = Flats.emplace_back();
+        flat.Name = name;
+        flat.Width = FlatSize;
+        flat.Height = FlatSize;
+        flat.Texels.resize(FlatSize * FlatSize);
+        std::transform(it->second->data.begin(), it->second->data.begin() + flat.Texels.size(), flat.Texels.begin(), [](std::byte texel){ return static_cast<uint8_t>(texel); });
+        flat.LastUsedLevel = Level;
+        ++Stats.Composed;
+    }
+
+    evictTextures(*this);
+    rebuildIndices(*this);
+
+    for(auto* textures : {&Textures, &Flats}){
+        for(auto&& texture : *textures){
+            Stats.ResidentBytes += texture.Texels.size() + texture.Mips.size();
+            Stats.LevelBytes += isInLevel(texture) ? texture.Texels.size() + texture.Mips.size() : 0;
+        }
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    Stats.Milliseconds = elapsed.count();
+
+    std::println("Textures: {} Flats: {} | Composed: {} Reused: {} Evicted: {} | Level: {} KiB Resident: {} / {} KiB | {:.3f} ms", 
+        Textures.size(), Flats.size(), Stats.Composed, Stats.Reused, Stats.Evicted, 
+        Stats.LevelBytes >> 10, Stats.ResidentBytes >> 10, BudgetBytes >> 10, Stats.Milliseconds);
+}
+
+int TextureCache::find(Name8 name) const {
+    const auto it = Indices.find(name);
+    return it != Indices.end() ? it->second : -1;
+}
+
+int TextureCache::findFlat(Name8 name) const {
+    const auto it = FlatIndices.find(name);
+    return it != FlatIndices.end() ? it->second : -1;
+}
+
+bool TextureCache::isInLevel(const CompositeTexture& texture) const {
+    return texture.LastUsedLevel == Level;
+}
+
+void TextureCache::benchmark(const WAD& wadFile, int numRuns) {
+    const auto definitions = WAD::readTextureDefinitions(wadFile);
+    if(!definitions){
+        std::println("No TEXTURE1 To Benchmark");
+        return;
+    }
+
+    const int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> threadCounts;
+    for(int count{1}; count < maxThreads; count *= 2){
+        threadCounts.push_back(count);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::println("Composing {} Textures, Best Of {} Runs", definitions->size(), numRuns);
+
+    float singleThreaded{};
+    for(int numThreads : threadCounts){
+        float best = std::numeric_limits<float>::max();
+        size_t numTexels{};
+
+        for(int run{}; run < numRuns; ++run){
+            const auto startTime = std::chrono::steady_clock::now();
+            const auto textures = compose(wadFile, definitions.value(), numThreads);
+            const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+            best = std::min(best, elapsed.count());
+
+            numTexels = 0;
+            for(auto&& texture : textures){
+                numTexels += texture.Texels.size();
+            }
+        }
+
+        if(numThreads == 1){
+            singleThreaded = best;
+        }
+
+        std::println("Threads: {:2} | {:.3f} ms | {} Texels | Speedup: {:.2f}x", numThreads, best, numTexels, best > 0.0f ? singleThreaded / best : 0.0f);
+    }
+}
+
+std::vector<CompositeTexture> compose(const WAD& wadFile, std::span<const TextureDefinition> definitions, int numThreads) {
+    if(definitions.empty()){
+        return {};
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const std::vector<const Lump*> patches = findPatches(wadFile);
+
+    std::vector<CompositeTexture> textures(definitions.size());
+
+    if(numThreads <= 0){
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // Each texture write only its own texels, workers just take the next index
+    std::atomic<size_t> nextTexture{};
+    auto worker = [&](){
+        for(size_t i = nextTexture.fetch_add(1); i < definitions.size(); i = nextTexture.fetch_add(1)){
+            composeTexture(definitions[i], patches, textures[i]);
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        for(int i{1}; i < std::min<int>(numThreads, static_cast<int>(definitions.size())); ++i){
+            workers.emplace_back(worker);
+        }
+
+        worker();
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    std::println("Textures: {} Composed From {} Patches In {:.3f} ms", textures.size(), patches.size(), elapsed.count());
+
+    return textures;
+}
+
+std::vector<const Lump*> findPatches(const WAD& wadFile) {
+    const auto patchNames = WAD::readPatchNames(wadFile);
+    if(!patchNames){
+        return {};
+    }
+
+    // One pass over the directory, later lumps override like PWADs do
+    std::unordered_map<Name8, const Lump*> lumps;
+    lumps.reserve(wadFile.lumps.size());
+    for(auto&& lump : wadFile.lumps){
+        lumps.insert_or_assign(lump.name, &lump);
+    }
+
+    // Null when PNAMES name a missing lump
+    std::vector<const Lump*> patches;
+    patches.reserve(patchNames->size());
+    for(auto&& name : patchNames.value()){
+        const auto it = lumps.find(name);
+        if(it == lumps.end()){
+            std::println("Missing Patch: {}", name.toString());
+        }
+
+        patches.push_back(it != lumps.end() ? it->second : nullptr);
+    }
+
+    return patches;
+}
+
+// Flats live between F_START and F_END, PWADs add theirs in FF_START and FF_END
+std::unordered_map<Name8, const Lump*> findFlats(const WAD& wadFile) {
+    std::unordered_map<Name8, const Lump*> flats;
+    bool isInFlats{false};
+
+    for(auto&& lump : wadFile.lumps){
+        if(lump.name == "F_START" || lump.name == "FF_START"){
+            isInFlats = true;
+        }
+        else if(lump.name == "F_END" || lump.name == "FF_END"){
+            isInFlats = false;
+        }
+        else if(isInFlats && lump.size >= FlatSize * FlatSize){
+            flats.insert_or_assign(lump.name, &lump);
+        }
+    }
+
+    return flats;
+}
+
+void composeTexture(const TextureDefinition& definition, std::span<const Lump* const> patches, CompositeTexture& texture) {
+    texture.Name = definition.Name;
+    texture.Width = std::max(definition.Width, 1);
+    texture.Height = std::max(definition.Height, 1);
+    texture.Texels.assign(static_cast<size_t>(texture.Width) * texture.Height, 0);
+
+    for(auto&& placement : definition.Patches){
+        if(placement.Patch < patches.size() && patches[placement.Patch] != nullptr){
+            drawPatch(*patches[placement.Patch], placement.OriginX, placement.OriginY, texture);
+        }
+    }
+}
+
+// Patch: width, height, left and top offset, one offset per column to its posts
+// Post: top delta, length, pad, texels, pad, 0xFF end the column
+void drawPatch(const Lump& patch, int originX, int originY, CompositeTexture& texture) {
+    auto readByte = [&patch](size_t index){
+        return static_cast<uint8_t>(patch.data[index]);
+    };
+
+    if(patch.size < 8){
+        return;
+    }
+
+    const int width = readByte(0) | readByte(1) << 8;
+
+    for(int column{}; column < width && 8 + static_cast<size_t>(column) * 4 + 4 <= patch.size; ++column){
+        const int x = originX + column;
+        if(x < 0 || x >= texture.Width){
+            continue;
+        }
+
+        size_t offset = readByte(8 + column * 4) | readByte(9 + column * 4) << 8 | readByte(10 + column * 4) << 16 | static_cast<size_t>(readByte(11 + column * 4)) << 24;
+        uint8_t* destination = texture.Texels.data() + static_cast<size_t>(x) * texture.Height;
+        int top{-1};
+
+        while(offset + 3 <= patch.size && readByte(offset) != 0xFF){
+            // Tall patches: a delta not past the last post is relative to it
+            const int delta = readByte(offset);
+            top = delta <= top ? top + delta : delta;
+
+            const int length = readByte(offset + 1);
+            const size_t source = offset + 3;
+
+            const int first = std::max(0, -(originY + top));
+            const int last = std::min({length, texture.Height - (originY + top), static_cast<int>(patch.size) - static_cast<int>(source)});
+            for(int i = first; i < last; ++i){
+                destination[originY + top + i] = readByte(source + i);
+            }
+
+            offset += length + 4;
+        }
+    }
+}
+
+// Textures of the current level always stay, older levels go oldest first until under budget
+void evictTextures(TextureCache& cache) {
+    size_t residentBytes{};
+    std::vector<std::pair<uint32_t, const CompositeTexture*>> candidates;
+
+    for(auto* textures : {&cache.Textures, &cache.Flats}){
+        for(auto&& texture : *textures){
+            residentBytes += texture.Texels.size() + texture.Mips.size();
+            if(!cache.isInLevel(texture)){
+                candidates.emplace_back(texture.LastUsedLevel, &texture);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto& left, const auto& right){ return left.first < right.first; });
+
+    std::unordered_set<const CompositeTexture*> evicted;
+    for(auto&& [lastUsed, texture] : candidates){
+        if(residentBytes <= cache.BudgetBytes){
+            break;
+        }
+
+        residentBytes -= texture->Texels.size() + texture->Mips.size();
+        evicted.insert(texture);
+    }
+
+    for(auto* textures : {&cache.Textures, &cache.Flats}){
+        cache.Stats.Evicted += static_cast<uint32_t>(std::erase_if(*textures, [&evicted](const CompositeTexture& texture){ return evicted.contains(&texture); }));
+    }
+}
+
+void rebuildIndices(TextureCache& cache) {
+    cache.Indices.clear();
+    cache.FlatIndices.clear();
+
+    for(int i{}; auto&& texture : cache.Textures){
+        cache.Indices.emplace(texture.Name, i++);
+    }
+
+    for(int i{}; auto&& flat : cache.Flats){
+        cache.FlatIndices.emplace(flat.Name, i++);
+    }
+}
@@ -0,0 +1,778 @@
+#include <print>
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <numbers>
+#include <optional>
+#include <algorithm>
+#include <condition_variable>
+#include <Creepy/TileRasterizer.hpp>
+#include <Creepy/Map.hpp>
+#include <Creepy/Texture.hpp>
+#include <Creepy/Palette.hpp>
+#include <Creepy/Sprites.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <immintrin.h>
+    #define CREEPY_X86_SIMD
+#endif
+
+constexpr int TileSize{64};
+constexpr float GuardBand{4.0f};            // Clip x, y at 4 viewports so float edge functions stay exact enough
+constexpr float SubPixelScale{16.0f};       // Vertices snap to 1/16 pixel like GL rasterizers
+constexpr glm::vec4 FogColor{0.2f, 0.2f, 0.2f, 1.0f};      // Same as fragment.frag
+constexpr size_t MaxClipVertices{9};        // Triangle plus one per clip plane
+
+struct ClipVertex{
+    glm::vec4 Clip;
+    glm::vec4 Color;
+    glm::vec3 View;
+    glm::vec2 TexCoord;
+};
+
+// Draw state and flat inputs, every triangle clipped from one primitive share them
+struct TriangleShading{
+    ShaderFeature Features{};
+    glm::vec4 Color{1.0f};                      // myColor, the palette lookup drop the vertex colors
+    const TextureArray* Texture{nullptr};
+    const SpriteSet* Sprites{nullptr};          // Set for billboards, they shade like sprite.frag
+    float LightLevel{255.0f};
+    int TextureSlot{};
+};
+
+struct RasterTriangle{
+    // Edge i is opposite vertex i, E(x, y) = EdgeX * (y - Origin.y) - EdgeY * (x - Origin.x), inside is positive
+    // Origin is the lower of the two end points so a shared edge give the exact negated value in both triangles
+    std::array<glm::vec2, 3> Origins;
+    std::array<float, 3> EdgeX, EdgeY;
+    std::array<bool, 3> IsTopLeft;
+    float InverseArea{};
+
+    // Depth is linear in screen space, the rest is divided by w for perspective correct interpolation
+    std::array<float, 3> Depths, InverseW;
+    std::array<glm::vec4, 3> Colors;
+    std::array<glm::vec3, 3> Views;
+    std::array<glm::vec2, 3> TexCoords;
+
+    // Screen gradients of the divided texcoord and 1 / w, the mip footprint is exact where dFdx take a quad difference
+    glm::vec2 TexCoordDx, TexCoordDy;
+    float InverseWDx{}, InverseWDy{};
+
+    TriangleShading Shading;
+    int MinX{}, MinY{}, MaxX{}, MaxY{};
+};
+
+static int s_width{}, s_height{};
+static int s_pitch{}, s_tilesX{}, s_tilesY{};      // Buffers are padded to whole tiles
+static std::vector<uint32_t> s_colors;
+static std::vector<float> s_depths;
+static std::vector<RasterTriangle> s_triangles;
+static std::vector<std::vector<uint32_t>> s_bins;   // Triangle indices per tile in submit order
+
+static glm::mat4 s_viewMatrix{1.0f}, s_projectionMatrix{1.0f};
+static ShaderFeature s_shaderFeatures{ShaderFeature::NONE};
+static uint32_t s_clearColor{};
+static RasterStats s_stats{};
+
+static std::array<glm::vec4, 256> s_paletteColors{};
+static ColorMap s_colorMap{};
+static std::vector<uint32_t> s_slotLayers;
+static const TextureArray* s_boundTexture{nullptr};
+static const SpriteSet* s_sprites{nullptr};
+static std::vector<SpriteInstance> s_spriteInstances;
+
+// Main thread raster tiles too, workers only help
+static std::vector<std::jthread> s_workers;
+static std::mutex s_mutex;
+static std::condition_variable_any s_jobCondition;
+static std::condition_variable s_doneCondition;
+static uint64_t s_generation{};
+static int s_activeWorkers{};
+static std::atomic<int> s_nextTile{};
+
+static void workerLoop(std::stop_token stopToken);
+static void rasterizeTiles();
+static void rasterizeTile(int tile);
+static void clipTriangle(const std::array<ClipVertex, 3>& triangle, const TriangleShading& shading);
+static void setupTriangle(const ClipVertex& vertex0, const ClipVertex& vertex1, const ClipVertex& vertex2, const TriangleShading& shading);
+static void binTriangle(uint32_t index);
+static uint32_t packColor(glm::vec4 color);
+static std::optional<glm::vec4> shadeFragment(const RasterTriangle& triangle, glm::vec4 color, glm::vec3 viewPosition, glm::vec2 texCoord, float w);
+static uint8_t sampleIndex(const RasterTriangle& triangle, glm::vec2 texCoord, float w);
+
+void TileRasterizer::init(int width, int height, int numThreads) {
+    shutdown();
+
+    s_width = width;
+    s_height = height;
+    s_tilesX = (width + TileSize - 1) / TileSize;
+    s_tilesY = (height + TileSize - 1) / TileSize;
+    s_pitch = s_tilesX * TileSize;
+
+    s_colors.assign(static_cast<size_t>(s_pitch) * s_tilesY * TileSize, 0);
+    s_depths.assign(s_colors.size(), 1.0f);
+    s_bins.assign(static_cast<size_t>(s_tilesX) * s_tilesY, {});
+
+    if(numThreads <= 0){
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // New workers see an old generation, nothing must be left to take
+    s_nextTile = static_cast<int>(s_bins.size());
+    for(int i{1}; i < numThreads; ++i){
+        s_workers.emplace_back(workerLoop);
+    }
+}
+
+void TileRasterizer::shutdown() {
+    for(auto& worker : s_workers){
+        worker.request_stop();
+    }
+
+    s_workers.clear();
+}
+
+void TileRasterizer::setViewMatrix(const glm::mat4& viewMatrix) {
+    s_viewMatrix = viewMatrix;
+}
+
+void TileRasterizer::setProjectionMatrix(const glm::mat4& projectionMatrix) {
+    s_projectionMatrix = projectionMatrix;
+}
+
+void TileRasterizer::setShaderFeatures(ShaderFeature features) {
+    s_shaderFeatures = features;
+}
+
+void TileRasterizer::setPalette(const Palette& palette, const ColorMap& colorMap) {
+    // Same values as the RGBA8 palette texture
+    for(size_t i{}; i < palette.Colors.size(); ++i){
+        s_paletteColors[i] = glm::vec4{glm::vec3{palette.Colors[i]} / 255.0f, 1.0f};
+    }
+
+    s_colorMap = colorMap;
+}
+
+void TileRasterizer::setTextureRemap(std::span<const uint32_t> slotLayers) {
+    s_slotLayers.assign(slotLayers.begin(), slotLayers.end());
+}
+
+void TileRasterizer::bindTexture(const TextureArray& textureArray) {
+    s_boundTexture = &textureArray;
+}
+
+void TileRasterizer::setSprites(const SpriteSet& sprites, std::span<const SpriteInstance> instances) {
+    s_sprites = &sprites;
+    s_spriteInstances.assign(instances.begin(), instances.end());
+}
+
+void TileRasterizer::beginFrame(const glm::vec4& clearColor) {
+    s_clearColor = packColor(clearColor);
+    s_triangles.clear();
+    for(auto& bin : s_bins){
+        bin.clear();
+    }
+
+    s_stats = RasterStats{};
+}
+
+void TileRasterizer::drawMeshRanges(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::span<const MeshRange> ranges, const glm::mat4& transform, const glm::vec4& color) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const glm::mat4 modelView = s_viewMatrix * transform;
+
+    TriangleShading shading{};
+    shading.Features = s_shaderFeatures;
+    shading.Color = color;
+    shading.Texture = s_boundTexture;
+
+    for(auto&& range : ranges){
+        const uint32_t lastIndex = std::min<uint32_t>(range.FirstIndex + range.NumIndices, static_cast<uint32_t>(indices.size()));
+
+        for(uint32_t i = range.FirstIndex; i + 3 <= lastIndex; i += 3){
+            std::array<ClipVertex, 3> triangle;
+
+            // Same as vertex.vert, myColor multiply in fragment.frag is linear so it can be done per vertex
+            for(uint32_t k{}; k < 3; ++k){
+                auto&& vertex = vertices[indices[i + k]];
+                const glm::vec4 viewPosition = modelView * glm::vec4{vertex.Position, 1.0f};
+                triangle[k] = ClipVertex{s_projectionMatrix * viewPosition, color * vertex.Color, glm::vec3{viewPosition}, vertex.TexCoord};
+            }
+
+            // Flat inputs come from the last vertex like GL provoking vertex
+            auto&& provokingVertex = vertices[indices[i + 2]];
+            shading.LightLevel = provokingVertex.LightLevel;
+            shading.TextureSlot = static_cast<int>(provokingVertex.TextureSlot);
+
+            ++s_stats.Triangles;
+            clipTriangle(triangle, shading);
+        }
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    s_stats.BinMilliseconds += elapsed.count();
+}
+
+void TileRasterizer::drawSprites(std::span<const SpriteRange> ranges) {
+    if(s_sprites == nullptr){
+        return;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const glm::vec3 eyePosition{glm::inverse(s_viewMatrix)[3]};
+    // Camera right flattened, sprites never tilt with the pitch
+    const glm::vec3 right = glm::normalize(glm::vec3{s_viewMatrix[0][0], 0.0f, s_viewMatrix[2][0]});
+    constexpr float Pi{std::numbers::pi_v<float>};
+
+    TriangleShading shading{};
+    shading.Sprites = s_sprites;
+
+    for(auto&& range : ranges){
+        const uint32_t lastInstance = std::min<uint32_t>(range.FirstInstance + range.NumInstances, static_cast<uint32_t>(s_spriteInstances.size()));
+
+        for(uint32_t i = range.FirstInstance; i < lastInstance; ++i){
+            auto&& instance = s_spriteInstances[i];
+            if(instance.Frame >= s_sprites->Frames.size()){
+                continue;
+            }
+
+            // Same rotation as sprite.vert, GLSL mod floor toward minus infinity
+            const glm::vec2 toEye = glm::vec2{eyePosition.x, eyePosition.z} - glm::vec2{instance.Position.x, instance.Position.z};
+            const float angle = std::atan2(toEye.y, toEye.x) - instance.Angle + Pi / 8.0f;
+            const float wrappedAngle = angle - 2.0f * Pi * std::floor(angle / (2.0f * Pi));
+            const int rotation = std::min(static_cast<int>(wrappedAngle / (Pi / 4.0f)), NumRotations - 1);
+
+            auto&& frame = s_sprites->Frames[instance.Frame];
+            if(frame.Images[rotation] >= s_sprites->Images.size()){
+                continue;
+            }
+
+            auto&& image = s_sprites->Images[frame.Images[rotation]];
+            const bool isFlipped = (frame.FlipMask >> rotation) & 1u;
+
+            // Strip 0 1 2 3 is top left, top right, bottom left, bottom right
+            std::array<ClipVertex, 4> corners;
+            for(int k{}; k < 4; ++k){
+                const glm::vec2 corner{static_cast<float>(k & 1), static_cast<float>(k >> 1)};
+                const float x = corner.x * static_cast<float>(image.Width) - static_cast<float>(image.LeftOffset);
+                const float y = static_cast<float>(image.TopOffset) - corner.y * static_cast<float>(image.Height);
+                const glm::vec3 position = instance.Position + (right * x + glm::vec3{0.0f, y, 0.0f}) / MapScaleFactor;
+                const glm::vec2 atlasTexCoord = glm::vec2{image.AtlasPosition} + glm::vec2{isFlipped ? 1.0f - corner.x : corner.x, corner.y} * glm::vec2{image.Width, image.Height};
+
+                const glm::vec4 viewPosition = s_viewMatrix * glm::vec4{position, 1.0f};
+                corners[k] = ClipVertex{s_projectionMatrix * viewPosition, glm::vec4{1.0f}, glm::vec3{viewPosition}, atlasTexCoord};
+            }
+
+            shading.LightLevel = instance.LightLevel;
+            s_stats.Triangles += 2;
+            ++s_stats.Sprites;
+            clipTriangle({corners[0], corners[1], corners[2]}, shading);
+            clipTriangle({corners[2], corners[1], corners[3]}, shading);
+        }
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    s_stats.BinMilliseconds += elapsed.count();
+}
+
+void TileRasterizer::endFrame() {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard lock{s_mutex};
+        s_nextTile = 0;
+        ++s_generation;
+    }
+    s_jobCondition.notify_all();
+
+    rasterizeTiles();
+
+    {
+        std::unique_lock lock{s_mutex};
+        s_doneCondition.wait(lock, []{ return s_nextTile >= static_cast<int>(s_bins.size()) && s_activeWorkers == 0; });
+    }
+
+    // Drop the tile padding so rows are packed for the blit, moving forward never overwrite an unread row
+    if(s_pitch != s_width){
+        for(int y{1}; y < s_height; ++y){
+            std::memmove(s_colors.data() + static_cast<size_t>(y) * s_width, s_colors.data() + static_cast<size_t>(y) * s_pitch, s_width * sizeof(uint32_t));
+        }
+    }
+
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    s_stats.Tiles = static_cast<uint32_t>(s_bins.size());
+    s_stats.Threads = static_cast<uint32_t>(s_workers.size() + 1);
+    s_stats.RasterMilliseconds = elapsed.count();
+}
+
+std::span<const uint8_t> TileRasterizer::getColorBuffer() {
+    return {reinterpret_cast<const uint8_t*>(s_colors.data()), static_cast<size_t>(s_width) * s_height * 4};
+}
+
+glm::ivec2 TileRasterizer::getSize() {
+    return {s_width, s_height};
+}
+
+const RasterStats& TileRasterizer::getStats() {
+    return s_stats;
+}
+
+void workerLoop(std::stop_token stopToken) {
+    uint64_t generation{};
+
+    while(true){
+        {
+            std::unique_lock lock{s_mutex};
+            if(!s_jobCondition.wait(lock, stopToken, [&]{ return s_generation != generation; })){
+                return;
+            }
+
+            generation = s_generation;
+            ++s_activeWorkers;
+        }
+
+        rasterizeTiles();
+
+        {
+            std::lock_guard lock{s_mutex};
+            --s_activeWorkers;
+        }
+        s_doneCondition.notify_one();
+    }
+}
+
+void rasterizeTiles() {
+    const int numTiles = static_cast<int>(s_bins.size());
+
+    for(int tile = s_nextTile.fetch_add(1); tile < numTiles; tile = s_nextTile.fetch_add(1)){
+        rasterizeTile(tile);
+    }
+}
+
+void clipTriangle(const std::array<ClipVertex, 3>& triangle, const TriangleShading& shading) {
+    // Near plane as GL, x and y at the guard band, w > 0 follow from the near plane
+    constexpr std::array<glm::vec4, 5> clipPlanes{
+        glm::vec4{0.0f, 0.0f, 1.0f, 1.0f},
+        glm::vec4{-1.0f, 0.0f, 0.0f, GuardBand}, glm::vec4{1.0f, 0.0f, 0.0f, GuardBand},
+        glm::vec4{0.0f, -1.0f, 0.0f, GuardBand}, glm::vec4{0.0f, 1.0f, 0.0f, GuardBand}
+    };
+
+    // Whole triangle out of one view side, near and far included
+    constexpr std::array<glm::vec4, 6> viewPlanes{
+        glm::vec4{0.0f, 0.0f, 1.0f, 1.0f}, glm::vec4{0.0f, 0.0f, -1.0f, 1.0f},
+        glm::vec4{-1.0f, 0.0f, 0.0f, 1.0f}, glm::vec4{1.0f, 0.0f, 0.0f, 1.0f},
+        glm::vec4{0.0f, -1.0f, 0.0f, 1.0f}, glm::vec4{0.0f, 1.0f, 0.0f, 1.0f}
+    };
+
+    for(auto&& plane : viewPlanes){
+        if(glm::dot(plane, triangle[0].Clip) < 0.0f && glm::dot(plane, triangle[1].Clip) < 0.0f && glm::dot(plane, triangle[2].Clip) < 0.0f){
+            return;
+        }
+    }
+
+    std::array<ClipVertex, MaxClipVertices> polygon, clipped;
+    std::copy(triangle.begin(), triangle.end(), polygon.begin());
+    size_t numVertices{3};
+
+    for(auto&& plane : clipPlanes){
+        std::array<float, MaxClipVertices> distances;
+        bool isAllInside{true};
+        for(size_t i{}; i < numVertices; ++i){
+            distances[i] = glm::dot(plane, polygon[i].Clip);
+            isAllInside &= distances[i] >= 0.0f;
+        }
+
+        if(isAllInside){
+            continue;
+        }
+
+        // Sutherland Hodgman
+        size_t numClipped{};
+        for(size_t i{}; i < numVertices; ++i){
+            const size_t next = (i + 1) % numVertices;
+
+            if(distances[i] >= 0.0f){
+                clipped[numClipped++] = polygon[i];
+            }
+
+            if((distances[i] >= 0.0f) != (distances[next] >= 0.0f)){
+                const float t = distances[i] / (distances[i] - distances[next]);
+                auto&& from = polygon[i];
+                auto&& to = polygon[next];
+                clipped[numClipped++] = ClipVertex{
+                    from.Clip + (to.Clip - from.Clip) * t,
+                    from.Color + (to.Color - from.Color) * t,
+                    from.View + (to.View - from.View) * t,
+                    from.TexCoord + (to.TexCoord - from.TexCoord) * t
+                };
+            }
+        }
+
+        polygon = clipped;
+        numVertices = numClipped;
+        if(numVertices < 3){
+            return;
+        }
+    }
+
+    for(size_t i{2}; i < numVertices; ++i){
+        setupTriangle(polygon[0], polygon[i - 1], polygon[i], shading);
+    }
+}
+
+void setupTriangle(const ClipVertex& vertex0, const ClipVertex& vertex1, const ClipVertex& vertex2, const TriangleShading& shading) {
+    RasterTriangle triangle{};
+    std::array<glm::vec2, 3> screen;
+
+    const std::array<const ClipVertex*, 3> vertices{&vertex0, &vertex1, &vertex2};
+    for(size_t i{}; i < 3; ++i){
+        auto&& vertex = *vertices[i];
+        const float inverseW = 1.0f / vertex.Clip.w;
+        const glm::vec3 ndc = glm::vec3{vertex.Clip} * inverseW;
+
+        // GL window space, flipped so row 0 is the top
+        screen[i] = glm::vec2{(ndc.x * 0.5f + 0.5f) * static_cast<float>(s_width), (0.5f - ndc.y * 0.5f) * static_cast<float>(s_height)};
+        screen[i] = glm::round(screen[i] * SubPixelScale) / SubPixelScale;
+
+        triangle.Depths[i] = ndc.z * 0.5f + 0.5f;
+        triangle.InverseW[i] = inverseW;
+        triangle.Colors[i] = vertex.Color * inverseW;
+        triangle.Views[i] = vertex.View * inverseW;
+        triangle.TexCoords[i] = vertex.TexCoord * inverseW;
+    }
+
+    // Edge i run from vertex i + 1 to i + 2, evaluated from the lower end point and negated when swapped
+    for(size_t i{}; i < 3; ++i){
+        glm::vec2 from = screen[(i + 1) % 3], to = screen[(i + 2) % 3];
+        const bool isSwapped = from.y > to.y || (from.y == to.y && from.x > to.x);
+        if(isSwapped){
+            std::swap(from, to);
+        }
+
+        triangle.Origins[i] = from;
+        triangle.EdgeX[i] = isSwapped ? -(to.x - from.x) : to.x - from.x;
+        triangle.EdgeY[i] = isSwapped ? -(to.y - from.y) : to.y - from.y;
+    }
+
+    auto evaluateEdge = [&triangle](size_t edge, glm::vec2 point){
+        return triangle.EdgeX[edge] * (point.y - triangle.Origins[edge].y) - triangle.EdgeY[edge] * (point.x - triangle.Origins[edge].x);
+    };
+
+    float area = evaluateEdge(0, screen[0]);
+    if(area == 0.0f){
+        return;
+    }
+
+    // No face culling in the GL path, flip clockwise ones so inside stay positive
+    if(area < 0.0f){
+        for(size_t i{}; i < 3; ++i){
+            triangle.EdgeX[i] = -triangle.EdgeX[i];
+            triangle.EdgeY[i] = -triangle.EdgeY[i];
+        }
+        area = -area;
+    }
+
+    // Pixel center exactly on an edge belong to the triangle on its right or below, never both
+    for(size_t i{}; i < 3; ++i){
+        const float gradientX = -triangle.EdgeY[i];
+        const float gradientY = triangle.EdgeX[i];
+        triangle.IsTopLeft[i] = gradientX > 0.0f || (gradientX == 0.0f && gradientY > 0.0f);
+    }
+
+    triangle.InverseArea = 1.0f / area;
+    triangle.Shading = shading;
+
+    // Weight i change by -EdgeY[i] / area along x and EdgeX[i] / area along y
+    for(size_t i{}; i < 3; ++i){
+        const float weightDx = -triangle.EdgeY[i] * triangle.InverseArea;
+        const float weightDy = triangle.EdgeX[i] * triangle.InverseArea;
+        triangle.TexCoordDx += triangle.TexCoords[i] * weightDx;
+        triangle.TexCoordDy += triangle.TexCoords[i] * weightDy;
+        triangle.InverseWDx += triangle.InverseW[i] * weightDx;
+        triangle.InverseWDy += triangle.InverseW[i] * weightDy;
+    }
+
+    // Pixel x is covered when its center x + 0.5 is inside
+    const glm::vec2 minScreen = glm::min(screen[0], glm::min(screen[1], screen[2]));
+    const glm::vec2 maxScreen = glm::max(screen[0], glm::max(screen[1], screen[2]));
+    triangle.MinX = std::max(0, static_cast<int>(std::ceil(minScreen.x - 0.5f)));
+    triangle.MinY = std::max(0, static_cast<int>(std::ceil(minScreen.y - 0.5f)));
+    triangle.MaxX = std::min(s_width - 1, static_cast<int>(std::floor(maxScreen.x - 0.5f)));
+    triangle.MaxY = std::min(s_height - 1, static_cast<int>(std::floor(maxScreen.y - 0.5f)));
+
+    if(triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY){
+        return;
+    }
+
+    s_triangles.push_back(triangle);
+    ++s_stats.ClippedTriangles;
+    binTriangle(static_cast<uint32_t>(s_triangles.size() - 1));
+}
+
+void binTriangle(uint32_t index) {
+    const auto& triangle = s_triangles[index];
+
+    for(int tileY = triangle.MinY / TileSize; tileY <= triangle.MaxY / TileSize; ++tileY){
+        for(int tileX = triangle.MinX / TileSize; tileX <= triangle.MaxX / TileSize; ++tileX){
+            // Skip tiles fully outside one edge, test the tile corner pixel that edge like most
+            bool isOutside{false};
+            for(size_t i{}; i < 3 && !isOutside; ++i){
+                const float cornerX = static_cast<float>(-triangle.EdgeY[i] > 0.0f ? tileX * TileSize + TileSize - 1 : tileX * TileSize) + 0.5f;
+                const float cornerY = static_cast<float>(triangle.EdgeX[i] > 0.0f ? tileY * TileSize + TileSize - 1 : tileY * TileSize) + 0.5f;
+                isOutside = triangle.EdgeX[i] * (cornerY - triangle.Origins[i].y) - triangle.EdgeY[i] * (cornerX - triangle.Origins[i].x) < 0.0f;
+            }
+
+            if(!isOutside){
+                s_bins[tileY * s_tilesX + tileX].push_back(index);
+                ++s_stats.BinnedTriangles;
+            }
+        }
+    }
+}
+
+uint32_t packColor(glm::vec4 color) {
+    // GL unorm conversion, clamp then round to nearest
+    const glm::vec4 scaled = glm::clamp(color, 0.0f, 1.0f) * 255.0f;
+    return static_cast<uint32_t>(std::nearbyint(scaled.r))
+        | static_cast<uint32_t>(std::nearbyint(scaled.g)) << 8
+        | static_cast<uint32_t>(std::nearbyint(scaled.b)) << 16
+        | static_cast<uint32_t>(std::nearbyint(scaled.a)) << 24;
+}
+
+// fragment.frag on one pixel, or sprite.frag for billboards, nothing when the fragment is discarded
+std::optional<glm::vec4> shadeFragment(const RasterTriangle& triangle, glm::vec4 color, glm::vec3 viewPosition, glm::vec2 texCoord, float w) {
+    const auto& shading = triangle.Shading;
+    const float distance = glm::length(viewPosition);
+
+    if(shading.Sprites != nullptr){
+        // Outside the atlas texelFetch read 0, a hole
+        const glm::ivec2 texel{texCoord};
+        const glm::ivec2 atlasSize = shading.Sprites->AtlasSize;
+        if(texel.x < 0 || texel.y < 0 || texel.x >= atlasSize.x || texel.y >= atlasSize.y){
+            return std::nullopt;
+        }
+
+        const glm::u8vec2 atlasTexel = shading.Sprites->AtlasTexels[static_cast<size_t>(texel.y) * atlasSize.x + texel.x];
+        if(atlasTexel.y == 0){
+            return std::nullopt;
+        }
+
+        return s_paletteColors[s_colorMap.Maps[getColorMapLevel(static_cast<int16_t>(shading.LightLevel), distance * MapScaleFactor)][atlasTexel.x]];
+    }
+
+    // COLORMAP already darken with distance, it replace the light diminishing
+    if(hasFeature(shading.Features, ShaderFeature::PALETTE)){
+        const uint8_t index = sampleIndex(triangle, texCoord, w);
+        const uint8_t shaded = s_colorMap.Maps[getColorMapLevel(static_cast<int16_t>(shading.LightLevel), distance * MapScaleFactor)][index];
+        color = shading.Color * s_paletteColors[shaded];
+    }
+    else if(hasFeature(shading.Features, ShaderFeature::LIGHT_DIMINISHING)){
+        color = glm::vec4{glm::vec3{color} * std::clamp(1.0f - distance / 40.0f, 0.25f, 1.0f), color.a};
+    }
+
+    if(hasFeature(shading.Features, ShaderFeature::FOG)){
+        color = glm::mix(color, FogColor, std::clamp(distance / 60.0f, 0.0f, 1.0f));
+    }
+
+    if(hasFeature(shading.Features, ShaderFeature::DEBUG_COLOR)){
+        color = glm::vec4{glm::fract(viewPosition * 0.5f), 1.0f};
+    }
+
+    return color;
+}
+
+// Same level pick, wrap and slot clamp as fragment.frag, reads out of the array give 0 like robust texelFetch
+uint8_t sampleIndex(const RasterTriangle& triangle, glm::vec2 texCoord, float w) {
+    const TextureArray* texture = triangle.Shading.Texture;
+    if(texture == nullptr || texture->Texels.empty()){
+        return 0;
+    }
+
+    // Quotient rule on texcoord / w over 1 / w
+    const glm::vec2 texCoordDx = (triangle.TexCoordDx - texCoord * triangle.InverseWDx) * w;
+    const glm::vec2 texCoordDy = (triangle.TexCoordDy - texCoord * triangle.InverseWDy) * w;
+    const glm::vec2 footprint = glm::max(glm::abs(texCoordDx), glm::abs(texCoordDy));
+    const int level = std::clamp(static_cast<int>(std::floor(std::log2(std::max(std::max(footprint.x, footprint.y), 1.0f)))), 0, texture->Levels - 1);
+
+    // Wrap at level 0 then scale
+    const glm::vec2 size{static_cast<float>(texture->Width), static_cast<float>(texture->Height)};
+    const glm::vec2 texel = glm::floor(texCoord);
+    const glm::ivec2 wrapped = glm::clamp(glm::ivec2{texel - size * glm::floor(texel / size)}, glm::ivec2{0}, glm::ivec2{texture->Width - 1, texture->Height - 1});
+    const int levelWidth = std::max(texture->Width >> level, 1);
+    const int levelHeight = std::max(texture->Height >> level, 1);
+    const int x = std::min(wrapped.x >> level, levelWidth - 1);
+    const int y = std::min(wrapped.y >> level, levelHeight - 1);
+
+    // Slots past the remap array read slot 0, past the CPU copy the GL buffer is zero
+    const int slot = triangle.Shading.TextureSlot >= 0 && static_cast<size_t>(triangle.Shading.TextureSlot) < MaxTextureSlots ? triangle.Shading.TextureSlot : 0;
+    const uint32_t layer = static_cast<size_t>(slot) < s_slotLayers.size() ? s_slotLayers[slot] : 0;
+
+    const auto texels = texture->getLayer(static_cast<int>(layer), level);
+    return texels.empty() ? 0 : texels[static_cast<size_t>(y) * levelWidth + x];
+}
+
+#ifdef CREEPY_X86_SIMD
+
+// Four pixels of a row per step, SSE2 is baseline on x86-64
+void rasterizeTile(int tile) {
+    const int tileX = (tile % s_tilesX) * TileSize;
+    const int tileY = (tile / s_tilesX) * TileSize;
+
+    for(int y = tileY; y < tileY + TileSize; ++y){
+        std::fill_n(s_colors.data() + static_cast<size_t>(y) * s_pitch + tileX, TileSize, s_clearColor);
+        std::fill_n(s_depths.data() + static_cast<size_t>(y) * s_pitch + tileX, TileSize, 1.0f);
+    }
+
+    const __m128 laneX = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for(uint32_t index : s_bins[tile]){
+        const auto& triangle = s_triangles[index];
+
+        // x start aligned to the lane group, lanes left of the triangle fail the edge test
+        const int firstX = std::max(triangle.MinX, tileX) & ~3;
+        const int lastX = std::min(triangle.MaxX, tileX + TileSize - 1);
+        const int firstY = std::max(triangle.MinY, tileY);
+        const int lastY = std::min(triangle.MaxY, tileY + TileSize - 1);
+
+        __m128 edgeX[3], edgeY[3], originX[3], originY[3], topLeft[3];
+        for(size_t i{}; i < 3; ++i){
+            edgeX[i] = _mm_set1_ps(triangle.EdgeX[i]);
+            edgeY[i] = _mm_set1_ps(triangle.EdgeY[i]);
+            originX[i] = _mm_set1_ps(triangle.Origins[i].x);
+            originY[i] = _mm_set1_ps(triangle.Origins[i].y);
+            topLeft[i] = _mm_castsi128_ps(_mm_set1_epi32(triangle.IsTopLeft[i] ? -1 : 0));
+        }
+
+        const __m128 inverseArea = _mm_set1_ps(triangle.InverseArea);
+
+        auto interpolate = [](const __m128* weights, float value0, float value1, float value2){
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(weights[0], _mm_set1_ps(value0)), _mm_mul_ps(weights[1], _mm_set1_ps(value1))), _mm_mul_ps(weights[2], _mm_set1_ps(value2)));
+        };
+
+        for(int y = firstY; y <= lastY; ++y){
+            const __m128 pixelY = _mm_set1_ps(static_cast<float>(y) + 0.5f);
+            __m128 rowY[3];
+            for(size_t i{}; i < 3; ++i){
+                rowY[i] = _mm_mul_ps(edgeX[i], _mm_sub_ps(pixelY, originY[i]));
+            }
+
+            uint32_t* colorRow = s_colors.data() + static_cast<size_t>(y) * s_pitch;
+            float* depthRow = s_depths.data() + static_cast<size_t>(y) * s_pitch;
+
+            for(int x = firstX; x <= lastX; x += 4){
+                const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneX);
+
+                __m128 weights[3];
+                __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for(size_t i{}; i < 3; ++i){
+                    const __m128 edge = _mm_sub_ps(rowY[i], _mm_mul_ps(edgeY[i], _mm_sub_ps(pixelX, originX[i])));
+                    mask = _mm_and_ps(mask, _mm_or_ps(_mm_cmpgt_ps(edge, zero), _mm_and_ps(_mm_cmpeq_ps(edge, zero), topLeft[i])));
+                    weights[i] = _mm_mul_ps(edge, inverseArea);
+                }
+
+                if(_mm_movemask_ps(mask) == 0){
+                    continue;
+                }
+
+                // GL_LESS against the cleared 1.0, fragments past the far plane are dropped
+                const __m128 depth = interpolate(weights, triangle.Depths[0], triangle.Depths[1], triangle.Depths[2]);
+                const __m128 oldDepth = _mm_loadu_ps(depthRow + x);
+                mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmplt_ps(depth, oldDepth), _mm_and_ps(_mm_cmpge_ps(depth, zero), _mm_cmple_ps(depth, one))));
+
+                const int laneMask = _mm_movemask_ps(mask);
+                if(laneMask == 0){
+                    continue;
+                }
+
+                const __m128 w = _mm_div_ps(one, interpolate(weights, triangle.InverseW[0], triangle.InverseW[1], triangle.InverseW[2]));
+
+                // Color, view position, texcoord then w
+                alignas(16) std::array<std::array<float, 4>, 10> attributes;
+                for(int component{}; component < 4; ++component){
+                    _mm_store_ps(attributes[component].data(), _mm_mul_ps(w, interpolate(weights, triangle.Colors[0][component], triangle.Colors[1][component], triangle.Colors[2][component])));
+                }
+                for(int component{}; component < 3; ++component){
+                    _mm_store_ps(attributes[4 + component].data(), _mm_mul_ps(w, interpolate(weights, triangle.Views[0][component], triangle.Views[1][component], triangle.Views[2][component])));
+                }
+                for(int component{}; component < 2; ++component){
+                    _mm_store_ps(attributes[7 + component].data(), _mm_mul_ps(w, interpolate(weights, triangle.TexCoords[0][component], triangle.TexCoords[1][component], triangle.TexCoords[2][component])));
+                }
+                _mm_store_ps(attributes[9].data(), w);
+
+                // Shading branch on per draw features, scalar per lane keep it identical to the reference
+                alignas(16) std::array<int32_t, 4> keptLanes{};
+                for(int lane{}; lane < 4; ++lane){
+                    if(!(laneMask & (1 << lane))){
+                        continue;
+                    }
+
+                    const glm::vec4 color{attributes[0][lane], attributes[1][lane], attributes[2][lane], attributes[3][lane]};
+                    const glm::vec3 viewPosition{attributes[4][lane], attributes[5][lane], attributes[6][lane]};
+                    const glm::vec2 texCoord{attributes[7][lane], attributes[8][lane]};
+                    if(const auto shaded = shadeFragment(triangle, color, viewPosition, texCoord, attributes[9][lane])){
+                        colorRow[x + lane] = packColor(*shaded);
+                        keptLanes[lane] = -1;
+                    }
+                }
+
+                // Discarded fragments leave the depth alone
+                const __m128 keptMask = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(keptLanes.data())));
+                _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(keptMask, depth), _mm_andnot_ps(keptMask, oldDepth)));
+            }
+        }
+    }
+}
+
+#else
+
+void rasterizeTile(int tile) {
+    const int tileX = (tile % s_tilesX) * TileSize;
+    const int tileY = (tile / s_tilesX) * TileSize;
+
+    for(int y = tileY; y < tileY + TileSize; ++y){
+        std::fill_n(s_colors.data() + static_cast<size_t>(y) * s_pitch + tileX, TileSize, s_clearColor);
+        std::fill_n(s_depths.data() + static_cast<size_t>(y) * s_pitch + tileX, TileSize, 1.0f);
+    }
+
+    for(uint32_t index : s_bins[tile]){
+        const auto& triangle = s_triangles[index];
+
+        for(int y = std::max(triangle.MinY, tileY); y <= std::min(triangle.MaxY, tileY + TileSize - 1); ++y){
+            for(int x = std::max(triangle.MinX, tileX); x <= std::min(triangle.MaxX, tileX + TileSize - 1); ++x){
+                const glm::vec2 pixel{static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f};
+
+                std::array<float, 3> weights;
+                bool isInside{true};
+                for(size_t i{}; i < 3; ++i){
+                    const float edge = triangle.EdgeX[i] * (pixel.y - triangle.Origins[i].y) - triangle.EdgeY[i] * (pixel.x - triangle.Origins[i].x);
+                    isInside &= edge > 0.0f || (edge == 0.0f && triangle.IsTopLeft[i]);
+                    weights[i] = edge * triangle.InverseArea;
+                }
+
+                float& oldDepth = s_depths[static_cast<size_t>(y) * s_pitch + x];
+                const float depth = weights[0] * triangle.Depths[0] + weights[1] * triangle.Depths[1] + weights[2] * triangle.Depths[2];
+                if(!isInside || !(depth < oldDepth) || depth < 0.0f || depth > 1.0f){
+                    continue;
+                }
+
+                const float w = 1.0f / (weights[0] * triangle.InverseW[0] + weights[1] * triangle.InverseW[1] + weights[2] * triangle.InverseW[2]);
+                const glm::vec4 color = (triangle.Colors[0] * weights[0] + triangle.Colors[1] * weights[1] + triangle.Colors[2] * weights[2]) * w;
+                const glm::vec3 viewPosition = (triangle.Views[0] * weights[0] + triangle.Views[1] * weights[1] + triangle.Views[2] * weights[2]) * w;
+                const glm::vec2 texCoord = (triangle.TexCoords[0] * weights[0] + triangle.TexCoords[1] * weights[1] + triangle.TexCoords[2] * weights[2]) * w;
+
+                // Discarded fragments leave the depth alone
+                if(const auto shaded = shadeFragment(triangle, color, viewPosition, texCoord, w)){
+                    oldDepth = depth;
+                    s_colors[static_cast<size_t>(y) * s_pitch + x] = packColor(*shaded);
+                }
+            }
+        }
+    }
+}
+
+#endif
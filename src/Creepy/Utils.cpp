@@ -7,6 +7,19 @@ std::string readShaderFile(const std::filesystem::path& filePath){
     return {std::istreambuf_iterator<char>{fileIn}, std::istreambuf_iterator<char>{}};
 }
 
+std::vector<std::byte> readBinaryFile(const std::filesystem::path& filePath) {
+    std::ifstream fileIn{filePath, std::ios::binary | std::ios::ate};
+
+    if(!fileIn.good()){
+        return {};
+    }
+
+    std::vector<std::byte> data(fileIn.tellg());
+    fileIn.seekg(0u);
+    fileIn.read(std::bit_cast<char*>(data.data()), data.size());
+    return data;
+}
+
 GLuint compileShader(GLenum type, std::string_view src) {
     GLuint shader = glCreateShader(type);
 
@@ -25,13 +38,36 @@ GLuint compileShader(GLenum type, std::string_view src) {
     return shader;
 }
 
-GLuint linkProgram(std::span<const GLuint> shaders){
+GLuint loadSpirvShader(GLenum type, std::span<const std::byte> binary, 
+    std::span<const GLuint> constantIndices, std::span<const GLuint> constantValues) {
+    GLuint shader = glCreateShader(type);
+
+    glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, binary.data(), static_cast<GLsizei>(binary.size()));
+    glSpecializeShader(shader, "main", static_cast<GLuint>(constantIndices.size()), constantIndices.data(), constantValues.data());
+
+    GLint success{};
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+    if(!success){
+        char buffer[512];
+        glGetShaderInfoLog(shader, sizeof(buffer), nullptr, buffer);
+        std::println("Failed: {}", buffer);
+    }
+
+    return shader;
+}
+
+GLuint linkProgram(std::span<const GLuint> shaders, bool retrievableBinary){
     GLuint64 program = glCreateProgram();
 
     for(auto shader : shaders){
         glAttachShader(program, shader);
     }
 
+    if(retrievableBinary){
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     glLinkProgram(program);
 
     GLint success{};
@@ -43,4 +79,13 @@ GLuint linkProgram(std::span<const GLuint> shaders){
     }
 
     return program;
+}
+
+uint64_t hashBytes(std::span<const std::byte> data, uint64_t seed) {
+    constexpr uint64_t prime{0x100000001b3ull};
+    for(auto byte : data){
+        seed ^= static_cast<uint64_t>(byte);
+        seed *= prime;
+    }
+    return seed;
 }
\ No newline at end of file
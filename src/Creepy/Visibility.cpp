@@ -0,0 +1,541 @@
+#include <array>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <chrono>
+#include <algorithm>
+#include <Creepy/Visibility.hpp>
+#include <Creepy/BSP.hpp>
+#include <Creepy/Frustum.hpp>
+#include <Creepy/ScreenClipper.hpp>
+#include <Creepy/PortalCulling.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Columns are measured around the yaw only, a solid wall hide everything behind it 
+// over its horizontal angle whatever the pitch is
+struct ColumnProjection{
+    glm::vec2 Origin, Forward, Right;
+    float InverseTanHalf{};     // 0 when pitch make the horizontal range unbounded
+    float HalfWidth{};
+
+    bool isValid() const;
+    glm::vec2 toView(glm::vec2 point) const;
+
+    // Column span of the polygon (or segment) clipped to near plane, false if fully behind
+    bool project(std::span<const glm::vec2> points, float& minColumn, float& maxColumn) const;
+};
+
+constexpr float NearDistance{1.0f};
+
+static const Map* s_map{nullptr};
+static const GLMap* s_glMap{nullptr};
+
+static std::vector<BoundingBox> s_subSectorBounds;
+static BoundsSoA s_subSectorBoundsSoA{};
+static std::vector<uint32_t> s_frustumSubSectors;
+static std::vector<uint32_t> s_subSectorFrustumFrames;     // Last frame subsector passed the batched frustum test
+static std::vector<uint16_t> s_subSectorSectors;
+
+// Both child boxes of every node, index node * 2 + side like BSP::traverse give
+static BoundsSoA s_nodeBoundsSoA{};
+static std::vector<uint32_t> s_frustumNodeBoxes;
+static std::vector<uint32_t> s_nodeBoxFrustumFrames;
+
+static const PVS* s_pvs{nullptr};
+static std::vector<uint8_t> s_pvsRow;
+static int32_t s_pvsRowSector{-1};
+static float s_minHeight{}, s_maxHeight{};
+
+static std::vector<uint32_t> s_lineDefFrames;       // Last frame LineDef was emitted
+static uint32_t s_frame{};
+static std::vector<uint32_t> s_visibleLineDefs;
+static std::vector<uint16_t> s_visibleSubSectors;      // Last full walk, the guard band keep it valid on cache hits
+static BoundsSoA s_lineDefBounds{};
+static VisibilityStats s_stats{};
+
+// Candidates from the last full walk with a widened view, revalidated each frame with the real frustum
+struct VisibilityCache{
+    bool IsValid{};
+    uint16_t SubSector{};
+    glm::vec3 Position, Forward;
+    glm::mat4 Projection;
+    int ScreenWidth{};
+    uint32_t Age{};
+    VisibilityStats Stats;
+    std::vector<uint32_t> LineDefs;
+    BoundsSoA Bounds;
+};
+
+constexpr float CacheGuardAngle{0.1745f};       // 10 degree widening on each frustum side
+// Only turning reuse the walk, from the same spot occlusion and portals do not change
+// Any step can open a line past a doorway edge, so moving always recompute
+constexpr float MaxCacheTranslation{0.01f};     // Map units, interpolation noise
+constexpr uint32_t MaxCacheAge{30};
+
+static VisibilityCache s_cache{};
+static std::vector<uint32_t> s_cacheVisible;
+static uint64_t s_cacheHits{}, s_cacheQueries{};
+static float s_savedMicroseconds{};
+static ScreenClipper s_clipper{};
+
+static void computeVisibility(const ViewState& view);
+static bool isCacheUsable(const ViewState& view, uint16_t subSector);
+static ViewState makeGuardView(const ViewState& view);
+static ColumnProjection makeColumnProjection(const ViewState& view);
+static bool isSolidSegment(const GLSegment& segment);
+static int32_t findViewSector(glm::vec2 viewPoint);
+
+void Visibility::init(const Map& map, const GLMap& glMap, const PVS* pvs) {
+    s_map = &map;
+    s_glMap = &glMap;
+    s_pvs = (pvs != nullptr && pvs->NumSectors == map.sectors.size()) ? pvs : nullptr;
+    s_pvsRowSector = -1;
+    PortalCulling::init(map);
+
+    s_minHeight = std::numeric_limits<float>::infinity();
+    s_maxHeight = -std::numeric_limits<float>::infinity();
+
+    for(auto&& sector : map.sectors){
+        s_minHeight = std::min(s_minHeight, static_cast<float>(sector.floor));
+        s_maxHeight = std::max(s_maxHeight, static_cast<float>(sector.ceiling));
+    }
+
+    s_subSectorBounds.resize(glMap.subSectors.size());
+    s_subSectorSectors.assign(glMap.subSectors.size(), 0);
+
+    for(size_t i{}; i < glMap.subSectors.size(); ++i){
+        auto&& subSector = glMap.subSectors.at(i);
+        auto& bounds = s_subSectorBounds.at(i);
+        bounds.min = glm::vec2{std::numeric_limits<float>::infinity()};
+        bounds.max = glm::vec2{-std::numeric_limits<float>::infinity()};
+
+        for(uint16_t j{}; j < subSector.numSegments; ++j){
+            auto&& segment = glMap.segments.at(subSector.firstSegment + j);
+            const glm::vec2 start = BSP::getSegmentVertex(map, glMap, segment.startVertex);
+            const glm::vec2 end = BSP::getSegmentVertex(map, glMap, segment.endVertex);
+            bounds.min = glm::min(bounds.min, glm::min(start, end));
+            bounds.max = glm::max(bounds.max, glm::max(start, end));
+
+            if(segment.lineDef != NoLineDef){
+                auto&& line = map.lineDefs.at(segment.lineDef);
+                s_subSectorSectors.at(i) = map.sideDefs.at(segment.side == 0 ? line.frontSideDef : line.backSideDef).sectorIndex;
+            }
+        }
+    }
+
+    s_subSectorBoundsSoA.clear();
+    s_subSectorBoundsSoA.reserve(s_subSectorBounds.size());
+    for(auto&& bounds : s_subSectorBounds){
+        s_subSectorBoundsSoA.push({bounds.min.x, s_minHeight, bounds.min.y}, {bounds.max.x, s_maxHeight, bounds.max.y});
+    }
+
+    s_frustumSubSectors.reserve(s_subSectorBounds.size());
+    s_subSectorFrustumFrames.assign(s_subSectorBounds.size(), 0u);
+
+    s_nodeBoundsSoA.clear();
+    s_nodeBoundsSoA.reserve(glMap.nodes.size() * 2);
+    for(auto&& node : glMap.nodes){
+        for(auto&& box : node.boxes){
+            s_nodeBoundsSoA.push({box.min.x, s_minHeight, box.min.y}, {box.max.x, s_maxHeight, box.max.y});
+        }
+    }
+
+    s_frustumNodeBoxes.reserve(s_nodeBoundsSoA.size());
+    s_nodeBoxFrustumFrames.assign(s_nodeBoundsSoA.size(), 0u);
+
+    s_lineDefBounds.clear();
+    s_lineDefBounds.reserve(map.lineDefs.size());
+
+    for(auto&& line : map.lineDefs){
+        const glm::vec2 start = map.vertices.at(line.startIndex);
+        const glm::vec2 end = map.vertices.at(line.endIndex);
+
+        auto&& frontSector = map.sectors.at(map.sideDefs.at(line.frontSideDef).sectorIndex);
+        float bottom = frontSector.floor, top = frontSector.ceiling;
+        if(line.flags & std::to_underlying(LineDefFormat::TWO_SIDE)){
+            auto&& backSector = map.sectors.at(map.sideDefs.at(line.backSideDef).sectorIndex);
+            bottom = std::min<float>(bottom, backSector.floor);
+            top = std::max<float>(top, backSector.ceiling);
+        }
+
+        const glm::vec2 min = glm::min(start, end), max = glm::max(start, end);
+        s_lineDefBounds.push({min.x, bottom, min.y}, {max.x, top, max.y});
+    }
+
+    s_lineDefFrames.assign(map.lineDefs.size(), 0u);
+    s_visibleLineDefs.reserve(map.lineDefs.size());
+    s_visibleSubSectors.clear();
+    s_visibleSubSectors.reserve(glMap.subSectors.size());
+    s_frame = 0;
+    s_cache = VisibilityCache{};
+    s_cacheHits = 0;
+    s_cacheQueries = 0;
+    s_savedMicroseconds = 0.0f;
+}
+
+void Visibility::update(const ViewState& view) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const uint16_t subSector = BSP::findSubSector(*s_glMap, {view.Position.x, view.Position.z});
+
+    ++s_cacheQueries;
+    const bool isHit = isCacheUsable(view, subSector);
+
+    if(isHit){
+        ++s_cacheHits;
+        ++s_cache.Age;
+    }
+    else {
+        computeVisibility(makeGuardView(view));
+
+        s_cache.IsValid = true;
+        s_cache.SubSector = subSector;
+        s_cache.Position = view.Position;
+        s_cache.Forward = view.Forward;
+        s_cache.Projection = view.Projection;
+        s_cache.ScreenWidth = view.ScreenWidth;
+        s_cache.Age = 0;
+        s_cache.Stats = s_stats;
+        s_cache.LineDefs.assign(s_visibleLineDefs.begin(), s_visibleLineDefs.end());
+
+        s_cache.Bounds.clear();
+        for(auto lineDef : s_cache.LineDefs){
+            s_cache.Bounds.push(
+                {s_lineDefBounds.MinX[lineDef], s_lineDefBounds.MinY[lineDef], s_lineDefBounds.MinZ[lineDef]}, 
+                {s_lineDefBounds.MaxX[lineDef], s_lineDefBounds.MaxY[lineDef], s_lineDefBounds.MaxZ[lineDef]});
+        }
+    }
+
+    // Candidates keep front to back order, kernel emit indices in order
+    s_cacheVisible.clear();
+    Frustum::fromMatrix(view.ViewProjection).cullBoxes(s_cache.Bounds, s_cacheVisible);
+
+    s_visibleLineDefs.clear();
+    for(auto index : s_cacheVisible){
+        s_visibleLineDefs.push_back(s_cache.LineDefs[index]);
+    }
+
+    const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    if(!isHit){
+        s_cache.Stats.FullMicroseconds = elapsed.count();
+    }
+    else {
+        s_savedMicroseconds += std::max(0.0f, s_cache.Stats.FullMicroseconds - elapsed.count());
+    }
+
+    s_stats = s_cache.Stats;
+    s_stats.VisibleLineDefs = static_cast<uint32_t>(s_visibleLineDefs.size());
+    s_stats.CacheHit = isHit;
+    s_stats.CacheAge = s_cache.Age;
+    s_stats.CacheHits = s_cacheHits;
+    s_stats.CacheQueries = s_cacheQueries;
+    s_stats.UpdateMicroseconds = elapsed.count();
+    s_stats.SavedMicroseconds = s_savedMicroseconds;
+}
+
+std::span<const uint32_t> Visibility::getVisibleLineDefs() {
+    return s_visibleLineDefs;
+}
+
+std::span<const uint16_t> Visibility::getVisibleSubSectors() {
+    return s_visibleSubSectors;
+}
+
+const BoundsSoA& Visibility::getLineDefBounds() {
+    return s_lineDefBounds;
+}
+
+const VisibilityStats& Visibility::getStats() {
+    return s_stats;
+}
+
+void computeVisibility(const ViewState& view) {
+    ++s_frame;
+    s_visibleLineDefs.clear();
+    s_visibleSubSectors.clear();
+    s_stats = VisibilityStats{};
+    s_stats.TotalLineDefs = static_cast<uint32_t>(s_map->lineDefs.size());
+
+    const glm::vec2 viewPoint{view.Position.x, view.Position.z};
+    const Frustum frustum = Frustum::fromMatrix(view.ViewProjection);
+    const ColumnProjection columns = makeColumnProjection(view);
+    s_clipper.reset(view.ScreenWidth);
+
+    s_stats.ViewSector = findViewSector(viewPoint);
+    const bool usePVS = s_stats.ViewSector >= 0 && s_pvs != nullptr;
+    if(usePVS && s_stats.ViewSector != s_pvsRowSector){
+        s_pvs->decompressRow(static_cast<uint32_t>(s_stats.ViewSector), s_pvsRow);
+        s_pvsRowSector = s_stats.ViewSector;
+    }
+
+    const bool usePortals = s_stats.ViewSector >= 0;
+    if(usePortals){
+        const auto startTime = std::chrono::steady_clock::now();
+        s_stats.PortalCrossings = PortalCulling::update(viewPoint, columns.Forward, columns.isValid() ? 1.0f / columns.InverseTanHalf : 0.0f, 
+            static_cast<uint16_t>(s_stats.ViewSector), usePVS ? &s_pvsRow : nullptr);
+        s_stats.PortalVisibleSectors = PortalCulling::getNumVisibleSectors();
+
+        const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+        s_stats.PortalMicroseconds = elapsed.count();
+    }
+    const auto& portalSectors = PortalCulling::getVisibleSectors();
+
+    // Every node and subsector box in one SIMD pass each, the walk only read the result
+    // and still skip whole subtrees on a node box that failed
+    s_frustumNodeBoxes.clear();
+    frustum.cullBoxes(s_nodeBoundsSoA, s_frustumNodeBoxes);
+    for(auto boxIndex : s_frustumNodeBoxes){
+        s_nodeBoxFrustumFrames[boxIndex] = s_frame;
+    }
+
+    s_frustumSubSectors.clear();
+    frustum.cullBoxes(s_subSectorBoundsSoA, s_frustumSubSectors);
+    for(auto subSectorIndex : s_frustumSubSectors){
+        s_subSectorFrustumFrames[subSectorIndex] = s_frame;
+    }
+
+    auto isBoxOccluded = [&columns](const BoundingBox& box){
+        if(!columns.isValid()){
+            return false;
+        }
+
+        const std::array corners{box.min, glm::vec2{box.max.x, box.min.y}, box.max, glm::vec2{box.min.x, box.max.y}};
+        float minColumn{}, maxColumn{};
+        if(!columns.project(corners, minColumn, maxColumn)){
+            return true;
+        }
+
+        return s_clipper.isOccluded(static_cast<int>(std::floor(minColumn)), static_cast<int>(std::ceil(maxColumn)));
+    };
+
+    BSP::traverse(*s_glMap, viewPoint, 
+        [&](const BoundingBox& box, uint32_t boxIndex){
+            ++s_stats.VisitedNodes;
+            if(s_nodeBoxFrustumFrames[boxIndex] != s_frame){
+                ++s_stats.CulledNodes;
+                return false;
+            }
+
+            if(isBoxOccluded(box)){
+                ++s_stats.OccludedNodes;
+                return false;
+            }
+            return true;
+        },
+        [&](uint16_t subSectorIndex){
+            // Every column already hidden, nothing further can show
+            if(s_clipper.isFull()){
+                s_stats.ScreenCovered = true;
+                return false;
+            }
+
+            if(usePVS && !isSectorVisible(s_pvsRow, s_subSectorSectors[subSectorIndex])){
+                ++s_stats.PVSRejectedSubSectors;
+                return true;
+            }
+
+            if(usePortals && !isSectorVisible(portalSectors, s_subSectorSectors[subSectorIndex])){
+                ++s_stats.PortalRejectedSubSectors;
+                return true;
+            }
+
+            if(s_subSectorFrustumFrames[subSectorIndex] != s_frame){
+                ++s_stats.CulledSubSectors;
+                return true;
+            }
+
+            bool isAnySegmentVisible{!columns.isValid()};
+
+            auto&& subSector = s_glMap->subSectors[subSectorIndex];
+            for(uint16_t i{}; i < subSector.numSegments; ++i){
+                auto&& segment = s_glMap->segments[subSector.firstSegment + i];
+
+                if(columns.isValid()){
+                    const std::array points{
+                        BSP::getSegmentVertex(*s_map, *s_glMap, segment.startVertex),
+                        BSP::getSegmentVertex(*s_map, *s_glMap, segment.endVertex)
+                    };
+
+                    float minColumn{}, maxColumn{};
+                    if(!columns.project(points, minColumn, maxColumn) || 
+                        s_clipper.isOccluded(static_cast<int>(std::floor(minColumn)), static_cast<int>(std::ceil(maxColumn)))){
+                        ++s_stats.OccludedSegments;
+                        continue;
+                    }
+
+                    isAnySegmentVisible = true;
+
+                    // Only the front face of a solid wall block the view
+                    const glm::vec2 direction = points[1] - points[0];
+                    const glm::vec2 toView = viewPoint - points[0];
+                    if(isSolidSegment(segment) && direction.x * toView.y - direction.y * toView.x < 0.0f){
+                        s_clipper.addOccluder(static_cast<int>(std::ceil(minColumn - 0.5f)), static_cast<int>(std::floor(maxColumn - 0.5f)));
+                    }
+                }
+
+                // Split LineDef has many segments, emit once
+                if(segment.lineDef == NoLineDef || s_lineDefFrames[segment.lineDef] == s_frame){
+                    continue;
+                }
+
+                s_lineDefFrames[segment.lineDef] = s_frame;
+                s_visibleLineDefs.push_back(segment.lineDef);
+            }
+
+            if(isAnySegmentVisible){
+                ++s_stats.VisibleSubSectors;
+                s_visibleSubSectors.push_back(subSectorIndex);
+            }
+            else {
+                ++s_stats.OccludedSubSectors;
+            }
+            return true;
+        });
+
+    s_stats.VisibleLineDefs = static_cast<uint32_t>(s_visibleLineDefs.size());
+}
+
+bool isCacheUsable(const ViewState& view, uint16_t subSector) {
+    if(!s_cache.IsValid || s_cache.Age >= MaxCacheAge || s_cache.SubSector != subSector){
+        return false;
+    }
+
+    if(s_cache.ScreenWidth != view.ScreenWidth || s_cache.Projection != view.Projection){
+        return false;
+    }
+
+    if(glm::distance(s_cache.Position, view.Position) > MaxCacheTranslation){
+        return false;
+    }
+
+    // Turned less than the guard band, real frustum stay inside the cached one
+    const float cosine = glm::dot(glm::normalize(s_cache.Forward), glm::normalize(view.Forward));
+    return cosine >= std::cos(CacheGuardAngle);
+}
+
+ViewState makeGuardView(const ViewState& view) {
+    // Widen both axes in clip space, x' = x / scale keep the same view and near plane
+    const float tanHalfX = 1.0f / view.Projection[0][0];
+    const float tanHalfY = 1.0f / view.Projection[1][1];
+    const float scaleX = std::tan(std::min(std::atan(tanHalfX) + CacheGuardAngle, 1.5f)) / tanHalfX;
+    const float scaleY = std::tan(std::min(std::atan(tanHalfY) + CacheGuardAngle, 1.5f)) / tanHalfY;
+    const glm::mat4 widen = glm::scale(glm::identity<glm::mat4>(), glm::vec3{1.0f / scaleX, 1.0f / scaleY, 1.0f});
+
+    ViewState guardView = view;
+    guardView.Projection = widen * view.Projection;
+    guardView.ViewProjection = widen * view.ViewProjection;
+    return guardView;
+}
+
+ColumnProjection makeColumnProjection(const ViewState& view) {
+    ColumnProjection projection{};
+    projection.Origin = glm::vec2{view.Position.x, view.Position.z};
+    projection.HalfWidth = static_cast<float>(view.ScreenWidth) * 0.5f;
+
+    const glm::vec2 forward{view.Forward.x, view.Forward.z};
+    if(glm::length(forward) < 1e-4f){
+        return projection;
+    }
+
+    projection.Forward = glm::normalize(forward);
+    projection.Right = glm::vec2{projection.Forward.y, -projection.Forward.x};
+
+    // Pitch tilt the frustum corners, widest horizontal angle is at the far tilted corner
+    const float tanHalfX = 1.0f / view.Projection[0][0];
+    const float tanHalfY = 1.0f / view.Projection[1][1];
+    const float pitch = std::asin(std::clamp(std::abs(view.Forward.y) / glm::length(view.Forward), 0.0f, 1.0f));
+    const float horizontal = std::cos(pitch) - std::sin(pitch) * tanHalfY;
+
+    if(horizontal > 1e-2f){
+        projection.InverseTanHalf = horizontal / tanHalfX;
+    }
+
+    return projection;
+}
+
+bool ColumnProjection::isValid() const {
+    return InverseTanHalf > 0.0f;
+}
+
+glm::vec2 ColumnProjection::toView(glm::vec2 point) const {
+    const glm::vec2 delta = point - Origin;
+    return {glm::dot(delta, Right), glm::dot(delta, Forward)};
+}
+
+bool ColumnProjection::project(std::span<const glm::vec2> points, float& minColumn, float& maxColumn) const {
+    minColumn = std::numeric_limits<float>::infinity();
+    maxColumn = -std::numeric_limits<float>::infinity();
+
+    auto addPoint = [&](glm::vec2 viewPoint){
+        const float column = HalfWidth * (1.0f + viewPoint.x / viewPoint.y * InverseTanHalf);
+        minColumn = std::min(minColumn, column);
+        maxColumn = std::max(maxColumn, column);
+    };
+
+    // Segment has one edge, polygon is closed
+    const size_t numEdges = points.size() == 2 ? 1 : points.size();
+
+    for(size_t i{}; i < points.size(); ++i){
+        const glm::vec2 start = toView(points[i]);
+        if(start.y >= NearDistance){
+            addPoint(start);
+        }
+
+        if(i >= numEdges){
+            continue;
+        }
+
+        const glm::vec2 end = toView(points[(i + 1) % points.size()]);
+        if((start.y >= NearDistance) != (end.y >= NearDistance)){
+            const float t = (NearDistance - start.y) / (end.y - start.y);
+            addPoint(start + (end - start) * t);
+        }
+    }
+
+    return minColumn <= maxColumn;
+}
+
+bool isSolidSegment(const GLSegment& segment) {
+    if(segment.lineDef == NoLineDef){
+        return false;
+    }
+
+    auto&& line = s_map->lineDefs[segment.lineDef];
+    if(!(line.flags & std::to_underlying(LineDefFormat::TWO_SIDE))){
+        return true;
+    }
+
+    const uint16_t frontSide = segment.side == 0 ? line.frontSideDef : line.backSideDef;
+    const uint16_t backSide = segment.side == 0 ? line.backSideDef : line.frontSideDef;
+    auto&& frontSector = s_map->sectors[s_map->sideDefs[frontSide].sectorIndex];
+    auto&& backSector = s_map->sectors[s_map->sideDefs[backSide].sectorIndex];
+
+    // Closed door or lift, no opening between the sectors
+    return backSector.ceiling <= frontSector.floor || backSector.floor >= frontSector.ceiling;
+}
+
+int32_t findViewSector(glm::vec2 viewPoint) {
+    if(s_glMap->nodes.empty()){
+        return -1;
+    }
+
+    const uint16_t subSectorIndex = BSP::findSubSector(*s_glMap, viewPoint);
+    auto&& subSector = s_glMap->subSectors.at(subSectorIndex);
+
+    // Outside the map the BSP still give a leaf, only trust it if the point is inside the convex polygon
+    for(uint16_t i{}; i < subSector.numSegments; ++i){
+        auto&& segment = s_glMap->segments[subSector.firstSegment + i];
+        const glm::vec2 start = BSP::getSegmentVertex(*s_map, *s_glMap, segment.startVertex);
+        const glm::vec2 end = BSP::getSegmentVertex(*s_map, *s_glMap, segment.endVertex);
+        const glm::vec2 direction = end - start;
+        const glm::vec2 toView = viewPoint - start;
+
+        if(direction.x * toView.y - direction.y * toView.x > 1.0f){
+            return -1;
+        }
+    }
+
+    return s_subSectorSectors[subSectorIndex];
+}
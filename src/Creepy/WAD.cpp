@@ -1,6 +1,7 @@
 #include <print>
 #include <fstream>
 #include <Creepy/WAD.hpp>
+#include <Creepy/Collision.hpp>
 
 std::optional<WAD> WAD::loadFromFile(const std::filesystem::path& filePath) {
     std::ifstream fileIn{filePath, std::ios::binary | std::ios::ate};
@@ -41,8 +42,9 @@ std::optional<WAD> WAD::loadFromFile(const std::filesystem::path& filePath) {
         fileIn.read(std::bit_cast<char*>(&wadFile.lumps.at(i).size), 4);
 
         fileIn.seekg(offset + 8);
-        fileIn.read(wadFile.lumps.at(i).name, 8);
-        wadFile.lumps.at(i).name[8] = '\0';
+        char name[8]{};
+        fileIn.read(name, 8);
+        wadFile.lumps.at(i).name = Name8{name};
 
         wadFile.lumps.at(i).data.resize(wadFile.lumps.at(i).size);
         fileIn.seekg(lumpsOffset);
@@ -52,7 +54,7 @@ std::optional<WAD> WAD::loadFromFile(const std::filesystem::path& filePath) {
     return wadFile;
 }
 
-int WAD::findLump(std::string_view lumpName, const WAD& wadFile) {
+int WAD::findLump(Name8 lumpName, const WAD& wadFile) {
     for(int i{}; const auto& lump : wadFile.lumps){
         if(lumpName == lump.name){
             return i;
@@ -71,12 +73,15 @@ constexpr int SegsIndex{5};
 constexpr int SSectorsIndex{6};
 constexpr int NodesIndex{7};
 constexpr int SectorsIndex{8};
+constexpr int BlockMapIndex{10};
 
 
+static void readThings(Map& map, const Lump& lump);
 static void readVertices(Map& map, const Lump& lump);
 static void readLineDefs(Map& map, const Lump& lump);
 static void readSideDefs(Map& map, const Lump& lump);
 static void readSectors(Map& map, const Lump& lump);
+static bool readBlockMap(Map& map, const Lump& lump);
 
 std::optional<Map> WAD::readMap(std::string_view mapName, const WAD& wadFile) {
     Map map{};
@@ -88,6 +93,8 @@ std::optional<Map> WAD::readMap(std::string_view mapName, const WAD& wadFile) {
 
     std::println("Found Map: {}", mapIndex);
 
+    readThings(map, wadFile.lumps.at(mapIndex + ThingsIndex));
+
     readVertices(map, wadFile.lumps.at(mapIndex + VertexesIndex));
     
     readLineDefs(map, wadFile.lumps.at(mapIndex + LineDefsIndex));
@@ -96,6 +103,13 @@ std::optional<Map> WAD::readMap(std::string_view mapName, const WAD& wadFile) {
 
     readSectors(map, wadFile.lumps.at(mapIndex + SectorsIndex));
 
+    // Some PWADs leave BLOCKMAP out or overflow its 16 bit offsets, make one then
+    const size_t blockMapIndex = static_cast<size_t>(mapIndex + BlockMapIndex);
+    if(blockMapIndex >= wadFile.lumps.size() || wadFile.lumps.at(blockMapIndex).name != "BLOCKMAP" || !readBlockMap(map, wadFile.lumps.at(blockMapIndex))){
+        std::println("Building BLOCKMAP");
+        map.blockMap = Collision::buildBlockMap(map);
+    }
+
     return map;
 }
 
@@ -111,6 +125,19 @@ constexpr T readBytes(std::span<const std::byte> data, size_t index){
     }
 }
 
+void readThings(Map& map, const Lump& lump) {
+    map.things.resize(lump.size / 10);      // Each Thing: 10 bytes
+
+    for(size_t i{}, j{}; j < map.things.size(); i += 10, ++j){
+        auto& thing = map.things.at(j);
+        thing.x = readBytes<int16_t>(lump.data, i);
+        thing.y = readBytes<int16_t>(lump.data, i + 2);
+        thing.angle = readBytes<uint16_t>(lump.data, i + 4);
+        thing.type = readBytes<uint16_t>(lump.data, i + 6);
+        thing.flags = readBytes<uint16_t>(lump.data, i + 8);
+    }
+}
+
 void readVertices(Map& map, const Lump& lump){
     map.vertices.resize(lump.size / 4);     // X Y: 4 bytes
 
@@ -160,13 +187,29 @@ void readLineDefs(Map& map, const Lump& lump) {
     }
 }
 
+// Lump names are 8 bytes, NUL padded only when shorter
+static Name8 readName(std::span<const std::byte> data, size_t index) {
+    char name[8]{};
+    for(size_t i{}; i < 8 && data.at(index + i) != std::byte{0}; ++i){
+        name[i] = static_cast<char>(data.at(index + i));
+    }
+
+    return Name8{name};
+}
+
 void readSideDefs(Map& map, const Lump& lump) {
     map.sideDefs.resize(lump.size / 30);    // Each SideDef: 30 bytes
 
     std::println("Side Def: {}", map.sideDefs.size());
 
     for(size_t i{}, j{}; i < lump.size; i += 30, ++j){
-        map.sideDefs.at(j).sectorIndex = readBytes<uint16_t>(lump.data, i + 28);
+        auto& sideDef = map.sideDefs.at(j);
+        sideDef.xOffset = readBytes<int16_t>(lump.data, i);
+        sideDef.yOffset = readBytes<int16_t>(lump.data, i + 2);
+        sideDef.upperTexture = readName(lump.data, i + 4);
+        sideDef.lowerTexture = readName(lump.data, i + 12);
+        sideDef.middleTexture = readName(lump.data, i + 20);
+        sideDef.sectorIndex = readBytes<uint16_t>(lump.data, i + 28);
     }
 }
 
@@ -176,10 +219,63 @@ void readSectors(Map& map, const Lump& lump) {
     for(size_t i{}, j{}; i < lump.size; i += 26, ++j){
         map.sectors.at(j).floor = readBytes<int16_t>(lump.data, i);
         map.sectors.at(j).ceiling = readBytes<int16_t>(lump.data, i + 2);
+        map.sectors.at(j).floorTexture = readName(lump.data, i + 4);
+        map.sectors.at(j).ceilingTexture = readName(lump.data, i + 12);
         map.sectors.at(j).lightLevel = readBytes<int16_t>(lump.data, i + 20);
     }
 }
 
+bool readBlockMap(Map& map, const Lump& lump) {
+    if(lump.size < 8){
+        return false;
+    }
+
+    BlockMap blockMap{};
+    blockMap.origin = glm::ivec2{readBytes<int16_t>(lump.data, 0), readBytes<int16_t>(lump.data, 2)};
+    blockMap.columns = readBytes<int16_t>(lump.data, 4);
+    blockMap.rows = readBytes<int16_t>(lump.data, 6);
+
+    const size_t numCells = static_cast<size_t>(blockMap.columns) * static_cast<size_t>(blockMap.rows);
+    if(blockMap.columns <= 0 || blockMap.rows <= 0 || 8 + numCells * 2 > lump.size){
+        return false;
+    }
+
+    blockMap.offsets.reserve(numCells + 1);
+    blockMap.offsets.push_back(0);
+
+    for(size_t cell{}; cell < numCells; ++cell){
+        // Offset is in shorts, a list inside the header or offset table is a broken lump
+        size_t i = static_cast<size_t>(readBytes<uint16_t>(lump.data, 8 + cell * 2)) * 2;
+        if(i < 8 + numCells * 2){
+            return false;
+        }
+
+        // Lists end with 0xFFFF and node builders put a 0 in front, skip it whatever it hold like Boom
+        i += 2;
+
+        while(true){
+            if(i + 2 > lump.size){
+                return false;
+            }
+
+            const uint16_t lineIndex = readBytes<uint16_t>(lump.data, i);
+            if(lineIndex == 0xFFFF){
+                break;
+            }
+
+            if(lineIndex < map.lineDefs.size()){
+                blockMap.lines.push_back(lineIndex);
+            }
+            i += 2;
+        }
+
+        blockMap.offsets.push_back(static_cast<uint32_t>(blockMap.lines.size()));
+    }
+
+    map.blockMap = std::move(blockMap);
+    return true;
+}
+
 constexpr int GLVerticesIndex{1};
 constexpr int GLSegsIndex{2};
 constexpr int GLSSectorsIndex{3};
@@ -189,6 +285,7 @@ constexpr int GLNodesIndex{4};
 static void readGLVertices(GLMap& glMap, const Lump& lump);
 static void readGLSegments(GLMap& glMap, const Lump& lump);
 static void readGLSubSectors(GLMap& glMap, const Lump& lump);
+static void readGLNodes(GLMap& glMap, const Lump& lump);
 
 std::optional<GLMap> WAD::readGLMap(std::string_view glMapName, const WAD& wadFile) {
 
@@ -215,6 +312,7 @@ std::optional<GLMap> WAD::readGLMap(std::string_view glMapName, const WAD& wadFi
     readGLVertices(glMap, wadFile.lumps.at(glMapIndex + GLVerticesIndex));
     readGLSegments(glMap, wadFile.lumps.at(glMapIndex + GLSegsIndex));
     readGLSubSectors(glMap, wadFile.lumps.at(glMapIndex + GLSSectorsIndex));
+    readGLNodes(glMap, wadFile.lumps.at(glMapIndex + GLNodesIndex));
 
     return glMap;
 }
@@ -273,4 +371,180 @@ void readGLSubSectors(GLMap& glMap, const Lump& lump) {
 
         // std::println("{} - {}", glMap.subSectors.at(j).numSegments, glMap.subSectors.at(j).firstSegment);
     }
-}
\ No newline at end of file
+}
+
+void readGLNodes(GLMap& glMap, const Lump& lump) {
+    glMap.nodes.resize(lump.size / 28);     // Node: 28 bytes
+
+    for(uint32_t i{}, j{}; i < lump.size; i += 28, ++j){
+        auto&& node = glMap.nodes.at(j);
+        node.partition.x = static_cast<float>(readBytes<int16_t>(lump.data, i));
+        node.partition.y = static_cast<float>(readBytes<int16_t>(lump.data, i + 2));
+        node.direction.x = static_cast<float>(readBytes<int16_t>(lump.data, i + 4));
+        node.direction.y = static_cast<float>(readBytes<int16_t>(lump.data, i + 6));
+
+        // Box: Top Bottom Left Right
+        for(uint32_t side{}; side < 2; ++side){
+            const uint32_t boxOffset = i + 8 + side * 8;
+            node.boxes[side].max.y = static_cast<float>(readBytes<int16_t>(lump.data, boxOffset));
+            node.boxes[side].min.y = static_cast<float>(readBytes<int16_t>(lump.data, boxOffset + 2));
+            node.boxes[side].min.x = static_cast<float>(readBytes<int16_t>(lump.data, boxOffset + 4));
+            node.boxes[side].max.x = static_cast<float>(readBytes<int16_t>(lump.data, boxOffset + 6));
+        }
+
+        node.children[0] = readBytes<uint16_t>(lump.data, i + 24);
+        node.children[1] = readBytes<uint16_t>(lump.data, i + 26);
+    }
+}
+
+std::optional<Palette> WAD::readPalette(const WAD& wadFile) {
+    const int lumpIndex = findLump("PLAYPAL", wadFile);
+
+    if(lumpIndex < 0 || wadFile.lumps.at(lumpIndex).size < 256 * 3){
+        return std::nullopt;
+    }
+
+    const auto& lump = wadFile.lumps.at(lumpIndex);
+    Palette palette{};
+
+    for(size_t i{}; i < palette.Colors.size(); ++i){
+        palette.Colors[i] = glm::u8vec3{
+            static_cast<uint8_t>(lump.data[i * 3]), 
+            static_cast<uint8_t>(lump.data[i * 3 + 1]), 
+            static_cast<uint8_t>(lump.data[i * 3 + 2])
+        };
+    }
+
+    return palette;
+}
+
+std::optional<ColorMap> WAD::readColorMap(const WAD& wadFile) {
+    const int lumpIndex = findLump("COLORMAP", wadFile);
+
+    if(lumpIndex < 0 || wadFile.lumps.at(lumpIndex).size < NumColorMaps * 256){
+        return std::nullopt;
+    }
+
+    const auto& lump = wadFile.lumps.at(lumpIndex);
+    ColorMap colorMap{};
+
+    for(size_t level{}; level < NumColorMaps; ++level){
+        for(size_t i{}; i < 256; ++i){
+            colorMap.Maps[level][i] = static_cast<uint8_t>(lump.data[level * 256 + i]);
+        }
+    }
+
+    return colorMap;
+}
+
+std::optional<std::vector<Name8>> WAD::readPatchNames(const WAD& wadFile) {
+    const int lumpIndex = findLump("PNAMES", wadFile);
+
+    if(lumpIndex < 0 || wadFile.lumps.at(lumpIndex).size < 4){
+        return std::nullopt;
+    }
+
+    const auto& lump = wadFile.lumps.at(lumpIndex);
+    const uint32_t numNames = std::min<uint32_t>(readBytes<uint32_t>(lump.data, 0), (lump.size - 4) / 8);
+
+    std::vector<Name8> names;
+    names.reserve(numNames);
+    for(uint32_t i{}; i < numNames; ++i){
+        names.push_back(readName(lump.data, 4 + i * 8));
+    }
+
+    return names;
+}
+
+std::optional<std::vector<TextureDefinition>> WAD::readTextureDefinitions(const WAD& wadFile) {
+    std::vector<TextureDefinition> definitions;
+
+    // Shareware only has TEXTURE1, registered add TEXTURE2
+    for(const Name8 lumpName : {Name8{"TEXTURE1"}, Name8{"TEXTURE2"}}){
+        const int lumpIndex = findLump(lumpName, wadFile);
+        if(lumpIndex < 0 || wadFile.lumps.at(lumpIndex).size < 4){
+            continue;
+        }
+
+        const auto& lump = wadFile.lumps.at(lumpIndex);
+        const uint32_t numTextures = readBytes<uint32_t>(lump.data, 0);
+
+        for(uint32_t i{}; i < numTextures && 8 + i * 4 <= lump.size; ++i){
+            const uint32_t offset = readBytes<uint32_t>(lump.data, 4 + i * 4);
+
+            // Name 8, masked 4, width 2, height 2, column directory 4, patch count 2
+            if(offset + 22 > lump.size){
+                continue;
+            }
+
+            TextureDefinition definition{};
+            definition.Name = readName(lump.data, offset);
+            definition.Width = readBytes<int16_t>(lump.data, offset + 12);
+            definition.Height = readBytes<int16_t>(lump.data, offset + 14);
+
+            const int16_t numPatches = readBytes<int16_t>(lump.data, offset + 20);
+            for(int16_t patch{}; patch < numPatches && offset + 22 + (patch + 1) * 10 <= lump.size; ++patch){
+                const size_t patchOffset = offset + 22 + patch * 10;        // Each patch: 10 bytes
+                definition.Patches.push_back(PatchPlacement{
+                    readBytes<int16_t>(lump.data, patchOffset), 
+                    readBytes<int16_t>(lump.data, patchOffset + 2), 
+                    readBytes<uint16_t>(lump.data, patchOffset + 4)
+                });
+            }
+
+            definitions.push_back(std::move(definition));
+        }
+    }
+
+    if(definitions.empty()){
+        return std::nullopt;
+    }
+
+    return definitions;
+}
+
+// Boom format, nothing in the IWADs, a 0xFF type end the list
+std::optional<std::vector<AnimationDefinition>> WAD::readAnimations(const WAD& wadFile) {
+    const int lumpIndex = findLump("ANIMATED", wadFile);
+    if(lumpIndex < 0){
+        return std::nullopt;
+    }
+
+    const auto& lump = wadFile.lumps.at(lumpIndex);
+    std::vector<AnimationDefinition> definitions;
+
+    // Type 1, last name 9, first name 9, speed 4
+    for(size_t offset{}; offset + 23 <= lump.size && lump.data.at(offset) != std::byte{0xFF}; offset += 23){
+        definitions.push_back(AnimationDefinition{
+            readName(lump.data, offset + 1), 
+            readName(lump.data, offset + 10), 
+            (static_cast<uint8_t>(lump.data.at(offset)) & 1) == 0, 
+            std::max(static_cast<int>(readBytes<uint32_t>(lump.data, offset + 19)), 1)
+        });
+    }
+
+    return definitions;
+}
+
+// Boom format, an episode of 0 end the list
+std::optional<std::vector<SwitchDefinition>> WAD::readSwitches(const WAD& wadFile) {
+    const int lumpIndex = findLump("SWITCHES", wadFile);
+    if(lumpIndex < 0){
+        return std::nullopt;
+    }
+
+    const auto& lump = wadFile.lumps.at(lumpIndex);
+    std::vector<SwitchDefinition> definitions;
+
+    // Off name 9, on name 9, episode 2
+    for(size_t offset{}; offset + 20 <= lump.size; offset += 20){
+        const int16_t episode = readBytes<int16_t>(lump.data, offset + 18);
+        if(episode == 0){
+            break;
+        }
+
+        definitions.push_back(SwitchDefinition{readName(lump.data, offset), readName(lump.data, offset + 9), episode});
+    }
+
+    return definitions;
+}